@@ -33,6 +33,7 @@ iglm.object.generator <- R6::R6Class("iglm.object",
     .time_estimation = NULL,
     .sufficient_statistics = NULL,
     .results = list(),
+    .session = NULL,
     #' @description
     #' Internal method to calculate the observed count statistics based on the
     #' model formula and the data in the `iglm.data` object. Populates the
@@ -46,8 +47,9 @@ iglm.object.generator <- R6::R6Class("iglm.object",
         type_y = private$.iglm.data$type_y,
         attr_x_scale = private$.iglm.data$scale_x,
         attr_y_scale = private$.iglm.data$scale_y,
-        neighborhood = private$.iglm.data$neighborhood,
-        overlap = private$.iglm.data$overlap,
+        neighborhood = cpp_neighborhood(private$.iglm.data),
+        overlap = cpp_overlap(private$.iglm.data),
+        neighborhood_groups = private$.iglm.data$neighborhood_groups,
         directed = private$.iglm.data$directed,
         terms = private$.preprocess$term_names,
         data_list = private$.preprocess$data_list,
@@ -165,8 +167,9 @@ iglm.object.generator <- R6::R6Class("iglm.object",
           type_y = data_loaded$iglm.data$type_y,
           scale_x = data_loaded$iglm.data$scale_x,
           scale_y = data_loaded$iglm.data$scale_y,
-          neighborhood = data_loaded$iglm.data$neighborhood,
-          directed = data_loaded$iglm.data$directed
+          neighborhood = if (is.null(data_loaded$iglm.data$neighborhood_groups)) data_loaded$iglm.data$neighborhood,
+          directed = data_loaded$iglm.data$directed,
+          neighborhood_groups = data_loaded$iglm.data$neighborhood_groups
         )
         private$.coef <- data_loaded$coef
         private$.coef_degrees <- data_loaded$coef_degrees
@@ -183,6 +186,7 @@ iglm.object.generator <- R6::R6Class("iglm.object",
           coefficients_path = data_loaded$results$coefficients_path,
           var = data_loaded$results$var,
           fisher_degrees = data_loaded$results$fisher_degrees,
+          fisher_degrees_diag = data_loaded$results$fisher_degrees_diag,
           fisher_nondegrees = data_loaded$results$fisher_nondegrees,
           score_degrees = data_loaded$results$score_degrees,
           score_nondegrees = data_loaded$results$score_nondegrees,
@@ -255,7 +259,7 @@ iglm.object.generator <- R6::R6Class("iglm.object",
             n_proposals = self$iglm.data$n_actor * 10
           )
           sampler.z.obj <- sampler.net.attr(
-            n_proposals = nrow(self$iglm.data$overlap) * 10
+            n_proposals = n_overlap_dyads(self$iglm.data) * 10
           )
           private$.sampler <- sampler.iglm(
             n_simulation = 100,
@@ -713,7 +717,10 @@ iglm.object.generator <- R6::R6Class("iglm.object",
             }
           )
           class(tmp) <- "iglm.data.list"
-          attr(tmp, "neighborhood") <- iglm.data.neighborhood(private$.iglm.data$neighborhood)
+          attr(tmp, "neighborhood") <- iglm.data.neighborhood(
+            cpp_neighborhood(private$.iglm.data),
+            neighborhood_groups = private$.iglm.data$neighborhood_groups
+          )
           info$simulations <- tmp
           colnames(info$stats) <- private$.preprocess$coef_names
         }
@@ -726,7 +733,7 @@ iglm.object.generator <- R6::R6Class("iglm.object",
             samples = info$simulations,
             var = info$var,
             coefficients_path = info$coefficients_path,
-            fisher_degrees = info$fisher_degrees,
+            fisher_degrees_diag = info$fisher_degrees_diag,
             fisher_nondegrees = info$fisher_nondegrees,
             score_degrees = info$score_degrees,
             score_nondegrees = info$score_nondegrees,
@@ -787,6 +794,17 @@ iglm.object.generator <- R6::R6Class("iglm.object",
     #' Simulate networks from the fitted model or a specified model. Stores
     #' the simulations and/or summary statistics internally. The simulation
     #' is carried out using the internal MCMC sampler described in \code{\link{simulate_iglm}}.
+    #' Without a cluster and with one chain, the sampler state is kept in
+    #' memory between calls, so that a call that starts from the last sample of
+    #' the previous one continues its chain without rebuilding the state. With
+    #' \code{rng = "xoshiro"} the chain also keeps its random number stream. With
+    #' \code{rng = "R"} it draws from R's global generator, which other code can
+    #' advance between calls, so the draws may differ from those of one uninterrupted
+    #' run. The seed of the sampler only starts a new chain: repeated calls continue
+    #' it and do not repeat the draws of the first call. A call
+    #' after one with \code{only_stats = TRUE}, which stores no sample to continue from,
+    #' starts a new chain in the last stored sample (or the observed data) with the seed
+    #' of the sampler.
     #' @param only_stats (logical) If `TRUE`, only calculate and store summary
     #'   statistics for each simulation, discarding the network object itself.
     #'   Default is `FALSE`.
@@ -810,18 +828,46 @@ iglm.object.generator <- R6::R6Class("iglm.object",
         basis <- self$iglm.data
       }
 
-      info <- simulate_iglm(
-        formula = private$.formula, coef = private$.coef,
-        coef_degrees = private$.coef_degrees,
-        sampler = private$.sampler,
-        only_stats = only_stats,
-        fix_x = private$.iglm.data$fix_z,
-        fix_z = private$.iglm.data$fix_z,
-        display_progress = display_progress,
-        offset_nonoverlap = offset_nonoverlap,
-        cluster = private$.control$cluster,
-        basis = basis
-      )
+      fix_x <- private$.iglm.data$fix_z
+      fix_z <- private$.iglm.data$fix_z
+      if (is_cluster_active(private$.control$cluster) || private$.sampler$n_chains > 1) {
+        info <- simulate_iglm(
+          formula = private$.formula, coef = private$.coef,
+          coef_degrees = private$.coef_degrees,
+          sampler = private$.sampler,
+          only_stats = only_stats,
+          fix_x = fix_x,
+          fix_z = fix_z,
+          display_progress = display_progress,
+          offset_nonoverlap = offset_nonoverlap,
+          cluster = private$.control$cluster,
+          basis = basis
+        )
+      } else {
+        # Continue the chain of the previous call if it stopped in basis,
+        # otherwise start a new native session there
+        if (is.null(private$.session) ||
+          !private$.session$continues(
+            basis, private$.formula, private$.sampler,
+            offset_nonoverlap, fix_x, fix_z
+          )) {
+          private$.session <- sampler.session.generator$new(
+            formula = private$.formula, basis = basis,
+            coef = private$.coef, coef_degrees = private$.coef_degrees,
+            sampler = private$.sampler,
+            offset_nonoverlap = offset_nonoverlap,
+            fix_x = fix_x, fix_z = fix_z
+          )
+        } else {
+          private$.session$set_coef(private$.coef, private$.coef_degrees)
+        }
+        info <- private$.session$run(
+          n_simulation = private$.sampler$n_simulation,
+          n_burn_in = private$.sampler$n_burn_in,
+          only_stats = only_stats,
+          display_progress = display_progress
+        )
+      }
 
       private$.results$update(
         samples = info$samples,
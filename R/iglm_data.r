@@ -17,6 +17,7 @@ iglm.data_generator <- R6::R6Class("iglm.data",
     .z_network = NULL,
     .neighborhood = NULL,
     .overlap = NULL,
+    .neighborhood_groups = NULL,
     .fix_z_alocal = NULL,
     .directed = NULL,
     .n_actor = NULL,
@@ -114,6 +115,11 @@ iglm.data_generator <- R6::R6Class("iglm.data",
           }
         }
       }
+      if (!is.null(private$.neighborhood_groups)) {
+        if (!is.matrix(private$.neighborhood_groups) || nrow(private$.neighborhood_groups) != private$.n_actor) {
+          errors <- c(errors, "'neighborhood_groups' must be a matrix with one row per actor.")
+        }
+      }
       # Check directed flag
       if (!is.logical(private$.directed) || length(private$.directed) != 1) {
         errors <- c(errors, "'directed' must be a single logical value (TRUE or FALSE).")
@@ -167,6 +173,16 @@ iglm.data_generator <- R6::R6Class("iglm.data",
     #'   `neighborhood` is `NULL`, a full neighborhood (all dyads) is
     #'   generated implying global dependence. If `FALSE`, no neighborhood is set.
     #' @param file (character) Optional file path to load a saved `iglm.data` object state.
+    #' @param neighborhood_groups An optional matrix (or vector) of group labels
+    #'   with one row per actor and one column per grouping. Two actors are in each
+    #'   other's neighborhood if they share a label in at least one column
+    #'   (`NA` means no group). As for `neighborhood`, the overlap consists of the
+    #'   pairs of actors with a common neighbor, so with a single column it is
+    #'   formed by the pairs within groups of at least three actors. This is an
+    #'   alternative to `neighborhood` for block-structured neighborhoods: only the
+    #'   labels are stored and passed on, the samplers derive the neighborhood and
+    #'   overlap from them and answer membership queries by comparing labels (the
+    #'   `neighborhood` and `overlap` fields build the edgelists on first access).
     #' @return A new `iglm.data` object.
     initialize = function(x_attribute = NULL, y_attribute = NULL, z_network = NULL,
                           neighborhood = NULL, directed = NA, n_actor = NA,
@@ -177,7 +193,8 @@ iglm.data_generator <- R6::R6Class("iglm.data",
                           fix_z = FALSE,
                           fix_z_alocal = TRUE,
                           return_neighborhood = TRUE,
-                          file = NULL) {
+                          file = NULL,
+                          neighborhood_groups = NULL) {
       # browser()
       if (!is.null(file)) {
         if (!file.exists(file)) {
@@ -206,6 +223,20 @@ iglm.data_generator <- R6::R6Class("iglm.data",
         fix_x <- data_loaded$fix_x
         fix_z <- data_loaded$fix_z
         fix_z_alocal <- data_loaded$fix_z_alocal
+        neighborhood_groups <- data_loaded$neighborhood_groups
+        if (!is.null(neighborhood_groups)) {
+          neighborhood <- NULL
+        }
+      }
+      if (!is.null(neighborhood_groups)) {
+        if (!is.null(neighborhood)) {
+          stop("Only one of `neighborhood` and `neighborhood_groups` can be provided.", call. = FALSE)
+        }
+        neighborhood_groups <- groups_to_codes(neighborhood_groups)
+        if (is.na(n_actor)) {
+          n_actor <- nrow(neighborhood_groups)
+        }
+        private$.neighborhood_groups <- neighborhood_groups
       }
       private$.type_x <- type_x
       private$.type_y <- type_y
@@ -217,7 +248,7 @@ iglm.data_generator <- R6::R6Class("iglm.data",
 
       private$.descriptives <- list()
 
-      if (return_neighborhood) {
+      if (return_neighborhood && is.null(neighborhood_groups)) {
         if (is.null(neighborhood)) {
           if (is.na(n_actor)) {
             stop("n_actor must be provided if neighborhood is not provided.")
@@ -298,22 +329,14 @@ iglm.data_generator <- R6::R6Class("iglm.data",
       } else {
         private$.directed <- directed
       }
-      if (return_neighborhood) {
+      if (!is.null(neighborhood_groups)) {
+        # Derived from the labels in C++; the edgelists are only built on
+        # request (see the `neighborhood` and `overlap` fields)
+        private$.neighborhood <- NULL
+        private$.overlap <- NULL
+      } else if (return_neighborhood) {
         if (ncol(neighborhood) == 2) {
-          sp_nb <- spMatrix(
-            nrow = private$.n_actor, ncol = private$.n_actor,
-            i = neighborhood[, 1], j = neighborhood[, 2],
-            x = rep(1, length(neighborhood[, 2]))
-          )
-          sp_nb_trans <- sparseMatrix(i = sp_nb@j + 1, j = sp_nb@i + 1, dims = sp_nb@Dim)
-
-          overlap <- sp_nb %*% sp_nb_trans
-          overlap <- as(overlap, "TsparseMatrix")
-          overlap <- cbind(
-            overlap@i + 1,
-            overlap@j + 1
-          )
-          private$.overlap <- overlap[overlap[, 1] != overlap[, 2], ]
+          private$.overlap <- neighborhood_to_overlap(neighborhood, private$.n_actor)
           private$.neighborhood <- neighborhood
         } else {
           positions <- which(neighborhood == 1, arr.ind = T)
@@ -429,7 +452,8 @@ iglm.data_generator <- R6::R6Class("iglm.data",
         scale_y = private$.scale_y,
         fix_x = private$.fix_x,
         fix_z = private$.fix_z,
-        fix_z_alocal = private$.fix_z_alocal
+        fix_z_alocal = private$.fix_z_alocal,
+        neighborhood_groups = private$.neighborhood_groups
       )
       return(data_to_save)
     },
@@ -465,7 +489,7 @@ iglm.data_generator <- R6::R6Class("iglm.data",
           private$.z_network <- private$.z_network[!private$.z_network[, 1] %in% isolates & !private$.z_network[, 2] %in% isolates, , drop = FALSE]
           private$.z_network[, 1] <- actor_df$id_new[private$.z_network[, 1]]
           private$.z_network[, 2] <- actor_df$id_new[private$.z_network[, 2]]
-          if (!is.null(private$.neighborhood)) {
+          if (!is.null(private$.neighborhood) && is.null(private$.neighborhood_groups)) {
             private$.neighborhood <- private$.neighborhood[!private$.neighborhood[, 1] %in% isolates & !private$.neighborhood[, 2] %in% isolates, , drop = FALSE]
             private$.neighborhood[, 1] <- actor_df$id_new[private$.neighborhood[, 1]]
             private$.neighborhood[, 2] <- actor_df$id_new[private$.neighborhood[, 2]]
@@ -473,6 +497,13 @@ iglm.data_generator <- R6::R6Class("iglm.data",
             private$.overlap[, 1] <- actor_df$id_new[private$.overlap[, 1]]
             private$.overlap[, 2] <- actor_df$id_new[private$.overlap[, 2]]
           }
+          if (!is.null(private$.neighborhood_groups)) {
+            # The isolates may have been the only common neighbour of two
+            # actors, so the cached edgelists are rebuilt on request
+            private$.neighborhood_groups <- private$.neighborhood_groups[-isolates, , drop = FALSE]
+            private$.neighborhood <- NULL
+            private$.overlap <- NULL
+          }
         }
       }
       invisible(self)
@@ -675,8 +706,17 @@ iglm.data_generator <- R6::R6Class("iglm.data",
     #'  Can be a 2-column edgelist or a square adjacency matrix.
     #' @param overlap A matrix for the overlap network.
     #'  Can be a 2-column edgelist or a square adjacency matrix.
+    #' @param neighborhood_groups An optional matrix of group labels (see
+    #'  `initialize`). If provided, `neighborhood` and `overlap` are ignored
+    #'  and both are derived from the labels.
     #' @return None. Updates the internal neighborhood and overlap matrices.
-    set_neighborhood_overlap = function(neighborhood, overlap) {
+    set_neighborhood_overlap = function(neighborhood, overlap, neighborhood_groups = NULL) {
+      if (!is.null(neighborhood_groups)) {
+        private$.neighborhood_groups <- groups_to_codes(neighborhood_groups)
+        private$.neighborhood <- NULL
+        private$.overlap <- NULL
+        return(invisible(NULL))
+      }
       if (!is.matrix(neighborhood)) {
         stop("'neighborhood' must be a matrix or a sparse Matrix object.")
       }
@@ -1141,7 +1181,8 @@ iglm.data_generator <- R6::R6Class("iglm.data",
         dimnames = list(actors_x, actors_y)
       )
 
-      overlap_tmp <- private$.overlap[(private$.overlap[, 1] %in% actors_x) & (private$.overlap[, 2] %in% actors_y), ]
+      overlap <- self$overlap
+      overlap_tmp <- overlap[(overlap[, 1] %in% actors_x) & (overlap[, 2] %in% actors_y), ]
       overlap_tmp[, 1] <- match(overlap_tmp[, 1], rownames(adj_mat_x_y))
       overlap_tmp[, 2] <- match(overlap_tmp[, 2], colnames(adj_mat_x_y))
       adj_mat_x_y[overlap_tmp] <- 0
@@ -1154,7 +1195,7 @@ iglm.data_generator <- R6::R6Class("iglm.data",
         ncol = 2
       )
       if (nrow(edges_x_y) > 0) {
-        which_overlap <- check_overlap(edges_x_y, private$.overlap)
+        which_overlap <- check_overlap(edges_x_y, overlap)
         edges_x_y_overlap <- matrix(edges_x_y[which_overlap, ], ncol = 2)
         edges_x_y_overlap[, 1] <- match(edges_x_y_overlap[, 1], rownames(adj_mat_x_y))
         edges_x_y_overlap[, 2] <- match(edges_x_y_overlap[, 2], colnames(adj_mat_x_y))
@@ -1352,8 +1393,8 @@ iglm.data_generator <- R6::R6Class("iglm.data",
           stop("`coords` must be a matrix with nrow = vcount(g) and at least 2 columns.")
         }
       }
-      if (show_overlap && !is.null(private$.neighborhood) && nrow(private$.neighborhood) > 0) {
-        overlap_edges <- as.matrix(private$.neighborhood)
+      if (show_overlap && nrow(self$neighborhood) > 0) {
+        overlap_edges <- as.matrix(self$neighborhood)
         overlap_edges <- overlap_edges[overlap_edges[, 1] != overlap_edges[, 2], , drop = FALSE]
         g2 <- igraph::graph_from_data_frame(d = overlap_edges, vertices = igraph::V(g)$name, directed = FALSE)
         igraph::V(g2)$name <- as.character(seq_len(igraph::vcount(g2)))
@@ -1452,7 +1493,7 @@ iglm.data_generator <- R6::R6Class("iglm.data",
       dir_flag <- isTRUE(private$.directed)
 
       m_z <- nrow(private$.z_network)
-      m_nb <- nrow(private$.neighborhood)
+      m_nb <- n_neighborhood_dyads(self)
       numfmt <- function(v) format(v, digits = digits, trim = TRUE)
 
       summarize_attr <- function(v, type, scale) {
@@ -1542,20 +1583,31 @@ iglm.data_generator <- R6::R6Class("iglm.data",
       if (missing(value)) private$.z_network else self$set_z_network(value)
     },
 
-    #' @field neighborhood (`matrix`) Read-only. The secondary/neighborhood structure as a 2-column integer edgelist. An empty matrix if not provided.
+    #' @field neighborhood (`matrix`) Read-only. The secondary/neighborhood structure as a 2-column integer edgelist. An empty matrix if not provided. With `neighborhood_groups`, the edgelist is built from the labels on first access.
     neighborhood = function(value) {
       if (missing(value)) {
+        if (is.null(private$.neighborhood) && !is.null(private$.neighborhood_groups)) {
+          private$.neighborhood <- groups_to_edgelist(private$.neighborhood_groups)
+        }
         if (is.null(private$.neighborhood)) matrix(0, nrow = 0, ncol = 2) else private$.neighborhood
       } else stop("`neighborhood` is read-only.", call. = FALSE)
     },
 
-    #' @field overlap (`matrix`) Read-only. The calculated overlap relation (dyads with shared neighbors in `neighborhood`) as a 2-column integer edgelist. An empty matrix if overlap hasn't been computed or is not available.
+    #' @field overlap (`matrix`) Read-only. The calculated overlap relation (dyads with shared neighbors in `neighborhood`) as a 2-column integer edgelist. An empty matrix if overlap hasn't been computed or is not available. With `neighborhood_groups`, the edgelist is built from the labels on first access.
     overlap = function(value) {
       if (missing(value)) {
+        if (is.null(private$.overlap) && !is.null(private$.neighborhood_groups)) {
+          private$.overlap <- neighborhood_to_overlap(self$neighborhood, private$.n_actor)
+        }
         if (is.null(private$.overlap)) matrix(0, nrow = 0, ncol = 2) else private$.overlap
       } else stop("`overlap` is read-only.", call. = FALSE)
     },
 
+    #' @field neighborhood_groups (`matrix` or `NULL`) Read-only. The group labels defining the neighborhood, if the neighborhood was given via `neighborhood_groups`.
+    neighborhood_groups = function(value) {
+      if (missing(value)) private$.neighborhood_groups else stop("`neighborhood_groups` is read-only.", call. = FALSE)
+    },
+
     #' @field directed (`logical`) Indicates if the `z_network` is treated as directed.
     directed = function(value) {
       if (missing(value)) private$.directed else stop("`directed` is read-only.", call. = FALSE)
@@ -1647,6 +1699,16 @@ iglm.data_generator <- R6::R6Class("iglm.data",
 #'   `neighborhood` is `NULL`, a full neighborhood (all dyads) is
 #'   generated implying global dependence. If `FALSE`, no neighborhood is set.
 #' @param file (character) Optional file path to load a saved `iglm.data` object state.
+#' @param neighborhood_groups An optional matrix (or vector) of group labels
+#'   with one row per actor and one column per grouping. Two actors are in each
+#'   other's neighborhood if they share a label in at least one column
+#'   (`NA` means no group). As for `neighborhood`, the overlap consists of the
+#'   pairs of actors with a common neighbor, so with a single column it is
+#'   formed by the pairs within groups of at least three actors. This is an
+#'   alternative to `neighborhood` for block-structured neighborhoods: only the
+#'   labels are stored and passed on, the samplers derive the neighborhood and
+#'   overlap from them and answer membership queries by comparing labels (the
+#'   `neighborhood` and `overlap` fields build the edgelists on first access).
 #' @return An object of class `iglm.data` (and `R6`).
 #' @references
 #' Fritz, C., Schweinberger, M. , Bhadra S., and D. R. Hunter (2025). A Regression Framework for Studying Relationships among Attributes under Network Interference. Journal of the American Statistical Association, to appear.
@@ -1694,7 +1756,8 @@ iglm.data <- function(x_attribute = NULL, y_attribute = NULL, z_network = NULL,
                       fix_x = FALSE,
                       fix_z = FALSE,
                       fix_z_alocal = FALSE,
-                      return_neighborhood = TRUE, file = NULL) {
+                      return_neighborhood = TRUE, file = NULL,
+                      neighborhood_groups = NULL) {
   # browser()
   if (!is.null(z_network)) {
     z_network <- as.matrix(z_network)
@@ -1719,6 +1782,7 @@ iglm.data <- function(x_attribute = NULL, y_attribute = NULL, z_network = NULL,
     fix_z = as.logical(fix_z),
     fix_z_alocal = fix_z_alocal,
     return_neighborhood = as.logical(return_neighborhood),
-    file = file
+    file = file,
+    neighborhood_groups = neighborhood_groups
   )
 }
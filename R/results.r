@@ -16,6 +16,7 @@ results.generator <- R6::R6Class("results",
     .stats = NULL,
     .var = NULL,
     .fisher_degrees = NULL,
+    .fisher_degrees_diag = NULL,
     .fisher_nondegrees = NULL,
     .score_degrees = NULL,
     .score_nondegrees = NULL,
@@ -61,6 +62,10 @@ results.generator <- R6::R6Class("results",
         private$.stats <- data_loaded$stats
         private$.var <- data_loaded$var
         private$.fisher_degrees <- data_loaded$fisher_degrees
+        private$.fisher_degrees_diag <- data_loaded$fisher_degrees_diag
+        if (is.null(private$.fisher_degrees_diag) && is.matrix(private$.fisher_degrees)) {
+          private$.fisher_degrees_diag <- diag(private$.fisher_degrees)
+        }
         private$.fisher_nondegrees <- data_loaded$fisher_nondegrees
         private$.score_degrees <- data_loaded$score_degrees
         private$.score_nondegrees <- data_loaded$score_nondegrees
@@ -109,6 +114,7 @@ results.generator <- R6::R6Class("results",
         stats = private$.stats,
         var = private$.var,
         fisher_degrees = private$.fisher_degrees,
+        fisher_degrees_diag = private$.fisher_degrees_diag,
         fisher_nondegrees = private$.fisher_nondegrees,
         score_degrees = private$.score_degrees,
         score_nondegrees = private$.score_nondegrees,
@@ -170,6 +176,8 @@ results.generator <- R6::R6Class("results",
     #'   non-degrees coefficients. Replaces existing matrix.
     #' @param fisher_degrees (matrix) The Fisher information matrix for
     #'   degrees coefficients. Replaces existing matrix.
+    #' @param fisher_degrees_diag (numeric) The diagonal of the Fisher
+    #'   information for degrees coefficients. Replaces existing vector.
     #' @param fisher_nondegrees (matrix) The Fisher information matrix for
     #'   non-degrees coefficients. Replaces existing matrix.
     #' @param score_degrees (numeric) The score vector for degrees coefficients.
@@ -190,6 +198,7 @@ results.generator <- R6::R6Class("results",
                       samples = NULL,
                       var = NULL,
                       fisher_degrees = NULL,
+                      fisher_degrees_diag = NULL,
                       fisher_nondegrees = NULL,
                       score_degrees = NULL,
                       score_nondegrees = NULL,
@@ -203,6 +212,11 @@ results.generator <- R6::R6Class("results",
       if (!is.null(fisher_degrees)) {
         private$.fisher_degrees <- fisher_degrees
       }
+      if (!is.null(fisher_degrees_diag)) {
+        private$.fisher_degrees_diag <- fisher_degrees_diag
+      } else if (is.matrix(fisher_degrees)) {
+        private$.fisher_degrees_diag <- diag(fisher_degrees)
+      }
       if (!is.null(fisher_nondegrees)) {
         private$.fisher_nondegrees <- fisher_nondegrees
       }
@@ -305,7 +319,7 @@ results.generator <- R6::R6Class("results",
         if (!is.null(private$.score_degrees)) {
           coefficients_path_np <- matrix(private$.coefficients_path[, seq_len(nrow(private$.var))], ncol = nrow(private$.var))
           coefficients_path_p <- matrix(private$.coefficients_path[, (nrow(private$.var) + 1):ncol(private$.coefficients_path)],
-            ncol = nrow(private$.fisher_degrees)
+            ncol = length(private$.score_degrees)
           )
 
           plot(NA,
@@ -1674,7 +1688,7 @@ results.generator <- R6::R6Class("results",
       } else {
         cat("Variance-Covariance Matrix Not Available\n")
       }
-      if (!is.null(private$.fisher_degrees)) {
+      if (!is.null(private$.fisher_degrees) || !is.null(private$.fisher_degrees_diag)) {
         cat("Fisher Information for degrees Available\n")
       } else {
         cat("Fisher Information for degrees Not Available\n")
@@ -1728,6 +1742,10 @@ results.generator <- R6::R6Class("results",
     fisher_degrees = function(value) {
       if (missing(value)) private$.fisher_degrees else stop("`fisher_degrees` is read-only.", call. = FALSE)
     },
+    #' @field fisher_degrees_diag (`numeric` or `NULL`) Read-only. Diagonal of the Fisher information for degrees coefficients.
+    fisher_degrees_diag = function(value) {
+      if (missing(value)) private$.fisher_degrees_diag else stop("`fisher_degrees_diag` is read-only.", call. = FALSE)
+    },
     #' @field fisher_nondegrees (`matrix` or `NULL`) Read-only. Fisher information matrix for non-degrees coefficients.
     fisher_nondegrees = function(value) {
       if (missing(value)) private$.fisher_nondegrees else stop("`fisher_nondegrees` is read-only.", call. = FALSE)
@@ -136,6 +136,8 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
     .n_burn_in = NULL,
     .init_empty = NULL,
     .seed = NULL,
+    .rng = NULL,
+    .n_chains = NULL,
     .cluster = NULL,
     .validate = function() {
       # Check if cluster is valid
@@ -153,6 +155,15 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
       if (!is.logical(private$.init_empty)) {
         stop("`init_empty` must be a logical value (TRUE or FALSE).", call. = FALSE)
       }
+      if (length(private$.rng) != 1 || !private$.rng %in% c("R", "xoshiro")) {
+        stop("`rng` must be either \"R\" or \"xoshiro\".", call. = FALSE)
+      }
+      if (length(private$.n_chains) != 1 || is.na(private$.n_chains) || private$.n_chains < 1) {
+        stop("`n_chains` must be a positive integer.", call. = FALSE)
+      }
+      if (private$.n_chains > 1 && private$.rng != "xoshiro") {
+        stop("`n_chains` > 1 requires `rng = \"xoshiro\"`.", call. = FALSE)
+      }
       if (!inherits(private$.sampler_x, "sampler.net.attr")) {
         stop("`sampler_x` must be created with `sampler.net.attr()`.", call. = FALSE)
       }
@@ -192,10 +203,22 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
     #'   are run sequentially.
     #' @param file (character or `NULL`) If provided, loads the sampler state from
     #'  the specified .rds file instead of initializing from parameters.
+    #' @param rng (character) Random number generator of the samplers. `"R"` (default)
+    #'   draws from R's generator, seeded with `set.seed(seed)`. `"xoshiro"` uses a native
+    #'   xoshiro256++ generator with one stream per chain, which is faster and gives the
+    #'   same draws for a given seed regardless of the number of threads, but different
+    #'   draws than `"R"`.
+    #' @param n_chains (integer) Number of chains that are run in parallel on as many
+    #'   threads within the R process. Every chain runs the full burn-in and then
+    #'   contributes its share of the `n_simulation` samples, which are returned in
+    #'   the order of the chains. Default is 1. Values larger than 1 require
+    #'   `rng = "xoshiro"` (chain k draws from stream k) and a build with OpenMP,
+    #'   otherwise the chains run one after the other.
     #' @return A new `sampler.iglm` object.
     initialize = function(sampler_x = NULL, sampler_y = NULL, sampler_z = NULL,
                           n_simulation = 100, n_burn_in = 10, init_empty = TRUE,
-                          seed = NA, cluster = NULL, file = NULL) {
+                          seed = NA, cluster = NULL, file = NULL, rng = "R",
+                          n_chains = 1) {
       if (is.null(file)) {
         # Use default component samplers if not provided
         private$.sampler_x <- if (is.null(sampler_x)) sampler.net.attr() else sampler_x
@@ -212,6 +235,8 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
         } else {
           private$.seed <- as.integer(seed)
         }
+        private$.rng <- rng
+        private$.n_chains <- as.integer(n_chains)
 
         # Validate sub-samplers
         sub_samplers <- list(private$.sampler_x, private$.sampler_y, private$.sampler_z)
@@ -235,6 +260,8 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
         private$.n_burn_in <- data$n_burn_in
         private$.init_empty <- data$init_empty
         private$.seed <- data$seed
+        private$.rng <- if ("rng" %in% names(data)) data$rng else "R"
+        private$.n_chains <- if ("n_chains" %in% names(data)) data$n_chains else 1L
         private$.sampler_x <- sampler.net.attr.generator$new(
           n_proposals = data$sampler_x$n_proposals,
           tnt = data$sampler_x$tnt
@@ -334,6 +361,23 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
       private$.seed <- as.integer(seed)
     },
     #' @description
+    #' Sets the random number generator of the samplers.
+    #' @param rng (character) Either `"R"` or `"xoshiro"`.
+    #' @return None.
+    set_rng = function(rng) {
+      private$.rng <- rng
+      private$.validate()
+    },
+    #' @description
+    #' Sets the number of chains that are run in parallel.
+    #' @param n_chains (integer) A positive integer, values larger than 1 require
+    #'   `rng = "xoshiro"`.
+    #' @return None.
+    set_n_chains = function(n_chains) {
+      private$.n_chains <- as.integer(n_chains)
+      private$.validate()
+    },
+    #' @description
     #' Prints a formatted summary of the sampler configuration to the console.
     #' @param digits (integer) Number of digits for formatting numeric values. Default: 3.
     #' @param ... Additional arguments (currently ignored).
@@ -346,6 +390,8 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
       cat("  n_burn_in    :", private$.n_burn_in, "\n", sep = "")
       cat("  init_empty   :", if (isTRUE(private$.init_empty)) "TRUE" else "FALSE", "\n", sep = "")
       cat("  seed         :", private$.seed, "\n", sep = "")
+      cat("  rng          :", private$.rng, "\n", sep = "")
+      cat("  n_chains     :", private$.n_chains, "\n", sep = "")
       cat("\n")
       cat("Sub-samplers\n")
       cat("  sampler_x:\n")
@@ -367,7 +413,9 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
         n_simulation = private$.n_simulation,
         n_burn_in = private$.n_burn_in,
         init_empty = private$.init_empty,
-        seed = private$.seed
+        seed = private$.seed,
+        rng = private$.rng,
+        n_chains = private$.n_chains
       )
     },
     #' @description
@@ -424,6 +472,14 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
     seed = function(value) {
       if (missing(value)) private$.seed else stop("`seed` is read-only. Use `set_seed()` to change it.", call. = FALSE)
     },
+    #' @field rng (`character`) Read-only. The random number generator of the samplers.
+    rng = function(value) {
+      if (missing(value)) private$.rng else stop("`rng` is read-only. Use `set_rng()` to change it.", call. = FALSE)
+    },
+    #' @field n_chains (`integer`) Read-only. The number of chains run in parallel.
+    n_chains = function(value) {
+      if (missing(value)) private$.n_chains else stop("`n_chains` is read-only. Use `set_n_chains()` to change it.", call. = FALSE)
+    },
     #' @field cluster (`cluster` object or `NULL`) The parallel cluster object being used, or `NULL`.
     cluster = function(value) {
       if (missing(value)) private$.cluster else self$set_cluster(value)
@@ -465,6 +521,11 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
 #'   for parallel simulations. If `NULL` (default), simulations run sequentially.
 #' @param file (character or `NULL`) If provided, loads the sampler state from
 #'   the specified .rds file instead of initializing from parameters.
+#' @param rng (character) Random number generator of the samplers, `"R"` (default)
+#'   or the native `"xoshiro"` generator. See \code{\link{sampler.iglm.generator}}.
+#' @param n_chains (integer) Number of chains run in parallel on as many threads,
+#'   each contributing its share of the `n_simulation` samples. Default: 1. Values
+#'   larger than 1 require `rng = "xoshiro"`.
 #'
 #' @return An object of class `sampler.iglm` (and `R6`).
 #' @export
@@ -485,7 +546,8 @@ sampler.iglm.generator <- R6::R6Class("sampler.iglm",
 #' sampler_new$n_simulation
 sampler.iglm <- function(sampler_x = NULL, sampler_y = NULL, sampler_z = NULL,
                          n_simulation = 100, n_burn_in = 10, init_empty = TRUE,
-                         seed = NA, cluster = NULL, file = NULL) {
+                         seed = NA, cluster = NULL, file = NULL, rng = "R",
+                         n_chains = 1) {
   sampler.iglm.generator$new(
     sampler_x = sampler_x,
     sampler_y = sampler_y,
@@ -495,6 +557,8 @@ sampler.iglm <- function(sampler_x = NULL, sampler_y = NULL, sampler_z = NULL,
     init_empty = init_empty,
     seed = seed,
     file = file,
-    cluster = cluster
+    cluster = cluster,
+    rng = rng,
+    n_chains = n_chains
   )
 }
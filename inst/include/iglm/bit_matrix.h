@@ -0,0 +1,75 @@
+// Defines a bit-packed dense boolean matrix used as adjacency storage in Network.
+
+#ifndef bit_matrix_H
+#define bit_matrix_H
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Number of set bits in a 64-bit word
+inline unsigned int popcount_word(std::uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned int)__builtin_popcountll(w);
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (unsigned int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Row-major bitset matrix with one bit per entry. Every row is padded to a
+// whole number of 64-bit words so that two rows can be intersected word by word.
+// All indices are 0-based.
+class BitMatrix {
+public:
+  BitMatrix() : n_rows(0), n_cols(0), n_words(0) {}
+
+  void assign(std::size_t n_rows_, std::size_t n_cols_) {
+    n_rows = n_rows_;
+    n_cols = n_cols_;
+    n_words = (n_cols + 63) / 64;
+    words.assign(n_rows * n_words, 0);
+  }
+
+  void clear() {
+    std::fill(words.begin(), words.end(), 0);
+  }
+
+  inline bool test(std::size_t r, std::size_t c) const {
+    return (words[r * n_words + (c >> 6)] >> (c & 63)) & 1ULL;
+  }
+  inline void set(std::size_t r, std::size_t c) {
+    words[r * n_words + (c >> 6)] |= (1ULL << (c & 63));
+  }
+  inline void reset(std::size_t r, std::size_t c) {
+    words[r * n_words + (c >> 6)] &= ~(1ULL << (c & 63));
+  }
+
+  inline const std::uint64_t* row(std::size_t r) const {
+    return words.data() + r * n_words;
+  }
+
+  // Size of the intersection of row r1 of a and row r2 of b (same number of columns)
+  static inline std::size_t count_and(const BitMatrix& a, std::size_t r1,
+                                      const BitMatrix& b, std::size_t r2) {
+    const std::uint64_t* w1 = a.row(r1);
+    const std::uint64_t* w2 = b.row(r2);
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < a.n_words; ++k) {
+      count += popcount_word(w1[k] & w2[k]);
+    }
+    return count;
+  }
+
+  std::size_t get_n_words() const { return n_words; }
+  std::size_t memory_bytes() const { return words.size() * sizeof(std::uint64_t); }
+
+private:
+  std::size_t n_rows;
+  std::size_t n_cols;
+  std::size_t n_words;
+  std::vector<std::uint64_t> words;
+};
+#endif
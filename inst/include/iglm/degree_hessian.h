@@ -0,0 +1,126 @@
+// Defines matrix-free representations of the degree block of the pseudo Fisher
+// information (see get_A_exact) and of the quasi Newton correction of the
+// accelerated MM algorithm (see cond_estimation_degrees_pl_accelerated).
+
+#ifndef degree_hessian_H
+#define degree_hessian_H
+#include <RcppArmadillo.h>
+#include <algorithm>
+#include <vector>
+
+// A = diag(diag) + sum_l var(l) * (e_a e_b' + e_b e_a') with a = i_vec(l) - 1 and
+// b = j_vec(l) - 1 + shift (shift = n_actor for the in-degrees of directed
+// networks, 0 otherwise). Only the variances of the dyads are stored, so memory
+// is O(dyads) instead of O(n_actor^2) and a product with A costs O(dyads).
+class DegreeHessian {
+public:
+  arma::uvec i_vec, j_vec;
+  arma::uword shift;
+  arma::vec diag, var;
+
+  DegreeHessian() : shift(0) {}
+  DegreeHessian(const arma::uvec &i_vec_, const arma::uvec &j_vec_, arma::uword shift_,
+                const arma::vec &diag_, const arma::vec &var_) :
+    i_vec(i_vec_), j_vec(j_vec_), shift(shift_), diag(diag_), var(var_) {}
+
+  arma::vec times(const arma::vec &x) const {
+    arma::vec res = diag % x;
+    for (arma::uword l = 0; l < var.n_elem; l++) {
+      const arma::uword a = i_vec[l] - 1, b = j_vec[l] - 1 + shift;
+      res[a] += var[l] * x[b];
+      res[b] += var[l] * x[a];
+    }
+    return res;
+  }
+
+  // A^- rhs, column by column with conjugate gradients preconditioned by diag.
+  // In directed networks A is singular (all out-degrees can be shifted against
+  // all in-degrees). Right-hand sides of the form B' with B = X' W (degree
+  // incidence) lie in the range of A, where the iterations converge, and every
+  // solution gives the same B A^- B'. If converged is given, it is set to false
+  // when any column stops before its relative residual falls below tol (callers
+  // warn on the main thread, since R may not be called from the parallel loop).
+  arma::mat solve(const arma::mat &rhs, int n_threads = 1,
+                  double tol = 1e-10, int max_iteration = 1000,
+                  bool *converged = nullptr) const {
+    arma::mat res(rhs.n_rows, rhs.n_cols, arma::fill::zeros);
+    std::vector<char> col_converged(rhs.n_cols, 1);
+    arma::vec pre(diag.n_elem, arma::fill::zeros);
+    for (arma::uword a = 0; a < diag.n_elem; a++) {
+      if (diag[a] > 0) pre[a] = 1.0 / diag[a];
+    }
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic) if(n_threads > 1)
+#endif
+    for (int k = 0; k < (int)rhs.n_cols; k++) {
+      arma::vec x;
+      col_converged[k] = conjugate_gradient(rhs.col(k), pre, tol, max_iteration, x);
+      res.col(k) = x;
+    }
+    if (converged != nullptr) {
+      *converged = std::find(col_converged.begin(), col_converged.end(), 0) == col_converged.end();
+    }
+    return res;
+  }
+
+private:
+  // Writes the iterate to x and returns whether the relative residual fell below
+  // tol. A nonpositive curvature p'Ap (p in the null space of A, e.g. for a
+  // right-hand side outside the range of A) ends the iterations early.
+  bool conjugate_gradient(const arma::vec &b, const arma::vec &pre,
+                          double tol, int max_iteration, arma::vec &x) const {
+    x.zeros(b.n_elem);
+    const double norm_b = arma::norm(b);
+    if (norm_b == 0) return true;
+    arma::vec r = b, z = pre % r, p = z;
+    double rz = arma::dot(r, z);
+    for (int it = 0; it < max_iteration && arma::norm(r) > tol * norm_b; it++) {
+      const arma::vec Ap = times(p);
+      const double pAp = arma::dot(p, Ap);
+      if (pAp <= 0) break;
+      const double alpha = rz / pAp;
+      x += alpha * p;
+      r -= alpha * Ap;
+      z = pre % r;
+      const double rz_new = arma::dot(r, z);
+      p = z + (rz_new / rz) * p;
+      rz = rz_new;
+    }
+    return arma::norm(r) <= tol * norm_b;
+  }
+};
+
+// Sum of rank-one terms q q' / c, stored as the columns q of Q and the weights 1 / c.
+// Only the last max_terms terms are kept (limited memory): once full, a new term
+// overwrites the oldest one, so memory is O(dimension * max_terms) however many
+// iterations the accelerated MM algorithm runs. Accelerated steps are only taken
+// when they beat the plain MM step, so dropping old terms cannot stall the ascent.
+class LowRankUpdate {
+public:
+  arma::mat Q;
+  arma::vec weights;
+  arma::uword max_terms;
+
+  explicit LowRankUpdate(arma::uword max_terms_ = 100) : max_terms(max_terms_), next(0) {}
+
+  void add(const arma::vec &q, double c) {
+    if (Q.n_cols < max_terms) {
+      Q.insert_cols(Q.n_cols, q);
+      weights.resize(weights.n_elem + 1);
+      weights[weights.n_elem - 1] = 1.0 / c;
+    } else {
+      Q.col(next) = q;
+      weights[next] = 1.0 / c;
+      next = (next + 1) % max_terms;
+    }
+  }
+
+  arma::vec times(const arma::vec &x) const {
+    if (Q.n_cols == 0) return arma::vec(x.n_elem, arma::fill::zeros);
+    return Q * (weights % (Q.t() * x));
+  }
+
+private:
+  arma::uword next;
+};
+#endif
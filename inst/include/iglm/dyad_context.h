@@ -0,0 +1,54 @@
+// Defines the evaluation context of a single dyad that is shared by all terms
+// evaluated for one proposal (see XZ_class::dyad_context).
+
+#ifndef dyad_context_H
+#define dyad_context_H
+#include <vector>
+
+// Lazily memoised quantities of the dyad (unit_i, unit_j). Every quantity lives
+// in a fixed slot that is filled on first use and reused by all later terms
+// until the context is moved to another dyad or invalidated. The slot buffers
+// keep their capacity, so that repeated evaluations do not allocate.
+//
+// Only the common partners have slots, since they cost a list intersection per
+// term. Degrees are sizes of the adjacency lists (or out_degrees_nb and
+// in_degrees_nb within the overlap) and the sums of an attribute over the
+// neighbours are running sums (XZ_class::x_sums, XYZ_class::y_sums), so both are
+// already O(1) lookups that a slot would not make cheaper.
+class DyadContext {
+public:
+  // Slots of integer vectors: common partners, global (0-3) and local (4-7)
+  static const unsigned N_VEC_SLOTS = 8;
+
+  DyadContext() : unit_i(-1), unit_j(-1), valid_vec(0) {}
+
+  // Moves the context to the dyad (from, to) and drops everything memoised
+  inline void begin(int from, int to) {
+    unit_i = from;
+    unit_j = to;
+    valid_vec = 0;
+  }
+  // Drops everything memoised, e.g., after the network changed
+  inline void invalidate() {
+    valid_vec = 0;
+  }
+
+  // Vector in slot for the dyad (from, to), filled by fill(out) if not yet known.
+  // The reference stays valid until the context is moved or invalidated.
+  template <class Fill>
+  inline const std::vector<int>& vec(unsigned slot, int from, int to, Fill fill) {
+    if (from != unit_i || to != unit_j) begin(from, to);
+    if (!(valid_vec & (1u << slot))) {
+      fill(vecs[slot]);
+      valid_vec |= (1u << slot);
+    }
+    return vecs[slot];
+  }
+
+private:
+  int unit_i;
+  int unit_j;
+  unsigned valid_vec;
+  std::vector<int> vecs[N_VEC_SLOTS];
+};
+#endif
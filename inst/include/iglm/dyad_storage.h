@@ -0,0 +1,115 @@
+// Defines dyad-level storage (membership flags and integer indices) that is either
+// dense (n_actor x n_actor arrays) or sparse (hashed), selected at construction.
+
+#ifndef dyad_storage_H
+#define dyad_storage_H
+#include <vector>
+#include <cstdint>
+#include <unordered_set>
+#include <unordered_map>
+
+#ifndef IGLM_SPARSE_MIN_ACTORS
+#define IGLM_SPARSE_MIN_ACTORS 10000
+#endif
+
+enum class StorageMode { automatic, dense, sparse };
+
+// Mode that StorageMode::automatic stands for, automatic unless a test run
+// changed it (e.g., to run the sparse backend on small networks, see
+// iglm_internal_test)
+inline StorageMode& default_storage_mode() {
+  static StorageMode mode = StorageMode::automatic;
+  return mode;
+}
+
+// Dense storage needs several n_actor^2 arrays, which is infeasible for large
+// networks. With StorageMode::automatic we switch to hashed storage from
+// IGLM_SPARSE_MIN_ACTORS actors onwards.
+inline StorageMode resolve_storage_mode(StorageMode mode, int n_actor) {
+  if (mode == StorageMode::automatic) mode = default_storage_mode();
+  if (mode != StorageMode::automatic) return mode;
+  return (n_actor >= IGLM_SPARSE_MIN_ACTORS) ? StorageMode::sparse : StorageMode::dense;
+}
+
+// Key of the ordered dyad (from, to) with 1-based actor ids
+inline std::uint64_t dyad_key(int from, int to, int n_actor) {
+  return (std::uint64_t)(from - 1) * (std::uint64_t)n_actor + (std::uint64_t)(to - 1);
+}
+
+// Set of ordered dyads (from, to)
+class DyadSet {
+public:
+  DyadSet() : n_actor(0), mode(StorageMode::dense) {}
+
+  void init(int n_actor_, StorageMode mode_) {
+    n_actor = n_actor_;
+    mode = mode_;
+    hashed.clear();
+    if (mode == StorageMode::dense) {
+      flags.assign((size_t)n_actor * n_actor, 0);
+    } else {
+      std::vector<char>().swap(flags);
+    }
+  }
+
+  void clear() { init(n_actor, mode); }
+
+  inline bool test(int from, int to) const {
+    if (mode == StorageMode::dense) return flags[dyad_key(from, to, n_actor)];
+    return hashed.find(dyad_key(from, to, n_actor)) != hashed.end();
+  }
+  inline void set(int from, int to) {
+    if (mode == StorageMode::dense) flags[dyad_key(from, to, n_actor)] = 1;
+    else hashed.insert(dyad_key(from, to, n_actor));
+  }
+  inline void reset(int from, int to) {
+    if (mode == StorageMode::dense) flags[dyad_key(from, to, n_actor)] = 0;
+    else hashed.erase(dyad_key(from, to, n_actor));
+  }
+
+private:
+  int n_actor;
+  StorageMode mode;
+  std::vector<char> flags;
+  std::unordered_set<std::uint64_t> hashed;
+};
+
+// Map from ordered dyads (from, to) to a non-negative index, -1 if absent
+class DyadIndex {
+public:
+  DyadIndex() : n_actor(0), mode(StorageMode::dense) {}
+
+  void init(int n_actor_, StorageMode mode_) {
+    n_actor = n_actor_;
+    mode = mode_;
+    hashed.clear();
+    if (mode == StorageMode::dense) {
+      index.assign((size_t)n_actor * n_actor, -1);
+    } else {
+      std::vector<int>().swap(index);
+    }
+  }
+
+  void clear() { init(n_actor, mode); }
+
+  inline int get(int from, int to) const {
+    if (mode == StorageMode::dense) return index[dyad_key(from, to, n_actor)];
+    auto it = hashed.find(dyad_key(from, to, n_actor));
+    return (it == hashed.end()) ? -1 : it->second;
+  }
+  inline void set(int from, int to, int idx) {
+    if (mode == StorageMode::dense) index[dyad_key(from, to, n_actor)] = idx;
+    else hashed[dyad_key(from, to, n_actor)] = idx;
+  }
+  inline void erase(int from, int to) {
+    if (mode == StorageMode::dense) index[dyad_key(from, to, n_actor)] = -1;
+    else hashed.erase(dyad_key(from, to, n_actor));
+  }
+
+private:
+  int n_actor;
+  StorageMode mode;
+  std::vector<int> index;
+  std::unordered_map<std::uint64_t, int> hashed;
+};
+#endif
@@ -36,11 +36,87 @@ namespace iglm {
 using ExtFn = double(*)(const ::XYZ_class&,const int&,const int&,const arma::mat&,
                      const double&,const std::string&,const bool&);
 
+// --- Batched function type ---
+// Evaluates a term for the n pairs (units_i[d], units_j[d]) of one mode at the
+// current state and writes the change statistics to out[0], ..., out[n-1]
+// (a column of the design matrix). For "x" and "y", units_i == units_j.
+using BatchExtFn = void(*)(const ::XYZ_class&,const int*,const int*,const size_t&,
+                           const arma::mat&,const double&,const std::string&,const bool&,
+                           double*);
+
+// --- Modes ---
+// A change statistic is evaluated for a toggle of z_ij ("z") or for a change of
+// x_i ("x") or y_i ("y"). Terms declare the modes they respond to as a bit mask,
+// all other modes are assumed to give a change statistic of 0.
+enum class Mode { z = 0, x = 1, y = 2 };
+constexpr int N_MODES = 3;
+constexpr unsigned MODE_Z = 1u << 0;
+constexpr unsigned MODE_X = 1u << 1;
+constexpr unsigned MODE_Y = 1u << 2;
+constexpr unsigned MODES_ALL = MODE_Z | MODE_X | MODE_Y;
+
+constexpr unsigned mode_bit(Mode mode) { return 1u << static_cast<int>(mode); }
+
+// --- Term properties ---
+// Flags that can be or-ed into the modes of a term. A term is dyad independent
+// if its change statistics only depend on the unit(s) and the term data, not on
+// the current state of z, x or y. Models made up of such terms only have
+// independent variables, so that the pseudo-likelihood is the likelihood and
+// the network can be drawn without MCMC.
+constexpr unsigned DYAD_INDEPENDENT = 1u << 8;
+// The first entry of the term data is the decay of geometric weights, which
+// are tabulated before the term is evaluated (see XZ_class::geometric_weights).
+constexpr unsigned GEOMETRIC_WEIGHTS = 1u << 9;
+// The term counts the common partners of many edges of the whole network
+// (SHARED_PARTNERS) or of the overlap (SHARED_PARTNERS_LOCAL) with
+// XZ_class::cached_common_partners(_nb), so that these counts are maintained
+// incrementally during MCMC (see SharedPartnerCache).
+constexpr unsigned SHARED_PARTNERS = 1u << 10;
+constexpr unsigned SHARED_PARTNERS_LOCAL = 1u << 11;
+
+// String passed on to the terms (the ExtFn signature stays string-based)
+inline const std::string& mode_name(Mode mode) {
+  static const std::string names[N_MODES] = {"z", "x", "y"};
+  return names[static_cast<int>(mode)];
+}
 
 struct FUN {
   ExtFn fn;
   std::string short_name;
   double value;
+  unsigned modes = MODES_ALL;
+  BatchExtFn batch_fn = nullptr;
+  bool dyad_independent = false;
+  bool geometric_weights = false;
+  bool shared_partners = false;
+  bool shared_partners_local = false;
+};
+
+// A term of a model: its position, scalar function and optional batched function
+struct TermEntry {
+  size_t pos;
+  ExtFn fn;
+  BatchExtFn batch_fn;
+};
+
+// Change statistics of one model. by_mode[m] holds the terms that respond to
+// mode m, so that samplers only call relevant terms.
+struct TermTable {
+  std::vector<ExtFn> fns;
+  std::vector<TermEntry> by_mode[N_MODES];
+  // Whether all terms are dyad independent (see DYAD_INDEPENDENT)
+  bool dyad_independent = true;
+  // Positions of the terms with geometric weights (see GEOMETRIC_WEIGHTS)
+  std::vector<size_t> geometric_weights;
+  // Whether some term uses the common partners of the whole network or of the
+  // overlap (see SHARED_PARTNERS)
+  bool shared_partners = false;
+  bool shared_partners_local = false;
+
+  size_t size() const { return fns.size(); }
+  const std::vector<TermEntry>& operator[](Mode mode) const {
+    return by_mode[static_cast<int>(mode)];
+  }
 };
 
 
@@ -51,9 +127,14 @@ public:
   bool add(const std::string& name,
            ExtFn fn,
            const std::string& short_name,
-           double value);
+           double value,
+           unsigned modes = MODES_ALL,
+           BatchExtFn batch_fn = nullptr);
   
   bool has(const std::string& name) const;
+
+  // Drops a registration, e.g., of a term that only a test registered
+  bool remove(const std::string& name);
   
   ExtFn get(const std::string& name) const;
   
@@ -63,6 +144,9 @@ public:
   
   std::vector<FUN> all_meta() const;
   
+  // Per-mode function tables for the given terms (in this order)
+  TermTable table(const std::vector<std::string>& terms) const;
+  
 private:
   Registry() = default;
   Registry(const Registry&) = delete;
@@ -76,21 +160,51 @@ struct Registrar {
   Registrar(const std::string& name,
             ExtFn fn,
             const std::string& short_name,
-            double value)
+            double value,
+            unsigned modes = MODES_ALL)
   {
 #ifdef IGLM_COMPILING_IGLM
     // When compiling iglm itself, call the registry directly.
-    if (!Registry::instance().add(name, fn, short_name, value)) {
+    if (!Registry::instance().add(name, fn, short_name, value, modes)) {
       Rcpp::Rcerr << "Duplicate extension name '" << name << "' ignored.\n";
     }
 #else
     // When compiling an extension package, call through R_GetCCallable so that
     // the registration always lands in iglm's singleton — not a duplicate one
     // created by the extension's DLL.
-    typedef void (*reg_fn_t)(const char*, void*, const char*, double);
-    reg_fn_t reg = (reg_fn_t)R_GetCCallable("iglm", "iglm_register_term_C");
+    if (modes == MODES_ALL) {
+      typedef void (*reg_fn_t)(const char*, void*, const char*, double);
+      reg_fn_t reg = (reg_fn_t)R_GetCCallable("iglm", "iglm_register_term_C");
+      if (reg) {
+        reg(name.c_str(), (void*)fn, short_name.c_str(), value);
+      }
+    } else {
+      typedef void (*reg_modes_fn_t)(const char*, void*, const char*, double, unsigned);
+      reg_modes_fn_t reg = (reg_modes_fn_t)R_GetCCallable("iglm", "iglm_register_term_modes_C");
+      if (reg) {
+        reg(name.c_str(), (void*)fn, short_name.c_str(), value, modes);
+      }
+    }
+#endif
+  }
+  
+  // Terms with an additional batched implementation
+  Registrar(const std::string& name,
+            ExtFn fn,
+            BatchExtFn batch_fn,
+            const std::string& short_name,
+            double value,
+            unsigned modes)
+  {
+#ifdef IGLM_COMPILING_IGLM
+    if (!Registry::instance().add(name, fn, short_name, value, modes, batch_fn)) {
+      Rcpp::Rcerr << "Duplicate extension name '" << name << "' ignored.\n";
+    }
+#else
+    typedef void (*reg_batch_fn_t)(const char*, void*, void*, const char*, double, unsigned);
+    reg_batch_fn_t reg = (reg_batch_fn_t)R_GetCCallable("iglm", "iglm_register_term_batch_C");
     if (reg) {
-      reg(name.c_str(), (void*)fn, short_name.c_str(), value);
+      reg(name.c_str(), (void*)fn, (void*)batch_fn, short_name.c_str(), value, modes);
     }
 #endif
   }
@@ -108,4 +222,15 @@ struct Registrar {
 #define EFFECT_REGISTER(NAME, FN, SHORT, VAL) \
 static ::iglm::Registrar iglm_UNIQ(_iglm_registrar_){ (NAME), (FN), (SHORT), (VAL) }
 
+// Same as EFFECT_REGISTER for terms that only respond to some modes, e.g.
+// EFFECT_REGISTER_MODES("edges_global", ::fn, "edges_global", 0, ::iglm::MODE_Z).
+// Dyad independent terms add ::iglm::DYAD_INDEPENDENT to the modes.
+#define EFFECT_REGISTER_MODES(NAME, FN, SHORT, VAL, MODES) \
+static ::iglm::Registrar iglm_UNIQ(_iglm_registrar_){ (NAME), (FN), (SHORT), (VAL), (MODES) }
+
+// Registers a term with a scalar (FN, used by the samplers) and a batched
+// (BATCH, used when building pseudo-likelihood design matrices) implementation
+#define EFFECT_REGISTER_BATCH(NAME, FN, BATCH, SHORT, VAL, MODES) \
+static ::iglm::Registrar iglm_UNIQ(_iglm_registrar_){ (NAME), (FN), (BATCH), (SHORT), (VAL), (MODES) }
+
 } // namespace iglm
\ No newline at end of file
@@ -0,0 +1,43 @@
+// Defines the precomputed geometric weights of the gwesp, gwdsp and gwdegree
+// terms (see XZ_class::geometric_weights).
+
+#ifndef geometric_weights_H
+#define geometric_weights_H
+#include <vector>
+#include <cmath>
+
+// Powers (1 - exp(-decay))^k for k = 0, ..., max_count together with exp(decay).
+// Counts of partners or degrees are integers bounded by n_actor, so every
+// pow() on the hot path becomes a table lookup. Counts outside of the table
+// (e.g., -1 when an edge is counted as its own partner) fall back to pow().
+class GeometricWeights {
+public:
+  double decay;
+  // exp(decay) and 1 - exp(-decay)
+  double expo_pos;
+  double expo_min;
+
+  GeometricWeights() : decay(0.0), expo_pos(1.0), expo_min(0.0) {}
+  GeometricWeights(double decay_, int max_count) :
+    decay(decay_), expo_pos(std::exp(decay_)), expo_min(1 - std::exp(-decay_)) {
+    powers.resize(max_count + 1);
+    double p = 1.0;
+    for (int k = 0; k <= max_count; k++) {
+      powers[k] = p;
+      p *= expo_min;
+    }
+  }
+
+  // (1 - exp(-decay))^count
+  inline double operator()(double count) const {
+    if (count >= 0 && count < (double)powers.size()) {
+      int k = (int)count;
+      if (k == count) return powers[k];
+    }
+    return std::pow(expo_min, count);
+  }
+
+private:
+  std::vector<double> powers;
+};
+#endif
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include "iglm/dyad_storage.h"
 #ifndef IGLM_API
 #if defined(_WIN32)
 #ifdef IGLM_COMPILING_IGLM
@@ -290,8 +291,7 @@ inline size_t count_intersection(
 // Vector implementations
 inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
                     std::vector<std::vector<int>>& adj_list,
-                    std::vector<std::vector<int>>& adj_list_in,
-                    std::vector<char>& adj_mat) {
+                    std::vector<std::vector<int>>& adj_list_in) {
 
   for (int i = 0; i <= n_actor; i++) { 
     adj_list[i].clear();
@@ -299,16 +299,11 @@ inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
       adj_list_in[i].clear();
     }
   } 
-  adj_mat.assign(n_actor * n_actor, 0);
 
   if (mat.is_empty() || mat.n_elem == 0) {
     return;
   }
 
-  auto get_mat_idx = [n_actor](int r, int c) {
-    return (r - 1) * n_actor + (c - 1);
-  };
-
   // Check whether an edge list or adjacency matrix is provided
   if(mat.n_cols == 2) {
     const arma::vec& tmp_row1 = mat.col(0);
@@ -322,13 +317,10 @@ inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
           continue; 
       }
       
-      adj_mat[get_mat_idx(from, to)] = 1;
-      
       if(directed) {
         adj_list[from].push_back(to);
         adj_list_in[to].push_back(from);
       } else {
-        adj_mat[get_mat_idx(to, from)] = 1;
         adj_list[from].push_back(to);
         adj_list[to].push_back(from);
       }
@@ -345,7 +337,6 @@ inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
       for(arma::uword j = 1; j <= n_actor; j++) {
         if(mat(i-1, j-1) == 1) {
           adj_list[i].push_back(j);
-          adj_mat[get_mat_idx(i, j)] = 1;
           if(directed) {
             adj_list_in[j].push_back(i);
           }
@@ -355,6 +346,39 @@ inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
   }
 }
 
+// Same as above, additionally marking every listed dyad in a DyadSet
+inline void mat_to_map_vec(arma::mat mat, int n_actor, bool directed,
+                    std::vector<std::vector<int>>& adj_list,
+                    std::vector<std::vector<int>>& adj_list_in,
+                    DyadSet& dyads) {
+  mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in);
+  dyads.clear();
+  if (mat.is_empty() || mat.n_elem == 0) {
+    return;
+  }
+  if(mat.n_cols == 2) {
+    for (arma::uword k = 0; k < mat.n_rows; ++k) {
+      int from = (int)mat(k, 0);
+      int to = (int)mat(k, 1);
+      if (from < 1 || from > n_actor || to < 1 || to > n_actor) {
+          continue; 
+      }
+      dyads.set(from, to);
+      if(!directed) {
+        dyads.set(to, from);
+      }
+    }
+  } else {
+    for (int i = 1; i <= n_actor; i++) {
+      for(int j = 1; j <= n_actor; j++) {
+        if(mat(i-1, j-1) == 1) {
+          dyads.set(i, j);
+        }
+      }
+    } 
+  }
+}
+
 inline std::vector<int> get_intersection_vec(
     const std::vector<int>& v1,
     const std::vector<int>& v2)
@@ -365,6 +389,16 @@ inline std::vector<int> get_intersection_vec(
   return intersection;
 }
 
+// As get_intersection_vec, but writes into out so that its capacity is reused
+inline void get_intersection_into(
+    const std::vector<int>& v1,
+    const std::vector<int>& v2,
+    std::vector<int>& out)
+{
+  out.clear();
+  std::set_intersection(v1.begin(), v1.end(), v2.begin(), v2.end(), std::back_inserter(out));
+}
+
 inline size_t count_intersection_vec(
     const std::vector<int>& v1,
     const std::vector<int>& v2)
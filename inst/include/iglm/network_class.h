@@ -8,6 +8,21 @@
 #include <vector>
 #include <algorithm>
 #include "iglm/helper_functions.h"
+#include "iglm/bit_matrix.h"
+#include "iglm/dyad_storage.h"
+
+// Kind of common partner k of the dyad (from, to):
+// OTP: from -> k -> to, ISP: k -> from and k -> to,
+// OSP: from -> k and to -> k, ITP: to -> k -> from
+enum class PartnerType { OTP, ISP, OSP, ITP };
+
+// Whether the partners of "from" (resp. "to") are out-neighbours
+constexpr bool partner_from_out(PartnerType type) {
+  return type == PartnerType::OTP || type == PartnerType::OSP;
+}
+constexpr bool partner_to_out(PartnerType type) {
+  return type == PartnerType::OSP || type == PartnerType::ITP;
+}
 
 class IGLM_API Network {
 public:
@@ -16,7 +31,12 @@ public:
   unsigned int number_edges; 
   std::vector<std::vector<int>> adj_list;
   std::vector<std::vector<int>> adj_list_in;
-  std::vector<char> adj_mat;
+  // Dense mode: bit-packed adjacency, row i of adj_bits holds the out-neighbours of
+  // actor i+1, row j of adj_bits_in the in-neighbours of actor j+1 (only kept if directed).
+  BitMatrix adj_bits;
+  BitMatrix adj_bits_in;
+  // Sparse mode: hashed set of edges (both directions stored if undirected)
+  DyadSet adj_set;
   std::vector<int> out_degrees;
   std::vector<int> in_degrees;
 
@@ -28,33 +48,80 @@ public:
   }
 
   // Constructors
-  Network (int n_actor_, bool directed_);
-  Network (int n_actor_, bool directed_, arma::mat mat);
+  Network (int n_actor_, bool directed_, StorageMode storage_ = StorageMode::automatic);
+  Network (int n_actor_, bool directed_, arma::mat mat, StorageMode storage_ = StorageMode::automatic);
   
   void set_network_from_mat(int n_actor_, bool directed_, arma::mat mat);
   void change_edge(int from, int to);
   
   size_t count_common_partners(unsigned int from, unsigned int to, std::string type = "OSP") const;
   std::vector<int> get_common_partners(unsigned int from,unsigned int to, std::string type = "OSP")const;
+  // Compile-time versions of the above, used in the inner loops of the change statistics
+  template <PartnerType type>
+  size_t count_common_partners(unsigned int from, unsigned int to) const;
+  template <PartnerType type>
+  std::vector<int> get_common_partners(unsigned int from, unsigned int to) const;
   
   double count_edges() const;
   
+  inline bool has_edge(int from, int to) const {
+    if (storage == StorageMode::sparse) return adj_set.test(from, to);
+    return adj_bits.test(from - 1, to - 1);
+  }
+
   inline double get_val(int from, int to) const {
     if (from < 1 || from > n_actor || to < 1 || to > n_actor) {
         return 0.0;
     }
-    size_t idx = get_mat_idx(from, to);
-    if (idx >= adj_mat.size()) return 0.0; 
-    return adj_mat[idx] ? 1.0 : 0.0;
+    return has_edge(from, to) ? 1.0 : 0.0;
   }
   
   int get_n_actor() const { return n_actor; }
-  
+  StorageMode get_storage_mode() const { return storage; }
+
   void add_edge(int from, int to);
   void delete_edge(int from, int to);
   void add_edges_from_mat(arma::mat mat);
   
 private:
   int n_actor;
+  StorageMode storage;
+  void set_edge_flags(int from, int to);
+  void reset_edge_flags(int from, int to);
+  void reset_bits();
+  void set_bits_from_lists();
+  inline const BitMatrix& in_bits() const { return directed ? adj_bits_in : adj_bits; }
 };
+
+template <PartnerType type>
+size_t Network::count_common_partners(unsigned int from, unsigned int to) const {
+    // Partners k of "from" are taken from l1 and those of "to" from l2; the
+    // membership of k in the other set is probed with has_edge. In dense mode
+    // with long lists the two bit rows are intersected word by word instead.
+    constexpr bool from_out = partner_from_out(type);
+    constexpr bool to_out = partner_to_out(type);
+    if (type != PartnerType::OSP && !directed) return 0;
+    const std::vector<int>& l1 = from_out ? adj_list[from] : adj_list_in[from];
+    const std::vector<int>& l2 = to_out ? adj_list[to] : adj_list_in[to];
+
+    size_t min_size = std::min(l1.size(), l2.size());
+    if (storage == StorageMode::sparse || min_size < adj_bits.get_n_words()) {
+        size_t count = 0;
+        if (l1.size() <= l2.size()) {
+            for (int k : l1) if (to_out ? has_edge(to, k) : has_edge(k, to)) count++;
+        } else {
+            for (int k : l2) if (from_out ? has_edge(from, k) : has_edge(k, from)) count++;
+        }
+        return count;
+    }
+    const BitMatrix& bits_from = from_out ? adj_bits : adj_bits_in;
+    const BitMatrix& bits_to = to_out ? adj_bits : adj_bits_in;
+    return BitMatrix::count_and(bits_from, from - 1, bits_to, to - 1);
+}
+
+template <PartnerType type>
+std::vector<int> Network::get_common_partners(unsigned int from, unsigned int to) const {
+    return get_intersection_vec(partner_from_out(type) ? adj_list[from] : adj_list_in[from],
+                                partner_to_out(type) ? adj_list[to] : adj_list_in[to]);
+}
 #endif
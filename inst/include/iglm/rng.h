@@ -0,0 +1,174 @@
+// Defines the random number generator of the MCMC samplers (see XZ_class::rng),
+// either R's global generator or a native xoshiro256++ generator with streams.
+
+#ifndef rng_H
+#define rng_H
+#include <RcppArmadillo.h>
+#include <cstdint>
+#include <cmath>
+
+// xoshiro256++ (Blackman and Vigna, 2019). The state is filled by splitmix64
+// from the seed and stream s starts s jumps of 2^128 draws later, so that the
+// streams of one seed never overlap and the draws of a stream do not depend on
+// how many other streams are in use (or on which thread they run).
+class Xoshiro256 {
+public:
+  Xoshiro256() { seed(0, 0); }
+  Xoshiro256(std::uint64_t seed_, std::uint64_t stream) { seed(seed_, stream); }
+
+  // Costs one jump (256 draws) per stream, streams are meant to be small
+  // integers such as the index of a chain
+  void seed(std::uint64_t seed_, std::uint64_t stream) {
+    std::uint64_t x = seed_;
+    for (int i = 0; i < 4; i++) s[i] = splitmix64(x);
+    for (std::uint64_t k = 0; k < stream; k++) jump();
+  }
+
+  inline std::uint64_t next() {
+    const std::uint64_t res = rotl(s[0] + s[3], 23) + s[0];
+    const std::uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return res;
+  }
+
+  // Uniform on (0, 1) with 53 random bits, never exactly 0 or 1
+  inline double unif() {
+    return ((double)(next() >> 11) + 0.5) * 0x1.0p-53;
+  }
+
+  // Equivalent to 2^128 calls of next()
+  void jump() {
+    static const std::uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                         0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    std::uint64_t t[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++) {
+      for (int b = 0; b < 64; b++) {
+        if (JUMP[i] & (std::uint64_t(1) << b)) {
+          for (int j = 0; j < 4; j++) t[j] ^= s[j];
+        }
+        next();
+      }
+    }
+    for (int j = 0; j < 4; j++) s[j] = t[j];
+  }
+
+private:
+  std::uint64_t s[4];
+
+  static inline std::uint64_t rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+  static inline std::uint64_t splitmix64(std::uint64_t &x) {
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+};
+
+// Draws of the samplers. By default they come from R's generator (seeded via
+// set.seed, so results agree with earlier versions of the package); R's
+// generator is global and must only be used from the main thread. With
+// native = TRUE every sampler state owns an Xoshiro256 stream and the
+// Bernoulli, Poisson and normal draws are computed here, which is faster per
+// draw and safe to use from several threads with one state per thread.
+class SamplerRNG {
+public:
+  SamplerRNG() : native(false), has_spare(false), spare(0.0) {}
+
+  bool is_native() const { return native; }
+
+  // seed = NA_INTEGER keeps the current state of R's generator, or draws the
+  // seed of the native generator from it
+  void seed(bool native_, int seed_, std::uint64_t stream = 0) {
+    native = native_;
+    has_spare = false;
+    if (!native) {
+      if (seed_ != NA_INTEGER) {
+        Rcpp::Function set_seed_r("set.seed");
+        set_seed_r(seed_);
+      }
+      return;
+    }
+    std::uint64_t s = (seed_ != NA_INTEGER) ? (std::uint64_t)(std::int64_t)seed_ :
+      (std::uint64_t)(R::unif_rand() * 4294967296.0);
+    generator.seed(s, stream);
+  }
+
+  // Uniform on (0, 1)
+  inline double unif() {
+    return native ? generator.unif() : R::unif_rand();
+  }
+
+  // Uniform on 0, ..., n - 1
+  inline int index(std::size_t n) {
+    std::size_t k = (std::size_t)(unif() * n);
+    return (int)(k < n ? k : n - 1);
+  }
+
+  inline bool bernoulli(double p) {
+    return unif() < p;
+  }
+
+  double poisson(double mu) {
+    if (!native) return R::rpois(mu);
+    if (!(mu > 0)) return 0.0;
+    if (mu < 10) {
+      // Inversion by sequential search
+      double p = std::exp(-mu), cum = p, u = generator.unif();
+      int k = 0;
+      while (u > cum && k < 1000) {
+        k++;
+        p *= mu / k;
+        cum += p;
+      }
+      return k;
+    }
+    // Transformed rejection with squeeze (PTRS, Hoermann 1993)
+    const double slam = std::sqrt(mu), loglam = std::log(mu);
+    const double b = 0.931 + 2.53 * slam, a = -0.059 + 0.02483 * b;
+    const double invalpha = 1.1239 + 1.1328 / (b - 3.4), vr = 0.9277 - 3.6224 / (b - 2);
+    while (true) {
+      const double U = generator.unif() - 0.5, V = generator.unif();
+      const double us = 0.5 - std::fabs(U);
+      const double k = std::floor((2 * a / us + b) * U + mu + 0.43);
+      if (us >= 0.07 && V <= vr) return k;
+      if (k < 0 || (us < 0.013 && V > us)) continue;
+      if (std::log(V) + std::log(invalpha) - std::log(a / (us * us) + b) <=
+          -mu + k * loglam - std::lgamma(k + 1)) {
+        return k;
+      }
+    }
+  }
+
+  double normal(double mean, double sd) {
+    if (!native) return R::rnorm(mean, sd);
+    // Marsaglia's polar method, the second draw of a pair is kept for the next call
+    if (has_spare) {
+      has_spare = false;
+      return mean + sd * spare;
+    }
+    double u, v, s;
+    do {
+      u = 2.0 * generator.unif() - 1.0;
+      v = 2.0 * generator.unif() - 1.0;
+      s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    const double f = std::sqrt(-2.0 * std::log(s) / s);
+    spare = v * f;
+    has_spare = true;
+    return mean + sd * u * f;
+  }
+
+private:
+  bool native;
+  Xoshiro256 generator;
+  bool has_spare;
+  double spare;
+};
+#endif
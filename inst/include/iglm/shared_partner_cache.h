@@ -0,0 +1,133 @@
+// Defines an incrementally maintained map from the edges of a network to
+// their numbers of common partners (see PartnerType).
+
+#ifndef shared_partner_cache_H
+#define shared_partner_cache_H
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include "iglm/network_class.h"
+
+// Common partners of every edge (a, b), indexed by PartnerType (OTP, ISP, OSP, ITP).
+// Undirected networks only track OSP, the other counts stay 0.
+//
+// The adjacency is passed in as sorted out- and in-lists together with an edge
+// test, so that the same code serves the global network and its restriction to
+// the overlap. Toggling the edge (u, v) only changes the counts of edges that
+// start or end in u or v, which makes an update O(degree).
+class SharedPartnerCache {
+public:
+  typedef std::array<int, 4> Counts;
+
+  SharedPartnerCache() : n_actor(0), active(false) {}
+
+  bool enabled() const { return active; }
+
+  // Marks the cache as in use; the counts are filled by the next build
+  void enable() { active = true; }
+
+  void disable() {
+    active = false;
+    std::unordered_map<std::uint64_t, Counts>().swap(counts);
+  }
+
+  // Counts of the edge (from, to), nullptr if (from, to) is not an edge
+  inline const Counts* find(int from, int to) const {
+    auto it = counts.find(dyad_key(from, to, n_actor));
+    return (it == counts.end()) ? nullptr : &it->second;
+  }
+
+  // Recomputes the counts of all edges from scratch, O(sum of degree^2)
+  template <class Out, class In>
+  void build(int n_actor_, bool directed, Out out, In in) {
+    n_actor = n_actor_;
+    active = true;
+    counts.clear();
+    for (int a = 1; a <= n_actor; a++) {
+      for (int b : out(a)) {
+        if (directed || a <= b) insert(a, b, directed, out, in);
+      }
+    }
+  }
+
+  // Updates the counts after the edge (u, v) was added (delta = 1) or deleted
+  // (delta = -1) with u != v. Must be called once the adjacency already reflects
+  // the change.
+  template <class Out, class In, class Edge>
+  void toggle(int u, int v, int delta, bool directed, Out out, In in, Edge edge) {
+    if (!active) return;
+    if (!directed) {
+      // OSP(a, b) = |adj(a) & adj(b)|: v joins adj(u) and u joins adj(v)
+      for (int b : out(u)) {
+        if (b != v && b != u && edge(b, v)) { bump(u, b, OSP, delta); bump(b, u, OSP, delta); }
+      }
+      for (int b : out(v)) {
+        if (b != u && b != v && edge(b, u)) { bump(v, b, OSP, delta); bump(b, v, OSP, delta); }
+      }
+    } else {
+      // v joins out(u): edges (u, b) and (b, u)
+      for (int b : out(u)) {
+        if (b == v || b == u) continue;
+        if (edge(v, b)) bump(u, b, OTP, delta);
+        if (edge(b, v)) bump(u, b, OSP, delta);
+      }
+      for (int b : in(u)) {
+        if (b == u) continue;
+        if (edge(b, v)) bump(b, u, OSP, delta);
+        if (edge(v, b)) bump(b, u, ITP, delta);
+      }
+      // u joins in(v): edges (v, b) and (b, v)
+      for (int b : out(v)) {
+        if (b == v) continue;
+        if (edge(u, b)) bump(v, b, ISP, delta);
+        if (edge(b, u)) bump(v, b, ITP, delta);
+      }
+      for (int b : in(v)) {
+        if (b == u || b == v) continue;
+        if (edge(b, u)) bump(b, v, OTP, delta);
+        if (edge(u, b)) bump(b, v, ISP, delta);
+      }
+    }
+    // Self-loops (u, u) and (v, v) change on both sides and are recounted
+    if (find(u, u)) insert(u, u, directed, out, in);
+    if (find(v, v)) insert(v, v, directed, out, in);
+    if (delta > 0) {
+      insert(u, v, directed, out, in);
+    } else {
+      counts.erase(dyad_key(u, v, n_actor));
+      if (!directed) counts.erase(dyad_key(v, u, n_actor));
+    }
+  }
+
+private:
+  static const int OTP = (int)PartnerType::OTP;
+  static const int ISP = (int)PartnerType::ISP;
+  static const int OSP = (int)PartnerType::OSP;
+  static const int ITP = (int)PartnerType::ITP;
+
+  int n_actor;
+  bool active;
+  std::unordered_map<std::uint64_t, Counts> counts;
+
+  inline void bump(int a, int b, int type, int delta) {
+    auto it = counts.find(dyad_key(a, b, n_actor));
+    if (it != counts.end()) it->second[type] += delta;
+  }
+
+  template <class Out, class In>
+  void insert(int a, int b, bool directed, Out out, In in) {
+    Counts c = {0, 0, 0, 0};
+    c[OSP] = (int)count_intersection_vec(out(a), out(b));
+    if (directed) {
+      c[OTP] = (int)count_intersection_vec(out(a), in(b));
+      c[ISP] = (int)count_intersection_vec(in(a), in(b));
+      c[ITP] = (int)count_intersection_vec(in(a), out(b));
+      counts[dyad_key(a, b, n_actor)] = c;
+    } else {
+      counts[dyad_key(a, b, n_actor)] = c;
+      counts[dyad_key(b, a, n_actor)] = c;
+    }
+  }
+};
+#endif
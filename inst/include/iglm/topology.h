@@ -0,0 +1,37 @@
+// Defines the parts of a sampler state that do not change while sampling, i.e.,
+// the neighbourhood and overlap of the actors (see XZ_class::topology).
+
+#ifndef topology_H
+#define topology_H
+#include <RcppArmadillo.h>
+#include <vector>
+#include "dyad_storage.h"
+
+// Neighbourhood and overlap as sorted adjacency lists (1-based, entry 0 unused),
+// as dyad sets for O(1) membership tests and, for the overlap, as the two-column
+// matrix of its dyads, from which the samplers draw proposals.
+// Copies of an XZ_class share one Topology, so that every extra chain or
+// replicate only costs the memory of its network and attributes. Functions
+// that change the neighbourhood detach the topology of their object first
+// (see XZ_class::edit_topology).
+struct Topology {
+  std::vector<std::vector<int>> neighborhood;
+  std::vector<std::vector<int>> overlap;
+  DyadSet overlap_flags;
+  DyadSet neighborhood_flags;
+  arma::mat overlap_mat;
+  std::vector<int> all_actors;
+  // Optional label-based neighbourhood: column c of group_labels assigns every
+  // actor to a group (-1 = none). Two distinct actors are neighbours iff they
+  // share a group in at least one column. With a single column, two actors
+  // overlap (have a common neighbour) iff they share a group of at least three
+  // actors; overlap_labels holds the group of every actor in such a group (-1
+  // otherwise) and group_blocks their members. With several columns, pairs can
+  // also overlap through a neighbour in another column, so the overlap is kept
+  // in overlap_flags and overlap_labels stays empty.
+  std::vector<std::vector<int>> group_labels;
+  std::vector<int> overlap_labels;
+  std::vector<std::vector<int>> group_blocks;
+  std::vector<double> group_blocks_cum_pairs;
+};
+#endif
@@ -0,0 +1,131 @@
+// Defines the products of the pseudo-likelihood design with the coefficients and
+// the weighted cross-products X' diag(w) X and X' r of the Fisher scoring steps
+// (see cond_estimation_nondegrees_pl and pl_estimation).
+
+#ifndef weighted_gram_H
+#define weighted_gram_H
+#include <RcppArmadillo.h>
+#include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Number of rows of a tile. The columns of one tile (together with the
+// weighted column) stay in cache while all p * (p + 1) / 2 products are taken.
+const arma::uword gram_tile = 256;
+
+// Column c of the tile of X starting in row from as doubles. Double designs
+// are read in place, single precision designs are widened into buffer.
+inline const double* gram_column(const arma::mat &X, arma::uword c, arma::uword from,
+                                 arma::uword, double *) {
+  return X.colptr(c) + from;
+}
+
+inline const double* gram_column(const arma::fmat &X, arma::uword c, arma::uword from,
+                                 arma::uword n, double *buffer) {
+  const float *col = X.colptr(c) + from;
+  for (arma::uword i = 0; i < n; i++) buffer[i] = col[i];
+  return buffer;
+}
+
+// X.rows(from, to - 1) * coef without copying the rows
+template <class M>
+arma::vec design_times(const M &X, arma::uword from, arma::uword to,
+                       const arma::vec &coef, int n_threads = 1) {
+  const arma::uword n = to - from, p = X.n_cols;
+  arma::vec res(n, arma::fill::zeros);
+  const arma::uword n_tiles = (n + gram_tile - 1) / gram_tile;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if(n_threads > 1 && n_tiles > 1)
+#endif
+  {
+    std::vector<double> buffer(gram_tile);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (arma::uword t = 0; t < n_tiles; t++) {
+      const arma::uword start = t * gram_tile, m = std::min(gram_tile, n - start);
+      double *out = res.memptr() + start;
+      for (arma::uword c = 0; c < p; c++) {
+        const double beta = coef[c];
+        if (beta == 0) continue;
+        const double *x = gram_column(X, c, from + start, m, buffer.data());
+        for (arma::uword i = 0; i < m; i++) out[i] += beta * x[i];
+      }
+    }
+  }
+  return res;
+}
+
+// Adds X.rows(from, to - 1)' * diag(w) * X.rows(from, to - 1) to fisher and
+// X.rows(from, to - 1)' * r to score in one pass over the rows (w and r are
+// indexed relative to from). An empty w or r skips the respective part.
+// Rows are processed in tiles of gram_tile rows, split over n_threads threads
+// that each accumulate into their own p x p block; only the lower triangle is
+// formed and mirrored at the end. Neither X nor diag(w) * X is materialised.
+template <class M>
+void weighted_crossprod(const M &X, arma::uword from, arma::uword to,
+                        const arma::vec &w, const arma::vec &r,
+                        arma::vec &score, arma::mat &fisher, int n_threads = 1) {
+  const arma::uword n = to - from, p = X.n_cols;
+  const bool with_fisher = w.n_elem > 0, with_score = r.n_elem > 0;
+  if (n == 0 || p == 0 || (!with_fisher && !with_score)) return;
+  const arma::uword n_tiles = (n + gram_tile - 1) / gram_tile;
+  const int n_used = (int)std::max<arma::uword>(1, std::min<arma::uword>(std::max(n_threads, 1), n_tiles));
+  std::vector<arma::mat> fisher_thread(n_used, arma::mat(p, p, arma::fill::zeros));
+  std::vector<arma::vec> score_thread(n_used, arma::vec(p, arma::fill::zeros));
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_used) if(n_used > 1)
+#endif
+  {
+    int thread = 0;
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    arma::mat &F = fisher_thread[thread];
+    arma::vec &S = score_thread[thread];
+    std::vector<double> buffer(gram_tile * p), weighted(gram_tile);
+    std::vector<const double*> cols(p);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (arma::uword t = 0; t < n_tiles; t++) {
+      const arma::uword start = t * gram_tile, m = std::min(gram_tile, n - start);
+      for (arma::uword c = 0; c < p; c++) {
+        cols[c] = gram_column(X, c, from + start, m, buffer.data() + c * gram_tile);
+      }
+      if (with_score) {
+        const double *res = r.memptr() + start;
+        for (arma::uword c = 0; c < p; c++) {
+          double sum = 0.0;
+          for (arma::uword i = 0; i < m; i++) sum += cols[c][i] * res[i];
+          S[c] += sum;
+        }
+      }
+      if (with_fisher) {
+        const double *var = w.memptr() + start;
+        for (arma::uword a = 0; a < p; a++) {
+          for (arma::uword i = 0; i < m; i++) weighted[i] = var[i] * cols[a][i];
+          double *F_col = F.colptr(a);
+          for (arma::uword b = a; b < p; b++) {
+            double sum = 0.0;
+            for (arma::uword i = 0; i < m; i++) sum += weighted[i] * cols[b][i];
+            F_col[b] += sum;
+          }
+        }
+      }
+    }
+  }
+  for (int t = 0; t < n_used; t++) {
+    if (with_score) score += score_thread[t];
+    if (with_fisher) {
+      arma::mat &F = fisher_thread[t];
+      for (arma::uword a = 0; a < p; a++) {
+        for (arma::uword b = a + 1; b < p; b++) F.at(a, b) = F.at(b, a);
+      }
+      fisher += F;
+    }
+  }
+}
+#endif
@@ -12,26 +12,41 @@ public:
   Attribute y_attribute;
   // Constructors
   XYZ_class(int n_actor_, bool directed_, std::string type_x_,std::string type_y_, 
-                       double scale_x_, double scale_y_): XZ_class(n_actor_,directed_, type_x_, scale_x_), y_attribute(n_actor_, type_y_, scale_y_){
-    
+                       double scale_x_, double scale_y_, StorageMode storage_ = StorageMode::automatic):
+    XZ_class(n_actor_,directed_, type_x_, scale_x_, storage_), y_attribute(n_actor_, type_y_, scale_y_){
+    build_neighbour_sums(y_sums, y_attribute);
   } 
-  XYZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_x_,std::string type_y_, double scale_x_, double scale_y_): 
-    XZ_class(n_actor_,directed_, neighborhood_, overlap_, type_x_, scale_x_), y_attribute(n_actor_, type_y_, scale_y_){
+  XYZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_x_,std::string type_y_, double scale_x_, double scale_y_,
+            StorageMode storage_ = StorageMode::automatic, const arma::mat& group_labels_ = arma::mat()): 
+    XZ_class(n_actor_,directed_, neighborhood_, overlap_, type_x_, scale_x_, storage_, group_labels_), y_attribute(n_actor_, type_y_, scale_y_){
+    build_neighbour_sums(y_sums, y_attribute);
   }
   
   XYZ_class(int n_actor_, bool directed_, std::vector<std::vector<int>> neighborhood_,
                        std::vector<std::vector<int>> overlap_, 
                        arma::mat overlap_mat_, 
                        std::string type_x_,std::string type_y_,
-                       double scale_x_, double scale_y_): XZ_class(n_actor_,directed_, neighborhood_, overlap_, overlap_mat_, type_x_, scale_x_),  y_attribute(n_actor_, type_y_, scale_y_){
+                       double scale_x_, double scale_y_, StorageMode storage_ = StorageMode::automatic):
+    XZ_class(n_actor_,directed_, neighborhood_, overlap_, overlap_mat_, type_x_, scale_x_, storage_),  y_attribute(n_actor_, type_y_, scale_y_){
+    build_neighbour_sums(y_sums, y_attribute);
   }
   
   
   XYZ_class(int n_actor_, bool directed_,  arma::vec x_attribute_, arma::vec y_attribute_, arma::mat z_network_,arma::mat neighborhood_, 
-                       arma::mat overlap_, std::string type_x_,std::string type_y_, double scale_x_, double scale_y_):
-    XZ_class(n_actor_,directed_, z_network_,x_attribute_, neighborhood_,overlap_, type_x_, scale_x_),  y_attribute(n_actor_,y_attribute_, type_y_, scale_y_){
+                       arma::mat overlap_, std::string type_x_,std::string type_y_, double scale_x_, double scale_y_,
+                       StorageMode storage_ = StorageMode::automatic, const arma::mat& group_labels_ = arma::mat()):
+    XZ_class(n_actor_,directed_, z_network_,x_attribute_, neighborhood_,overlap_, type_x_, scale_x_, storage_, group_labels_),  y_attribute(n_actor_,y_attribute_, type_y_, scale_y_){
+    build_neighbour_sums(y_sums, y_attribute);
   }
   
+  // Running sums of y over the neighbours of every actor (see XZ_class::x_sums)
+  NeighbourSums y_sums;
+  inline double neighbour_sum_y(int actor, bool out, bool local) const {
+    return y_sums.get(actor, out, local);
+  }
+  void set_y_value(int actor, double val);
+  void rebuild_neighbour_sums() override;
+
   void print();
   
   void set_info(arma::vec x_attribute_,arma::vec y_attribute_,
@@ -42,6 +57,9 @@ public:
   void set_info_arma(arma::vec x_attribute_, arma::vec y_attribute_, arma::mat z_network_);
   
   void copy_from(const XYZ_class& obj);
-  
+
+protected:
+  // Keeps y_sums up to date when edges are toggled through XZ_class
+  void toggle_attribute_sums(int from, int to, int delta, bool in_overlap) override;
 };
 
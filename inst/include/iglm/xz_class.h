@@ -3,45 +3,82 @@
 #include <RcppArmadillo.h>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <map>
 #include "attribute_class.h"
 #include "network_class.h"
+#include "dyad_context.h"
+#include "shared_partner_cache.h"
+#include "geometric_weights.h"
+#include "rng.h"
+#include "topology.h"
 #define DARMA_USE_CURRENT
 
+// Sums of an attribute over the out- and in-neighbours of every actor, in the
+// whole network and within the overlap (_nb). Undirected networks use the same
+// values for both directions.
+struct NeighbourSums {
+  std::vector<double> out, in, out_nb, in_nb;
+  inline double get(int actor, bool out_, bool local) const {
+    if (local) return out_ ? out_nb[actor] : in_nb[actor];
+    return out_ ? out[actor] : in[actor];
+  }
+};
+
 class IGLM_API XZ_class {
 public:
   // Member
   int n_actor;
   Network z_network;
-  std::vector<std::vector<int>> overlap;
   Attribute x_attribute;
   // Other members
-  std::vector<std::vector<int>> neighborhood;
   std::vector<std::vector<int>> adj_list_nb;
   std::vector<std::vector<int>> adj_list_in_nb;
   std::vector<int> out_degrees_nb;
   std::vector<int> in_degrees_nb;
-  std::vector<char> overlap_bool_mat;
-  std::vector<char> neighborhood_bool_mat;
-  arma::mat overlap_mat;
-  std::vector<int> all_actors;
   
   std::vector<std::pair<int, int>> active_edges_nb;
-  std::vector<int> active_edges_nb_idx;
+  // Overlap dyads without an edge, the complement of active_edges_nb within
+  // the overlap; lets the TNT add move draw a non-edge in constant time
+  std::vector<std::pair<int, int>> inactive_edges_nb;
+  // Position of every overlap dyad in active_edges_nb if it has an edge and in
+  // inactive_edges_nb otherwise (-1 outside the overlap). Every dyad is in one
+  // of the two lists, so a single index serves both.
+  DyadIndex overlap_nb_idx;
 
   int N_total_overlap;
   int N_1_overlap;
+
+  // Neighbourhood and overlap, shared by all copies of this state (see Topology)
+  inline const Topology& topology() const { return *topology_; }
+  // Read-only views into the topology, in place of the former public members of
+  // the same name
+  inline const std::vector<std::vector<int>>& neighborhood() const { return topology_->neighborhood; }
+  inline const std::vector<std::vector<int>>& overlap() const { return topology_->overlap; }
+  inline const arma::mat& overlap_mat() const { return topology_->overlap_mat; }
+  inline const std::vector<int>& all_actors() const { return topology_->all_actors; }
+  // Source of all random draws of the samplers on this state (see SamplerRNG),
+  // mutable since drawing does not change the state itself
+  mutable SamplerRNG rng;
   inline size_t get_mat_idx(int from, int to) const {
-    return (from - 1) * n_actor + (to - 1);
+    return (size_t)(from - 1) * n_actor + (to - 1);
   }
-
   // Constructors
-  XZ_class(int n_actor_, bool directed_, std::string type_, double scale_);
-  XZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_);
+  XZ_class(int n_actor_, bool directed_, std::string type_, double scale_,
+           StorageMode storage_ = StorageMode::automatic);
+  // With group_labels (see set_group_labels) the neighbourhood and overlap are
+  // derived from the labels and neighborhood_ and overlap_ are ignored
+  XZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_,
+           StorageMode storage_ = StorageMode::automatic,
+           const arma::mat& group_labels_ = arma::mat());
   XZ_class(int n_actor_, bool directed_, std::vector<std::vector<int>> neighborhood_,
            std::vector<std::vector<int>> overlap_,
-           arma::mat overlap_mat_, std::string type_, double scale_);
+           arma::mat overlap_mat_, std::string type_, double scale_,
+           StorageMode storage_ = StorageMode::automatic);
   XZ_class(int n_actor_, bool directed_, arma::mat z_network_, arma::vec x_attribute_,
-           arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_);
+           arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_,
+           StorageMode storage_ = StorageMode::automatic,
+           const arma::mat& group_labels_ = arma::mat());
   
   // Member functions
   void set_network_from_mat(int n_actor_, bool directed_, arma::mat mat);
@@ -49,11 +86,36 @@ public:
   void add_edge(int from, int to);
   void delete_edge(int from, int to);
 
+  inline bool has_group_labels() const { return !topology_->group_labels.empty(); }
+  inline bool has_overlap_labels() const { return !topology_->overlap_labels.empty(); }
+  inline bool share_group(int from, int to) const {
+    for (const auto& labels : topology_->group_labels) {
+      if (labels[from] >= 0 && labels[from] == labels[to]) return true;
+    }
+    return false;
+  }
+  inline bool share_overlap_group(int from, int to) const {
+    const std::vector<int>& labels = topology_->overlap_labels;
+    return from != to && labels[from] >= 0 && labels[from] == labels[to];
+  }
+  
+  // Membership of (from, to) as stored, i.e., without symmetrisation
+  inline bool get_val_overlap_stored(int from, int to) const {
+    if (has_overlap_labels()) return share_overlap_group(from, to);
+    return topology_->overlap_flags.test(from, to);
+  }
+
   // Overlap is always undirected: the OR ensures (i,j) and (j,i) are treated
-  // identically regardless of which direction was stored in overlap_bool_mat.
+  // identically regardless of which direction was stored in overlap_flags.
   inline bool get_val_overlap(int from, int to) const {
-    return overlap_bool_mat[get_mat_idx(from, to)] || overlap_bool_mat[get_mat_idx(to, from)];
+    if (has_overlap_labels()) return share_overlap_group(from, to);
+    return topology_->overlap_flags.test(from, to) || topology_->overlap_flags.test(to, from);
   }
+  
+  // Neighbourhood and overlap given by group labels (see Topology::group_labels).
+  // The lists and the overlap dyads are enumerated within the groups only.
+  void set_group_labels(const arma::mat& labels);
+  void draw_overlap_dyad(int& from, int& to) const;
 
   double count_edges() const;
   double count_nb_edges() const;
@@ -64,11 +126,120 @@ public:
   
   std::vector<int> get_common_partners_nb(unsigned int from,unsigned int to, std::string type = "OSP")const;
   size_t count_common_partners_nb(unsigned int from, unsigned int to, std::string type = "OSP") const;
+
+  // Compile-time versions of the common-partner queries (see PartnerType)
+  template <PartnerType type>
+  std::vector<int> get_common_partners(unsigned int from, unsigned int to) const {
+    return z_network.get_common_partners<type>(from, to);
+  }
+  template <PartnerType type>
+  size_t count_common_partners(unsigned int from, unsigned int to) const {
+    return z_network.count_common_partners<type>(from, to);
+  }
+  template <PartnerType type>
+  std::vector<int> get_common_partners_nb(unsigned int from, unsigned int to) const {
+    return get_intersection_vec(partner_from_out(type) ? adj_list_nb[from] : adj_list_in_nb[from],
+                                partner_to_out(type) ? adj_list_nb[to] : adj_list_in_nb[to]);
+  }
+  template <PartnerType type>
+  size_t count_common_partners_nb(unsigned int from, unsigned int to) const {
+    const std::vector<int>& l1 = partner_from_out(type) ? adj_list_nb[from] : adj_list_in_nb[from];
+    size_t count = 0;
+    if (partner_to_out(type)) {
+      for (int k : l1) if (z_network.has_edge(to, k) && get_val_overlap_stored(to, k)) count++;
+    } else {
+      for (int k : l1) if (z_network.has_edge(k, to) && get_val_overlap_stored(k, to)) count++;
+    }
+    return count;
+  }
   
+  // Shared evaluation context of the dyad whose change statistics are being
+  // computed; xyz_calculate_change_stats moves it to the proposed dyad so that
+  // terms can share common partners instead of recomputing them. Every thread
+  // that evaluates change statistics uses its own context.
+  DyadContext& dyad_context() const;
+  // Provides contexts for n_threads threads, called before a parallel region
+  void reserve_dyad_contexts(int n_threads) const;
+
+  // Memoised versions of get_common_partners(_nb). The reference is valid until
+  // the next dyad is evaluated or the network changes.
+  template <PartnerType type>
+  const std::vector<int>& shared_common_partners(unsigned int from, unsigned int to) const {
+    return dyad_context().vec((unsigned)type, from, to, [&](std::vector<int>& out) {
+      get_intersection_into(partner_from_out(type) ? z_network.adj_list[from] : z_network.adj_list_in[from],
+                            partner_to_out(type) ? z_network.adj_list[to] : z_network.adj_list_in[to], out);
+    });
+  }
+  template <PartnerType type>
+  const std::vector<int>& shared_common_partners_nb(unsigned int from, unsigned int to) const {
+    return dyad_context().vec(4 + (unsigned)type, from, to, [&](std::vector<int>& out) {
+      get_intersection_into(partner_from_out(type) ? adj_list_nb[from] : adj_list_in_nb[from],
+                            partner_to_out(type) ? adj_list_nb[to] : adj_list_in_nb[to], out);
+    });
+  }
+  // Running sums of x over the neighbours of every actor, kept up to date by
+  // add_edge, delete_edge and set_x_value
+  NeighbourSums x_sums;
+  // Sum of x over the out- (out = true) or in-neighbours of actor, in the whole
+  // network or within the overlap (local = true)
+  inline double neighbour_sum_x(int actor, bool out, bool local) const {
+    return x_sums.get(actor, out, local);
+  }
+  void set_x_value(int actor, double val);
+  // Rebuilds the running sums of the attributes; derived states add their own
+  virtual void rebuild_neighbour_sums();
+
+  // Optional common-partner counts of all edges (partner_cache) and of all edges
+  // within the overlap (partner_cache_nb), kept up to date by add_edge and
+  // delete_edge once enabled
+  SharedPartnerCache partner_cache;
+  SharedPartnerCache partner_cache_nb;
+  void enable_partner_cache(bool global, bool local);
+  void rebuild_partner_cache();
+
+  // count_common_partners(_nb) answered from the cache if (from, to) is a
+  // cached edge, computed otherwise
+  template <PartnerType type>
+  size_t cached_common_partners(unsigned int from, unsigned int to) const {
+    if (partner_cache.enabled()) {
+      const SharedPartnerCache::Counts* c = partner_cache.find(from, to);
+      if (c) return (*c)[(int)type];
+    }
+    return z_network.count_common_partners<type>(from, to);
+  }
+  template <PartnerType type>
+  size_t cached_common_partners_nb(unsigned int from, unsigned int to) const {
+    if (partner_cache_nb.enabled()) {
+      const SharedPartnerCache::Counts* c = partner_cache_nb.find(from, to);
+      if (c) return (*c)[(int)type];
+    }
+    return count_common_partners_nb<type>(from, to);
+  }
+
+  // Geometric weights of the gw* terms, one table per decay parameter. The
+  // tables are built before the terms are evaluated (see
+  // xyz_prepare_geometric_weights) and afterwards only read, possibly from
+  // several threads.
+  void prepare_geometric_weights(double decay) {
+    if (gw_tables.find(decay) == gw_tables.end()) {
+      gw_tables.emplace(decay, GeometricWeights(decay, n_actor));
+    }
+  }
+  const GeometricWeights& geometric_weights(double decay) const {
+    auto it = gw_tables.find(decay);
+    if (it == gw_tables.end()) {
+      Rcpp::stop("The geometric weights for decay " + std::to_string(decay) + " were not prepared");
+    }
+    return it->second;
+  }
+
   inline bool get_val_neighborhood(int from, int to ) const {
-    return neighborhood_bool_mat[get_mat_idx(from, to)];
+    if (has_group_labels()) return from != to && share_group(from, to);
+    return topology_->neighborhood_flags.test(from, to);
   }
   
+  StorageMode get_storage_mode() const { return z_network.get_storage_mode(); }
+
   bool check_if_full_neighborhood() const;
   void print();
   void copy_from(const XZ_class& obj);
@@ -76,4 +247,21 @@ public:
   void neighborhood_initialize();
   void assign_neighborhood(const std::unordered_map< int, std::unordered_set<int>>& new_neighborhood);
   void change_neighborhood(int actor, std::unordered_set<int> new_neighborhood);
+
+protected:
+  void toggle_neighbour_sums(NeighbourSums& sums, const Attribute& attr, int from, int to, double sign, bool in_overlap) const;
+  void shift_neighbour_sums(NeighbourSums& sums, int actor, double delta) const;
+  void build_neighbour_sums(NeighbourSums& sums, const Attribute& attr) const;
+  // Updates the running sums of the attributes after the edge (from, to) was
+  // toggled; derived states with further attributes also update theirs
+  virtual void toggle_attribute_sums(int from, int to, int delta, bool in_overlap);
+
+private:
+  mutable std::vector<DyadContext> dyad_contexts = std::vector<DyadContext>(1);
+  std::shared_ptr<Topology> topology_ = std::make_shared<Topology>();
+  std::map<double, GeometricWeights> gw_tables;
+  // Topology of this object for writing, copied first if it is shared
+  Topology& edit_topology();
+  void invalidate_dyad_contexts();
+  void edge_toggled(int from, int to, int delta, bool in_overlap);
 };
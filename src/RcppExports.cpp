@@ -21,8 +21,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // xyz_count_global
-arma::vec xyz_count_global(const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, int n_actor, std::vector<arma::mat>& data_list, std::vector<double>& type_list, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale);
-RcppExport SEXP _iglm_xyz_count_global(SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP) {
+arma::vec xyz_count_global(const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, int n_actor, std::vector<arma::mat>& data_list, std::vector<double>& type_list, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups);
+RcppExport SEXP _iglm_xyz_count_global(SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP neighborhood_groupsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -40,13 +40,14 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string >::type type_y(type_ySEXP);
     Rcpp::traits::input_parameter< double >::type attr_x_scale(attr_x_scaleSEXP);
     Rcpp::traits::input_parameter< double >::type attr_y_scale(attr_y_scaleSEXP);
-    rcpp_result_gen = Rcpp::wrap(xyz_count_global(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, n_actor, data_list, type_list, type_x, type_y, attr_x_scale, attr_y_scale));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_count_global(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, n_actor, data_list, type_list, type_x, type_y, attr_x_scale, attr_y_scale, neighborhood_groups));
     return rcpp_result_gen;
 END_RCPP
 }
 // xyz_simulate_cpp
-List xyz_simulate_cpp(arma::vec& coef, arma::vec& coef_degrees, std::vector<std::string>& terms, int& n_actor, arma::mat z_network, arma::mat neighborhood, arma::mat overlap, arma::vec x_attribute, arma::vec y_attribute, bool init_empty, bool directed, bool degrees, std::vector<arma::mat>& data_list, std::vector<double>& type_list, double offset_nonoverlap, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int n_proposals_x, int n_proposals_y, int n_proposals_z, int seed, int n_burn_in, int n_simulation, bool only_stats, bool display_progress, bool fix_x, bool fix_z, bool tnt);
-RcppExport SEXP _iglm_xyz_simulate_cpp(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP z_networkSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP init_emptySEXP, SEXP directedSEXP, SEXP degreesSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP offset_nonoverlapSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP n_proposals_xSEXP, SEXP n_proposals_ySEXP, SEXP n_proposals_zSEXP, SEXP seedSEXP, SEXP n_burn_inSEXP, SEXP n_simulationSEXP, SEXP only_statsSEXP, SEXP display_progressSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP tntSEXP) {
+List xyz_simulate_cpp(arma::vec& coef, arma::vec& coef_degrees, std::vector<std::string>& terms, int& n_actor, arma::mat z_network, arma::mat neighborhood, arma::mat overlap, arma::vec x_attribute, arma::vec y_attribute, bool init_empty, bool directed, bool degrees, std::vector<arma::mat>& data_list, std::vector<double>& type_list, double offset_nonoverlap, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int n_proposals_x, int n_proposals_y, int n_proposals_z, int seed, int n_burn_in, int n_simulation, bool only_stats, bool display_progress, bool fix_x, bool fix_z, bool tnt, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups, bool native_rng, int stream, int n_chains);
+RcppExport SEXP _iglm_xyz_simulate_cpp(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP z_networkSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP init_emptySEXP, SEXP directedSEXP, SEXP degreesSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP offset_nonoverlapSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP n_proposals_xSEXP, SEXP n_proposals_ySEXP, SEXP n_proposals_zSEXP, SEXP seedSEXP, SEXP n_burn_inSEXP, SEXP n_simulationSEXP, SEXP only_statsSEXP, SEXP display_progressSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP tntSEXP, SEXP neighborhood_groupsSEXP, SEXP native_rngSEXP, SEXP streamSEXP, SEXP n_chainsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -81,13 +82,106 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type fix_x(fix_xSEXP);
     Rcpp::traits::input_parameter< bool >::type fix_z(fix_zSEXP);
     Rcpp::traits::input_parameter< bool >::type tnt(tntSEXP);
-    rcpp_result_gen = Rcpp::wrap(xyz_simulate_cpp(coef, coef_degrees, terms, n_actor, z_network, neighborhood, overlap, x_attribute, y_attribute, init_empty, directed, degrees, data_list, type_list, offset_nonoverlap, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, n_proposals_x, n_proposals_y, n_proposals_z, seed, n_burn_in, n_simulation, only_stats, display_progress, fix_x, fix_z, tnt));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    Rcpp::traits::input_parameter< bool >::type native_rng(native_rngSEXP);
+    Rcpp::traits::input_parameter< int >::type stream(streamSEXP);
+    Rcpp::traits::input_parameter< int >::type n_chains(n_chainsSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_simulate_cpp(coef, coef_degrees, terms, n_actor, z_network, neighborhood, overlap, x_attribute, y_attribute, init_empty, directed, degrees, data_list, type_list, offset_nonoverlap, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, n_proposals_x, n_proposals_y, n_proposals_z, seed, n_burn_in, n_simulation, only_stats, display_progress, fix_x, fix_z, tnt, neighborhood_groups, native_rng, stream, n_chains));
+    return rcpp_result_gen;
+END_RCPP
+}
+// xyz_session_create
+SEXP xyz_session_create(arma::vec& coef, arma::vec& coef_degrees, std::vector<std::string>& terms, int& n_actor, arma::mat z_network, arma::mat neighborhood, arma::mat overlap, arma::vec x_attribute, arma::vec y_attribute, bool init_empty, bool directed, bool degrees, std::vector<arma::mat>& data_list, std::vector<double>& type_list, double offset_nonoverlap, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int n_proposals_x, int n_proposals_y, int n_proposals_z, int seed, bool fix_x, bool fix_z, bool tnt, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups, bool native_rng, int stream);
+RcppExport SEXP _iglm_xyz_session_create(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP z_networkSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP init_emptySEXP, SEXP directedSEXP, SEXP degreesSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP offset_nonoverlapSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP n_proposals_xSEXP, SEXP n_proposals_ySEXP, SEXP n_proposals_zSEXP, SEXP seedSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP tntSEXP, SEXP neighborhood_groupsSEXP, SEXP native_rngSEXP, SEXP streamSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::vec& >::type coef(coefSEXP);
+    Rcpp::traits::input_parameter< arma::vec& >::type coef_degrees(coef_degreesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string>& >::type terms(termsSEXP);
+    Rcpp::traits::input_parameter< int& >::type n_actor(n_actorSEXP);
+    Rcpp::traits::input_parameter< arma::mat >::type z_network(z_networkSEXP);
+    Rcpp::traits::input_parameter< arma::mat >::type neighborhood(neighborhoodSEXP);
+    Rcpp::traits::input_parameter< arma::mat >::type overlap(overlapSEXP);
+    Rcpp::traits::input_parameter< arma::vec >::type x_attribute(x_attributeSEXP);
+    Rcpp::traits::input_parameter< arma::vec >::type y_attribute(y_attributeSEXP);
+    Rcpp::traits::input_parameter< bool >::type init_empty(init_emptySEXP);
+    Rcpp::traits::input_parameter< bool >::type directed(directedSEXP);
+    Rcpp::traits::input_parameter< bool >::type degrees(degreesSEXP);
+    Rcpp::traits::input_parameter< std::vector<arma::mat>& >::type data_list(data_listSEXP);
+    Rcpp::traits::input_parameter< std::vector<double>& >::type type_list(type_listSEXP);
+    Rcpp::traits::input_parameter< double >::type offset_nonoverlap(offset_nonoverlapSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type_x(type_xSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type_y(type_ySEXP);
+    Rcpp::traits::input_parameter< double >::type attr_x_scale(attr_x_scaleSEXP);
+    Rcpp::traits::input_parameter< double >::type attr_y_scale(attr_y_scaleSEXP);
+    Rcpp::traits::input_parameter< bool >::type nonoverlap_random(nonoverlap_randomSEXP);
+    Rcpp::traits::input_parameter< int >::type n_proposals_x(n_proposals_xSEXP);
+    Rcpp::traits::input_parameter< int >::type n_proposals_y(n_proposals_ySEXP);
+    Rcpp::traits::input_parameter< int >::type n_proposals_z(n_proposals_zSEXP);
+    Rcpp::traits::input_parameter< int >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< bool >::type fix_x(fix_xSEXP);
+    Rcpp::traits::input_parameter< bool >::type fix_z(fix_zSEXP);
+    Rcpp::traits::input_parameter< bool >::type tnt(tntSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    Rcpp::traits::input_parameter< bool >::type native_rng(native_rngSEXP);
+    Rcpp::traits::input_parameter< int >::type stream(streamSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_session_create(coef, coef_degrees, terms, n_actor, z_network, neighborhood, overlap, x_attribute, y_attribute, init_empty, directed, degrees, data_list, type_list, offset_nonoverlap, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, n_proposals_x, n_proposals_y, n_proposals_z, seed, fix_x, fix_z, tnt, neighborhood_groups, native_rng, stream));
+    return rcpp_result_gen;
+END_RCPP
+}
+// xyz_session_run
+List xyz_session_run(SEXP session, int n_simulation, int n_burn_in, bool only_stats, bool display_progress);
+RcppExport SEXP _iglm_xyz_session_run(SEXP sessionSEXP, SEXP n_simulationSEXP, SEXP n_burn_inSEXP, SEXP only_statsSEXP, SEXP display_progressSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< int >::type n_simulation(n_simulationSEXP);
+    Rcpp::traits::input_parameter< int >::type n_burn_in(n_burn_inSEXP);
+    Rcpp::traits::input_parameter< bool >::type only_stats(only_statsSEXP);
+    Rcpp::traits::input_parameter< bool >::type display_progress(display_progressSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_session_run(session, n_simulation, n_burn_in, only_stats, display_progress));
+    return rcpp_result_gen;
+END_RCPP
+}
+// xyz_session_set_coef
+void xyz_session_set_coef(SEXP session, arma::vec& coef, arma::vec& coef_degrees);
+RcppExport SEXP _iglm_xyz_session_set_coef(SEXP sessionSEXP, SEXP coefSEXP, SEXP coef_degreesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    Rcpp::traits::input_parameter< arma::vec& >::type coef(coefSEXP);
+    Rcpp::traits::input_parameter< arma::vec& >::type coef_degrees(coef_degreesSEXP);
+    xyz_session_set_coef(session, coef, coef_degrees);
+    return R_NilValue;
+END_RCPP
+}
+// xyz_session_get_state
+List xyz_session_get_state(SEXP session);
+RcppExport SEXP _iglm_xyz_session_get_state(SEXP sessionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_session_get_state(session));
+    return rcpp_result_gen;
+END_RCPP
+}
+// xyz_session_snapshot
+SEXP xyz_session_snapshot(SEXP session);
+RcppExport SEXP _iglm_xyz_session_snapshot(SEXP sessionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type session(sessionSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_session_snapshot(session));
     return rcpp_result_gen;
 END_RCPP
 }
 // pl_estimation
-List pl_estimation(arma::vec coef, const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, int max_iteration, double tol, double offset_nonoverlap, bool non_stop, bool fix_x, bool fix_z, std::string attr_x_type, std::string attr_y_type, double attr_x_scale, double attr_y_scale, bool nonoverlap_random);
-RcppExport SEXP _iglm_pl_estimation(SEXP coefSEXP, SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP max_iterationSEXP, SEXP tolSEXP, SEXP offset_nonoverlapSEXP, SEXP non_stopSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP attr_x_typeSEXP, SEXP attr_y_typeSEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP) {
+List pl_estimation(arma::vec coef, const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, int max_iteration, double tol, double offset_nonoverlap, bool non_stop, bool fix_x, bool fix_z, std::string attr_x_type, std::string attr_y_type, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int n_threads, bool compress_design, double sample_fraction, int chunk_size, bool single_precision, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups);
+RcppExport SEXP _iglm_pl_estimation(SEXP coefSEXP, SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP max_iterationSEXP, SEXP tolSEXP, SEXP offset_nonoverlapSEXP, SEXP non_stopSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP attr_x_typeSEXP, SEXP attr_y_typeSEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP n_threadsSEXP, SEXP compress_designSEXP, SEXP sample_fractionSEXP, SEXP chunk_sizeSEXP, SEXP single_precisionSEXP, SEXP neighborhood_groupsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -113,7 +207,13 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type attr_x_scale(attr_x_scaleSEXP);
     Rcpp::traits::input_parameter< double >::type attr_y_scale(attr_y_scaleSEXP);
     Rcpp::traits::input_parameter< bool >::type nonoverlap_random(nonoverlap_randomSEXP);
-    rcpp_result_gen = Rcpp::wrap(pl_estimation(coef, z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, max_iteration, tol, offset_nonoverlap, non_stop, fix_x, fix_z, attr_x_type, attr_y_type, attr_x_scale, attr_y_scale, nonoverlap_random));
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type compress_design(compress_designSEXP);
+    Rcpp::traits::input_parameter< double >::type sample_fraction(sample_fractionSEXP);
+    Rcpp::traits::input_parameter< int >::type chunk_size(chunk_sizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type single_precision(single_precisionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    rcpp_result_gen = Rcpp::wrap(pl_estimation(coef, z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, max_iteration, tol, offset_nonoverlap, non_stop, fix_x, fix_z, attr_x_type, attr_y_type, attr_x_scale, attr_y_scale, nonoverlap_random, n_threads, compress_design, sample_fraction, chunk_size, single_precision, neighborhood_groups));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -142,8 +242,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // outerloop_estimation_pl
-List outerloop_estimation_pl(arma::vec coef, arma::vec coef_degrees, const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, int max_iteration_outer, int max_iteration_inner_degrees, int max_iteration_inner_nondegrees, double tol, double offset_nonoverlap, bool non_stop, bool var, bool accelerated, bool fix_x, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int start);
-RcppExport SEXP _iglm_outerloop_estimation_pl(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP max_iteration_outerSEXP, SEXP max_iteration_inner_degreesSEXP, SEXP max_iteration_inner_nondegreesSEXP, SEXP tolSEXP, SEXP offset_nonoverlapSEXP, SEXP non_stopSEXP, SEXP varSEXP, SEXP acceleratedSEXP, SEXP fix_xSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP startSEXP) {
+List outerloop_estimation_pl(arma::vec coef, arma::vec coef_degrees, const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, int max_iteration_outer, int max_iteration_inner_degrees, int max_iteration_inner_nondegrees, double tol, double offset_nonoverlap, bool non_stop, bool var, bool accelerated, bool fix_x, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, int start, int n_threads, double sample_fraction, bool exact, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups);
+RcppExport SEXP _iglm_outerloop_estimation_pl(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP max_iteration_outerSEXP, SEXP max_iteration_inner_degreesSEXP, SEXP max_iteration_inner_nondegreesSEXP, SEXP tolSEXP, SEXP offset_nonoverlapSEXP, SEXP non_stopSEXP, SEXP varSEXP, SEXP acceleratedSEXP, SEXP fix_xSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP startSEXP, SEXP n_threadsSEXP, SEXP sample_fractionSEXP, SEXP exactSEXP, SEXP neighborhood_groupsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -174,13 +274,17 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type attr_y_scale(attr_y_scaleSEXP);
     Rcpp::traits::input_parameter< bool >::type nonoverlap_random(nonoverlap_randomSEXP);
     Rcpp::traits::input_parameter< int >::type start(startSEXP);
-    rcpp_result_gen = Rcpp::wrap(outerloop_estimation_pl(coef, coef_degrees, z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, max_iteration_outer, max_iteration_inner_degrees, max_iteration_inner_nondegrees, tol, offset_nonoverlap, non_stop, var, accelerated, fix_x, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, start));
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type sample_fraction(sample_fractionSEXP);
+    Rcpp::traits::input_parameter< bool >::type exact(exactSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    rcpp_result_gen = Rcpp::wrap(outerloop_estimation_pl(coef, coef_degrees, z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, max_iteration_outer, max_iteration_inner_degrees, max_iteration_inner_nondegrees, tol, offset_nonoverlap, non_stop, var, accelerated, fix_x, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, start, n_threads, sample_fraction, exact, neighborhood_groups));
     return rcpp_result_gen;
 END_RCPP
 }
 // xyz_approximate_variability
-List xyz_approximate_variability(arma::vec& coef, arma::vec& coef_degrees, std::vector<std::string>& terms, int& n_actor, arma::mat z_network, arma::mat neighborhood, arma::mat overlap, arma::vec y_attribute, arma::vec x_attribute, bool init_empty, bool directed, std::vector<arma::mat>& data_list, std::vector<double>& type_list, int n_proposals_x, int n_proposals_y, int n_proposals_z, int seed, int n_burn_in, int n_simulation, bool display_progress, bool degrees, double offset_nonoverlap, bool return_samples, bool fix_x, bool fix_z, bool updated_uncertainty, bool exact, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, bool tnt);
-RcppExport SEXP _iglm_xyz_approximate_variability(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP z_networkSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP y_attributeSEXP, SEXP x_attributeSEXP, SEXP init_emptySEXP, SEXP directedSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP n_proposals_xSEXP, SEXP n_proposals_ySEXP, SEXP n_proposals_zSEXP, SEXP seedSEXP, SEXP n_burn_inSEXP, SEXP n_simulationSEXP, SEXP display_progressSEXP, SEXP degreesSEXP, SEXP offset_nonoverlapSEXP, SEXP return_samplesSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP updated_uncertaintySEXP, SEXP exactSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP tntSEXP) {
+List xyz_approximate_variability(arma::vec& coef, arma::vec& coef_degrees, std::vector<std::string>& terms, int& n_actor, arma::mat z_network, arma::mat neighborhood, arma::mat overlap, arma::vec y_attribute, arma::vec x_attribute, bool init_empty, bool directed, std::vector<arma::mat>& data_list, std::vector<double>& type_list, int n_proposals_x, int n_proposals_y, int n_proposals_z, int seed, int n_burn_in, int n_simulation, bool display_progress, bool degrees, double offset_nonoverlap, bool return_samples, bool fix_x, bool fix_z, bool updated_uncertainty, bool exact, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool nonoverlap_random, bool tnt, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups, bool native_rng, int stream);
+RcppExport SEXP _iglm_xyz_approximate_variability(SEXP coefSEXP, SEXP coef_degreesSEXP, SEXP termsSEXP, SEXP n_actorSEXP, SEXP z_networkSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP y_attributeSEXP, SEXP x_attributeSEXP, SEXP init_emptySEXP, SEXP directedSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP n_proposals_xSEXP, SEXP n_proposals_ySEXP, SEXP n_proposals_zSEXP, SEXP seedSEXP, SEXP n_burn_inSEXP, SEXP n_simulationSEXP, SEXP display_progressSEXP, SEXP degreesSEXP, SEXP offset_nonoverlapSEXP, SEXP return_samplesSEXP, SEXP fix_xSEXP, SEXP fix_zSEXP, SEXP updated_uncertaintySEXP, SEXP exactSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP nonoverlap_randomSEXP, SEXP tntSEXP, SEXP neighborhood_groupsSEXP, SEXP native_rngSEXP, SEXP streamSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -217,13 +321,16 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type attr_y_scale(attr_y_scaleSEXP);
     Rcpp::traits::input_parameter< bool >::type nonoverlap_random(nonoverlap_randomSEXP);
     Rcpp::traits::input_parameter< bool >::type tnt(tntSEXP);
-    rcpp_result_gen = Rcpp::wrap(xyz_approximate_variability(coef, coef_degrees, terms, n_actor, z_network, neighborhood, overlap, y_attribute, x_attribute, init_empty, directed, data_list, type_list, n_proposals_x, n_proposals_y, n_proposals_z, seed, n_burn_in, n_simulation, display_progress, degrees, offset_nonoverlap, return_samples, fix_x, fix_z, updated_uncertainty, exact, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, tnt));
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    Rcpp::traits::input_parameter< bool >::type native_rng(native_rngSEXP);
+    Rcpp::traits::input_parameter< int >::type stream(streamSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_approximate_variability(coef, coef_degrees, terms, n_actor, z_network, neighborhood, overlap, y_attribute, x_attribute, init_empty, directed, data_list, type_list, n_proposals_x, n_proposals_y, n_proposals_z, seed, n_burn_in, n_simulation, display_progress, degrees, offset_nonoverlap, return_samples, fix_x, fix_z, updated_uncertainty, exact, type_x, type_y, attr_x_scale, attr_y_scale, nonoverlap_random, tnt, neighborhood_groups, native_rng, stream));
     return rcpp_result_gen;
 END_RCPP
 }
 // xyz_prepare_pseudo_estimation
-Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool return_x, bool return_y, bool return_z);
-RcppExport SEXP _iglm_xyz_prepare_pseudo_estimation(SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP return_xSEXP, SEXP return_ySEXP, SEXP return_zSEXP) {
+Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network, const arma::vec& x_attribute, const arma::vec& y_attribute, const arma::mat& neighborhood, const arma::mat& overlap, bool directed, std::vector<std::string> terms, std::vector<arma::mat>& data_list, std::vector<double>& type_list, bool display_progress, std::string type_x, std::string type_y, double attr_x_scale, double attr_y_scale, bool return_x, bool return_y, bool return_z, int n_threads, Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups);
+RcppExport SEXP _iglm_xyz_prepare_pseudo_estimation(SEXP z_networkSEXP, SEXP x_attributeSEXP, SEXP y_attributeSEXP, SEXP neighborhoodSEXP, SEXP overlapSEXP, SEXP directedSEXP, SEXP termsSEXP, SEXP data_listSEXP, SEXP type_listSEXP, SEXP display_progressSEXP, SEXP type_xSEXP, SEXP type_ySEXP, SEXP attr_x_scaleSEXP, SEXP attr_y_scaleSEXP, SEXP return_xSEXP, SEXP return_ySEXP, SEXP return_zSEXP, SEXP n_threadsSEXP, SEXP neighborhood_groupsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -244,21 +351,41 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type return_x(return_xSEXP);
     Rcpp::traits::input_parameter< bool >::type return_y(return_ySEXP);
     Rcpp::traits::input_parameter< bool >::type return_z(return_zSEXP);
-    rcpp_result_gen = Rcpp::wrap(xyz_prepare_pseudo_estimation(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, type_x, type_y, attr_x_scale, attr_y_scale, return_x, return_y, return_z));
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericMatrix> >::type neighborhood_groups(neighborhood_groupsSEXP);
+    rcpp_result_gen = Rcpp::wrap(xyz_prepare_pseudo_estimation(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms, data_list, type_list, display_progress, type_x, type_y, attr_x_scale, attr_y_scale, return_x, return_y, return_z, n_threads, neighborhood_groups));
+    return rcpp_result_gen;
+END_RCPP
+}
+// iglm_internal_test
+SEXP iglm_internal_test(std::string name, Rcpp::List args);
+RcppExport SEXP _iglm_iglm_internal_test(SEXP nameSEXP, SEXP argsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type args(argsSEXP);
+    rcpp_result_gen = Rcpp::wrap(iglm_internal_test(name, args));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
     {"_iglm_iglm_print_registered_functions", (DL_FUNC) &_iglm_iglm_print_registered_functions, 0},
-    {"_iglm_xyz_count_global", (DL_FUNC) &_iglm_xyz_count_global, 14},
-    {"_iglm_xyz_simulate_cpp", (DL_FUNC) &_iglm_xyz_simulate_cpp, 31},
-    {"_iglm_pl_estimation", (DL_FUNC) &_iglm_pl_estimation, 22},
+    {"_iglm_xyz_count_global", (DL_FUNC) &_iglm_xyz_count_global, 15},
+    {"_iglm_xyz_simulate_cpp", (DL_FUNC) &_iglm_xyz_simulate_cpp, 35},
+    {"_iglm_xyz_session_create", (DL_FUNC) &_iglm_xyz_session_create, 30},
+    {"_iglm_xyz_session_run", (DL_FUNC) &_iglm_xyz_session_run, 5},
+    {"_iglm_xyz_session_set_coef", (DL_FUNC) &_iglm_xyz_session_set_coef, 3},
+    {"_iglm_xyz_session_get_state", (DL_FUNC) &_iglm_xyz_session_get_state, 1},
+    {"_iglm_xyz_session_snapshot", (DL_FUNC) &_iglm_xyz_session_snapshot, 1},
+    {"_iglm_pl_estimation", (DL_FUNC) &_iglm_pl_estimation, 28},
     {"_iglm_invert_mat", (DL_FUNC) &_iglm_invert_mat, 3},
     {"_iglm_get_A_inv", (DL_FUNC) &_iglm_get_A_inv, 1},
-    {"_iglm_outerloop_estimation_pl", (DL_FUNC) &_iglm_outerloop_estimation_pl, 27},
-    {"_iglm_xyz_approximate_variability", (DL_FUNC) &_iglm_xyz_approximate_variability, 33},
-    {"_iglm_xyz_prepare_pseudo_estimation", (DL_FUNC) &_iglm_xyz_prepare_pseudo_estimation, 17},
+    {"_iglm_outerloop_estimation_pl", (DL_FUNC) &_iglm_outerloop_estimation_pl, 31},
+    {"_iglm_xyz_approximate_variability", (DL_FUNC) &_iglm_xyz_approximate_variability, 36},
+    {"_iglm_xyz_prepare_pseudo_estimation", (DL_FUNC) &_iglm_xyz_prepare_pseudo_estimation, 19},
+    {"_iglm_iglm_internal_test", (DL_FUNC) &_iglm_iglm_internal_test, 2},
     {NULL, NULL, 0}
 };
 
@@ -9,6 +9,9 @@
 // The KEY MACRO: Define the signature wrapper (the lambda capture list is empty)
 #define CHANGESTAT [](const XYZ_class &object,const int &unit_i,const int &unit_j, const arma::mat &data,const double &type,const std::string &mode,const bool &is_full_neighborhood) -> double
 
+// Batched counterpart of CHANGESTAT (see iglm::BatchExtFn), evaluating n pairs at once
+#define CHANGESTAT_BATCH [](const XYZ_class &object,const int *units_i,const int *units_j,const size_t &n, const arma::mat &data,const double &type,const std::string &mode,const bool &is_full_neighborhood, double *out) -> void
+
 
 // Alias for a function pointer used to calculate a validation metric or score.
 // This signature defines a **mapping** from a complex state space (captured by the seven
@@ -34,7 +37,7 @@ auto xyz_stat_repetition = CHANGESTAT{
     return(0);
   }  
 }; 
-EFFECT_REGISTER("mutual_global", ::xyz_stat_repetition, "mutual_global", 0);
+EFFECT_REGISTER_MODES("mutual_global", ::xyz_stat_repetition, "mutual_global", 0, ::iglm::MODE_Z);
 
 auto xyz_stat_edges= CHANGESTAT{
   
@@ -43,8 +46,11 @@ auto xyz_stat_edges= CHANGESTAT{
   else
     return 0.0;
 }; 
+auto xyz_stat_edges_batch = CHANGESTAT_BATCH{
+  std::fill(out, out + n, mode == "z" ? 1.0 : 0.0);
+};
 // Register: name, function pointer, short name, double
-EFFECT_REGISTER("edges_global", ::xyz_stat_edges, "edges_global", 0);
+EFFECT_REGISTER_BATCH("edges_global", ::xyz_stat_edges, ::xyz_stat_edges_batch, "edges_global", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_repetition_nonb= CHANGESTAT{
   if(!object.z_network.directed){
@@ -57,7 +63,7 @@ auto xyz_stat_repetition_nonb= CHANGESTAT{
     return(0);
   }  
 };
-EFFECT_REGISTER("mutual_alocal", ::xyz_stat_repetition_nonb, "mutual_alocal", 0);
+EFFECT_REGISTER_MODES("mutual_alocal", ::xyz_stat_repetition_nonb, "mutual_alocal", 0, ::iglm::MODE_Z);
 auto xyz_stat_repetition_nb= CHANGESTAT{
   if(mode == "z"){
     return(object.z_network.get_val(unit_j, unit_i)*object.get_val_overlap(unit_i,unit_j));
@@ -66,7 +72,7 @@ auto xyz_stat_repetition_nb= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("mutual_local", ::xyz_stat_repetition_nb, "mutual_local", 0);
+EFFECT_REGISTER_MODES("mutual_local", ::xyz_stat_repetition_nb, "mutual_local", 0, ::iglm::MODE_Z);
 
 
 auto xyz_stat_cov_z_out_nb= CHANGESTAT{
@@ -76,7 +82,7 @@ auto xyz_stat_cov_z_out_nb= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("cov_z_out_local", ::xyz_stat_cov_z_out_nb, "cov_z_out_local", 0);
+EFFECT_REGISTER_MODES("cov_z_out_local", ::xyz_stat_cov_z_out_nb, "cov_z_out_local", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_cov_z_in_nb= CHANGESTAT{
@@ -86,7 +92,7 @@ auto xyz_stat_cov_z_in_nb= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("cov_z_in_local", ::xyz_stat_cov_z_in_nb, "cov_z_in_local", 0);
+EFFECT_REGISTER_MODES("cov_z_in_local", ::xyz_stat_cov_z_in_nb, "cov_z_in_local", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 
@@ -97,7 +103,7 @@ auto xyz_stat_cov_z_out_nonb= CHANGESTAT{
     return(0);
   }  
 };
-EFFECT_REGISTER("cov_z_out_alocal", ::xyz_stat_cov_z_out_nonb, "cov_z_out_alocal", 0);
+EFFECT_REGISTER_MODES("cov_z_out_alocal", ::xyz_stat_cov_z_out_nonb, "cov_z_out_alocal", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_cov_z_in_nonb= CHANGESTAT{
   if(mode == "z"){ 
@@ -106,7 +112,7 @@ auto xyz_stat_cov_z_in_nonb= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("cov_z_in_alocal", ::xyz_stat_cov_z_in_nonb, "cov_z_in_alocal", 0);
+EFFECT_REGISTER_MODES("cov_z_in_alocal", ::xyz_stat_cov_z_in_nonb, "cov_z_in_alocal", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_cov_z_out= CHANGESTAT{
   if(mode == "z"){ 
@@ -115,7 +121,7 @@ auto xyz_stat_cov_z_out= CHANGESTAT{
     return(0);
   }  
 };
-EFFECT_REGISTER("cov_z_out_global", ::xyz_stat_cov_z_out, "cov_z_out_global", 0);
+EFFECT_REGISTER_MODES("cov_z_out_global", ::xyz_stat_cov_z_out, "cov_z_out_global", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_cov_z_in= CHANGESTAT{
   if(mode == "z"){ 
@@ -124,7 +130,7 @@ auto xyz_stat_cov_z_in= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("cov_z_in_global", ::xyz_stat_cov_z_in, "cov_z_in_global", 0);
+EFFECT_REGISTER_MODES("cov_z_in_global", ::xyz_stat_cov_z_in, "cov_z_in_global", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_cov_z_nb= CHANGESTAT{
@@ -140,7 +146,7 @@ auto xyz_stat_cov_z_nb= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("cov_z_local", ::xyz_stat_cov_z_nb, "cov_z_local", 0);
+EFFECT_REGISTER_MODES("cov_z_local", ::xyz_stat_cov_z_nb, "cov_z_local", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_cov_z_nonb= CHANGESTAT{
@@ -156,7 +162,7 @@ auto xyz_stat_cov_z_nonb= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("cov_z_alocal", ::xyz_stat_cov_z_nonb, "cov_z_alocal", 0);
+EFFECT_REGISTER_MODES("cov_z_alocal", ::xyz_stat_cov_z_nonb, "cov_z_alocal", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_cov_z= CHANGESTAT{
   if(mode == "z"){
@@ -166,7 +172,16 @@ auto xyz_stat_cov_z= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("cov_z_global", ::xyz_stat_cov_z, "cov_z_global", 0);
+auto xyz_stat_cov_z_batch = CHANGESTAT_BATCH{
+  if(mode != "z"){
+    std::fill(out, out + n, 0.0);
+    return;
+  }
+  for(size_t d = 0; d < n; d++){
+    out[d] = data.at(units_i[d]-1, units_j[d]-1);
+  }
+};
+EFFECT_REGISTER_BATCH("cov_z_global", ::xyz_stat_cov_z, ::xyz_stat_cov_z_batch, "cov_z_global", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_cov_x= CHANGESTAT{
@@ -177,7 +192,7 @@ auto xyz_stat_cov_x= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("cov_x", ::xyz_stat_cov_x, "cov_x", 0);
+EFFECT_REGISTER_MODES("cov_x", ::xyz_stat_cov_x, "cov_x", 0, ::iglm::MODE_X | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_cov_y= CHANGESTAT{
   if(mode == "y"){
@@ -187,7 +202,7 @@ auto xyz_stat_cov_y= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("cov_y", ::xyz_stat_cov_y, "cov_y", 0);
+EFFECT_REGISTER_MODES("cov_y", ::xyz_stat_cov_y, "cov_y", 0, ::iglm::MODE_Y | ::iglm::DYAD_INDEPENDENT);
 
 
 
@@ -229,7 +244,7 @@ auto xyz_stat_edges_nonb= CHANGESTAT{
     return(0);
   } 
 };
-EFFECT_REGISTER("edges_alocal", ::xyz_stat_edges_nonb, "edges_alocal", 0);
+EFFECT_REGISTER_MODES("edges_alocal", ::xyz_stat_edges_nonb, "edges_alocal", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_edges_nb= CHANGESTAT{
@@ -259,19 +274,19 @@ auto xyz_stat_edges_nb= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("edges_local", ::xyz_stat_edges_nb, "edges_local", 0);
+EFFECT_REGISTER_MODES("edges_local", ::xyz_stat_edges_nb, "edges_local", 0, ::iglm::MODE_Z | ::iglm::DYAD_INDEPENDENT);
 
 
 auto xyz_stat_attribute_xy_nb= CHANGESTAT{
   if(mode == "y"){
     double res = 0.0;
-    for (auto k = object.overlap.at(unit_i).begin(); k != object.overlap.at(unit_i).end(); k++) {
+    for (auto k = object.topology().overlap.at(unit_i).begin(); k != object.topology().overlap.at(unit_i).end(); k++) {
       res+= object.y_attribute.get_val(*k);
     }
     return(res);
   } else if(mode == "x"){
     double res = 0.0;
-    for (auto k = object.overlap.at(unit_i).begin(); k != object.overlap.at(unit_i).end(); k++) {
+    for (auto k = object.topology().overlap.at(unit_i).begin(); k != object.topology().overlap.at(unit_i).end(); k++) {
       res+= object.x_attribute.get_val(*k);
     }
     return(res);
@@ -285,7 +300,7 @@ auto xyz_stat_attribute_xy_nonb= CHANGESTAT{
   if(mode == "y"){
     
     std::vector<int> difference_result =
-      get_difference_vec(object.all_actors, object.overlap.at(unit_i));
+      get_difference_vec(object.topology().all_actors, object.topology().overlap.at(unit_i));
     
     
     double res = 0.0;
@@ -295,7 +310,7 @@ auto xyz_stat_attribute_xy_nonb= CHANGESTAT{
     return(res);
   } else if(mode == "x"){ 
     std::vector<int> difference_result = 
-      get_difference_vec(object.all_actors, object.overlap.at(unit_i));
+      get_difference_vec(object.topology().all_actors, object.topology().overlap.at(unit_i));
     double res = 0.0;
     for (int k : difference_result) {
       res+= object.x_attribute.get_val(k);
@@ -537,7 +552,7 @@ auto xyz_stat_edges_x_out_nonb= CHANGESTAT{
     // If there is no full neighborhood we need to cut the connections of i to only include other actors within the same neighborhood
     if(!is_full_neighborhood){
       // Next we only want to get the connections within the same group
-      connections_of_i = get_difference_vec(connections_of_i_all, object.overlap.at(unit_i));
+      connections_of_i = get_difference_vec(connections_of_i_all, object.topology().overlap.at(unit_i));
     } else {    
       connections_of_i = connections_of_i_all;
     }     
@@ -592,7 +607,7 @@ auto xyz_stat_edges_x_in_nonb= CHANGESTAT{
     // If there is no full neighborhood we need to cut the connections of i to only include other actors within the same neighborhood
     if(!is_full_neighborhood){
       // Next we only want to get the connections within the same group
-      connections_of_i = get_difference_vec(connections_of_i_all, object.overlap.at(unit_i));
+      connections_of_i = get_difference_vec(connections_of_i_all, object.topology().overlap.at(unit_i));
     } else {   
       return(0.0);
     }   
@@ -640,7 +655,7 @@ auto xyz_stat_edges_y_out_nonb= CHANGESTAT{
     // If there is no full neighborhood we need to cut the connections of i to only include other actors within the same neighborhood
     if(!is_full_neighborhood){
       // Next we only want to get the connections within the same group
-      connections_of_i = get_difference_vec(connections_of_i_all, object.overlap.at(unit_i));
+      connections_of_i = get_difference_vec(connections_of_i_all, object.topology().overlap.at(unit_i));
       return(0.0);
     }   
     return(connections_of_i.size());
@@ -695,7 +710,7 @@ auto xyz_stat_edges_y_in_nonb= CHANGESTAT{
     // If there is no full neighborhood we need to cut the connections of i to only include other actors within the same neighborhood
     if(!is_full_neighborhood){
       // Next we only want to get the connections within the same group
-      connections_of_i = get_difference_vec(connections_of_i_all, object.overlap.at(unit_i));
+      connections_of_i = get_difference_vec(connections_of_i_all, object.topology().overlap.at(unit_i));
     } else {    
       return(0.0);
     }    
@@ -731,7 +746,7 @@ auto xyz_stat_attribute_x= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("attribute_x", ::xyz_stat_attribute_x, "attribute_x", 0);
+EFFECT_REGISTER_MODES("attribute_x", ::xyz_stat_attribute_x, "attribute_x", 0, ::iglm::MODE_X | ::iglm::DYAD_INDEPENDENT);
 
 auto xyz_stat_attribute_y= CHANGESTAT{
   if(mode == "y"){
@@ -740,7 +755,7 @@ auto xyz_stat_attribute_y= CHANGESTAT{
     return(0);
   }
 };
-EFFECT_REGISTER("attribute_y", ::xyz_stat_attribute_y, "attribute_y", 0);
+EFFECT_REGISTER_MODES("attribute_y", ::xyz_stat_attribute_y, "attribute_y", 0, ::iglm::MODE_Y | ::iglm::DYAD_INDEPENDENT);
 
 
 // cov_i *cov_j * z_ij*c_ij
@@ -796,26 +811,11 @@ auto xyz_stat_interaction_edges_xy= CHANGESTAT{
     } else if (mode == "x"){
       // What to do if the attribute change stat is wanted
       // x_i from 0 -> 1
-      auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-      for (int k : connections_of_i) {
-        if(k != unit_i){
-          res+= object.y_attribute.get_val(k);
-        } else {
-          Rcout << "Here" << std::endl;
-        }
-      } 
+      res = object.neighbour_sum_y(unit_i, true, true);
     } else{
       // What to do if the attribute change stat is wanted
       // y_i from 0 -> 1
-      auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-      
-      for (int k : connections_of_i) {
-        if(k != unit_i){
-        res+= object.x_attribute.get_val(k);  
-        } else {
-          Rcout << "Here" << std::endl;
-        }
-      }
+      res = object.neighbour_sum_x(unit_i, true, true);
     }
   } else {
     if(mode == "z"){
@@ -827,23 +827,11 @@ auto xyz_stat_interaction_edges_xy= CHANGESTAT{
     } else if (mode == "x"){ 
       // What to do if the attribute change stat is wanted
       // x_i from 0 -> 1
-      auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-      
-      for (int k : connections_of_i) {
-        if(k != unit_i){
-          res+= object.y_attribute.get_val(k);   
-        }
-      } 
+      res = object.neighbour_sum_y(unit_i, true, true);
     } else{ 
       // What to do if the attribute change stat is wanted
       // y_i from 0 -> 1
-      auto& connections_of_i =  object.adj_list_in_nb.at(unit_i);
-      
-      for (int k : connections_of_i) {
-        if(k != unit_i){
-          res+= object.x_attribute.get_val(k);   
-        }
-      } 
+      res = object.neighbour_sum_x(unit_i, false, true);
     }
   }
   return(res);
@@ -904,34 +892,11 @@ auto xyz_stat_interaction_edges_yx= CHANGESTAT{
   } else if (mode == "x"){ 
     // What to do if the attribute change stat is wanted
     // x_i from 0 -> 1
-    double res = 0.0;
-    // Rcout << unit_i << std::endl;
-    // Rcout << object.adj_list_in_nb.size() << std::endl;
-    auto& connections_of_i =  object.adj_list_in_nb.at(unit_i);
-    
-    for (int k : connections_of_i) {
-      // Rcout << "Attribute of actor";
-      // Rcout << k << std::endl;
-      // Rcout << object.attribute.get_val(k) << std::endl;
-      // if(k != unit_j){
-      res+= object.y_attribute.get_val(k); 
-      // }
-    } 
-    // Rcout <<  res << std::endl;
-    return(res);
+    return(object.neighbour_sum_y(unit_i, false, true));
   } else{ 
     // What to do if the attribute change stat is wanted
     // y_i from 0 -> 1
-    double res = 0.0;
-    auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-    
-    for (int k : connections_of_i) {
-      // if(k != unit_j){
-      res+= object.x_attribute.get_val(k);   
-      // }
-    } 
-    // Rcout << res << std::endl;
-    return(res);
+    return(object.neighbour_sum_x(unit_i, true, true));
   }
 };
 EFFECT_REGISTER("spillover_yx", ::xyz_stat_interaction_edges_yx, "spillover_yx", 0);
@@ -961,18 +926,9 @@ auto xyz_stat_matching_edges_y= CHANGESTAT{
   } else if (mode == "y"){
     // What to do if the attribute change stat is wanted
     // y_i from 0 -> 1
-    double res = 0.0;
-    const auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-    // Rcpp::Rcout << connections_of_i.size() <<std::endl;
-    for (int k : connections_of_i) {
-      res+= object.y_attribute.get_val(k);
-    }
+    double res = object.neighbour_sum_y(unit_i, true, true);
     if(object.z_network.directed){
-      const auto& connections_in_of_i =  object.adj_list_in_nb.at(unit_i);
-      // Rcpp::Rcout << connections_in_of_i.size() <<std::endl;
-      for (int k : connections_in_of_i) {
-        res+= object.y_attribute.get_val(k);
-      }
+      res += object.neighbour_sum_y(unit_i, false, true);
     }
     return(res);
   } else {
@@ -989,18 +945,9 @@ auto xyz_stat_matching_edges_x= CHANGESTAT{
   } else if (mode == "x"){
     // What to do if the attribute change stat is wanted
     // x_i from 0 -> 1
-    double res = 0.0;
-    const auto& connections_of_i =  object.adj_list_nb.at(unit_i);
-    // Rcpp::Rcout << connections_of_i.size() <<std::endl;
-    for (int k : connections_of_i) {
-      res+= object.x_attribute.get_val(k);
-    } 
+    double res = object.neighbour_sum_x(unit_i, true, true);
     if(object.z_network.directed){
-      const auto& connections_in_of_i =  object.adj_list_in_nb.at(unit_i);
-      // Rcpp::Rcout << connections_in_of_i.size() <<std::endl;
-      for (int k : connections_in_of_i) {
-        res+= object.x_attribute.get_val(k);
-      }
+      res += object.neighbour_sum_x(unit_i, false, true);
     }
     return(res);
   } else {
@@ -1017,12 +964,9 @@ auto xyz_stat_spillover_yx_scaled_global = CHANGESTAT{
       
       double X_j = object.x_attribute.get_val(unit_j);
       
-      double current_sum_y = 0;
+      double current_sum_y = object.neighbour_sum_x(unit_i, true, false);
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum_y += object.x_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1054,13 +998,10 @@ auto xyz_stat_spillover_yx_scaled_global = CHANGESTAT{
       double X_j = object.x_attribute.get_val(unit_j); 
       
       if (Y_i != 0) {
-        double sum_x_neighbors_i = 0;
+        double sum_x_neighbors_i = object.neighbour_sum_x(unit_i, true, false);
         auto& neighbors_i = object.z_network.adj_list.at(unit_i);
         double deg_i = neighbors_i.size();
         
-        for (int l : neighbors_i) {
-          sum_x_neighbors_i += object.x_attribute.get_val(l);
-        } 
         
         double S_with, d_with, S_without, d_without;
         
@@ -1083,13 +1024,10 @@ auto xyz_stat_spillover_yx_scaled_global = CHANGESTAT{
       }
       
       if (Y_j != 0) {
-        double sum_x_neighbors_j = 0;
+        double sum_x_neighbors_j = object.neighbour_sum_x(unit_j, true, false);
         auto& neighbors_j = object.z_network.adj_list.at(unit_j);
         double deg_j = neighbors_j.size();
         
-        for (int l : neighbors_j) {
-          sum_x_neighbors_j += object.x_attribute.get_val(l);
-        }
         
         double S_with, d_with, S_without, d_without;
         
@@ -1143,19 +1081,13 @@ auto xyz_stat_spillover_yx_scaled_global = CHANGESTAT{
     
   } else if (mode == "y"){
     if(object.z_network.directed){
-      double S_i = 0;
+      double S_i = object.neighbour_sum_x(unit_i, true, false);
       double deg_i = object.z_network.out_degrees[unit_i];
-      for (int j : object.z_network.adj_list.at(unit_i)) {
-        S_i += object.x_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     } else{
-      double S_i = 0;
+      double S_i = object.neighbour_sum_x(unit_i, true, false);
       double deg_i = object.z_network.out_degrees[unit_i];
-      for (int j : object.z_network.adj_list.at(unit_i)) {
-        S_i += object.x_attribute.get_val(j);
-      } 
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     } 
@@ -1175,12 +1107,9 @@ auto xyz_stat_spillover_yx_scaled = CHANGESTAT{
       
       double X_j = object.x_attribute.get_val(unit_j);
       
-      double current_sum_x = 0;
+      double current_sum_x = object.neighbour_sum_x(unit_i, true, true);
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum_x += object.x_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1214,13 +1143,10 @@ auto xyz_stat_spillover_yx_scaled = CHANGESTAT{
       double X_j = object.x_attribute.get_val(unit_j); 
       
       if (Y_i != 0) {
-        double sum_x_neighbors_i = 0;
+        double sum_x_neighbors_i = object.neighbour_sum_x(unit_i, true, true);
         auto& neighbors_i = object.adj_list_nb.at(unit_i);
         double deg_i = neighbors_i.size();
         
-        for (int l : neighbors_i) {
-          sum_x_neighbors_i += object.x_attribute.get_val(l);
-        } 
         
         double S_with, d_with, S_without, d_without;
         
@@ -1243,13 +1169,10 @@ auto xyz_stat_spillover_yx_scaled = CHANGESTAT{
       }
       
       if (Y_j != 0) {
-        double sum_x_neighbors_j = 0;
+        double sum_x_neighbors_j = object.neighbour_sum_x(unit_j, true, true);
         auto& neighbors_j = object.adj_list_nb.at(unit_j);
         double deg_j = neighbors_j.size();
         
-        for (int l : neighbors_j) {
-          sum_x_neighbors_j += object.x_attribute.get_val(l);
-        }
         
         double S_with, d_with, S_without, d_without;
         
@@ -1306,20 +1229,14 @@ auto xyz_stat_spillover_yx_scaled = CHANGESTAT{
   } else if (mode == "y"){
     if(object.z_network.directed){
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_x(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.x_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     } else{
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_x(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.x_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     }
@@ -1340,12 +1257,9 @@ auto xyz_stat_spillover_xy_scaled = CHANGESTAT{
       
       double Y_j = object.y_attribute.get_val(unit_j);
       
-      double current_sum_y = 0;
+      double current_sum_y = object.neighbour_sum_y(unit_i, true, true);
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum_y += object.y_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1379,13 +1293,10 @@ auto xyz_stat_spillover_xy_scaled = CHANGESTAT{
       double Y_j = object.y_attribute.get_val(unit_j); 
       
       if (X_i != 0) {
-        double sum_y_neighbors_i = 0;
+        double sum_y_neighbors_i = object.neighbour_sum_y(unit_i, true, true);
         auto& neighbors_i = object.adj_list_nb.at(unit_i);
         double deg_i = neighbors_i.size();
         
-        for (int l : neighbors_i) {
-          sum_y_neighbors_i += object.y_attribute.get_val(l);
-        } 
         
         double S_with, d_with, S_without, d_without;
         
@@ -1408,13 +1319,10 @@ auto xyz_stat_spillover_xy_scaled = CHANGESTAT{
       }
       
       if (X_j != 0) {
-        double sum_y_neighbors_j = 0;
+        double sum_y_neighbors_j = object.neighbour_sum_y(unit_j, true, true);
         auto& neighbors_j = object.adj_list_nb.at(unit_j);
         double deg_j = neighbors_j.size();
         
-        for (int l : neighbors_j) {
-          sum_y_neighbors_j += object.y_attribute.get_val(l);
-        }
         
         double S_with, d_with, S_without, d_without;
         
@@ -1471,20 +1379,14 @@ auto xyz_stat_spillover_xy_scaled = CHANGESTAT{
   } else if (mode == "x"){
     if(object.z_network.directed){
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_y(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.y_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     } else{
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_y(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.y_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     }
@@ -1502,12 +1404,9 @@ auto xyz_stat_spillover_xy_scaled_global = CHANGESTAT{
       
       double Y_j = object.y_attribute.get_val(unit_j);
       
-      double current_sum_y = 0;
+      double current_sum_y = object.neighbour_sum_y(unit_i, true, false);
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum_y += object.y_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1539,13 +1438,10 @@ auto xyz_stat_spillover_xy_scaled_global = CHANGESTAT{
       double Y_j = object.y_attribute.get_val(unit_j); 
       
       if (X_i != 0) {
-        double sum_y_neighbors_i = 0;
+        double sum_y_neighbors_i = object.neighbour_sum_y(unit_i, true, false);
         auto& neighbors_i = object.z_network.adj_list.at(unit_i);
         double deg_i = neighbors_i.size();
         
-        for (int l : neighbors_i) {
-          sum_y_neighbors_i += object.y_attribute.get_val(l);
-        }  
         
         double S_with, d_with, S_without, d_without;
         
@@ -1568,13 +1464,10 @@ auto xyz_stat_spillover_xy_scaled_global = CHANGESTAT{
       }
       
       if (X_j != 0) {
-        double sum_y_neighbors_j = 0;
+        double sum_y_neighbors_j = object.neighbour_sum_y(unit_j, true, false);
         auto& neighbors_j = object.z_network.adj_list.at(unit_j);
         double deg_j = neighbors_j.size();
         
-        for (int l : neighbors_j) {
-          sum_y_neighbors_j += object.y_attribute.get_val(l);
-        }
         
         double S_with, d_with, S_without, d_without;
         
@@ -1629,20 +1522,14 @@ auto xyz_stat_spillover_xy_scaled_global = CHANGESTAT{
   } else if (mode == "x"){
     if(object.z_network.directed){
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_y(unit_i, true, false);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.y_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     } else{
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
-      double S_i = 0;
+      double S_i = object.neighbour_sum_y(unit_i, true, false);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        S_i += object.y_attribute.get_val(j);
-      }
       
       return (deg_i > 0.5) ? (S_i / deg_i) : 0.0;
     }
@@ -1663,12 +1550,9 @@ auto xyz_stat_spillover_yy_scaled = CHANGESTAT{
       if (Y_i == 0) return 0.0; 
       double Y_j = object.y_attribute.get_val(unit_j);
       
-      double current_sum = 0;
+      double current_sum = object.neighbour_sum_y(unit_i, true, true);
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum += object.y_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       
       if (tie_exists) {
@@ -1694,12 +1578,9 @@ auto xyz_stat_spillover_yy_scaled = CHANGESTAT{
       double Y_j = object.y_attribute.get_val(unit_j);
       
       if (Y_i != 0) {
-        double sum_i = 0;
+        double sum_i = object.neighbour_sum_y(unit_i, true, true);
         auto& neighbors_i = object.adj_list_nb.at(unit_i);
         double deg_i = neighbors_i.size();
-        for (int l : neighbors_i) {
-          sum_i += object.y_attribute.get_val(l);
-        }
         
         double S_with_i, d_with_i, S_without_i, d_without_i;
         // bool tie_exists = object.z_network.get_val(unit_i, unit_j);
@@ -1722,12 +1603,9 @@ auto xyz_stat_spillover_yy_scaled = CHANGESTAT{
       }
       
       if (Y_j != 0) { 
-        double sum_j = 0;
+        double sum_j = object.neighbour_sum_y(unit_j, true, true);
         auto& neighbors_j = object.adj_list_nb.at(unit_j);
         double deg_j = neighbors_j.size();
-        for (int l : neighbors_j) {
-          sum_j += object.y_attribute.get_val(l);
-        }  
         
         double S_with_j, d_with_j, S_without_j, d_without_j;
         // bool tie_exists = object.z_network.get_val(unit_i, unit_j); 
@@ -1759,11 +1637,8 @@ auto xyz_stat_spillover_yy_scaled = CHANGESTAT{
       double total_diff = 0;
       // Part A: i's own average
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double sum_i = 0; 
+      double sum_i = object.neighbour_sum_y(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        sum_i += object.y_attribute.get_val(j);
-      } 
       if (deg_i > 0.5) total_diff += (sum_i / deg_i);
       
       auto& in_neighbors = object.adj_list_in_nb.at(unit_i);
@@ -1802,12 +1677,9 @@ auto xyz_stat_spillover_yy_scaled_global = CHANGESTAT{
       if (Y_i == 0) return 0.0; 
       double Y_j = object.y_attribute.get_val(unit_j);
       
-      double current_sum = 0;
+      double current_sum = object.neighbour_sum_y(unit_i, true, false);
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum += object.y_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1833,12 +1705,9 @@ auto xyz_stat_spillover_yy_scaled_global = CHANGESTAT{
       double Y_j = object.y_attribute.get_val(unit_j);
       
       if (Y_i != 0) {
-        double sum_i = 0;
+        double sum_i = object.neighbour_sum_y(unit_i, true, false);
         auto& neighbors_i = object.z_network.adj_list.at(unit_i);
         double deg_i = neighbors_i.size();
-        for (int l : neighbors_i) {
-          sum_i += object.y_attribute.get_val(l);
-        }
         
         double S_with_i, d_with_i, S_without_i, d_without_i;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j);
@@ -1862,12 +1731,9 @@ auto xyz_stat_spillover_yy_scaled_global = CHANGESTAT{
       }
       
       if (Y_j != 0) { 
-        double sum_j = 0;
+        double sum_j = object.neighbour_sum_y(unit_j, true, false);
         auto& neighbors_j = object.z_network.adj_list.at(unit_j);
         double deg_j = neighbors_j.size();
-        for (int l : neighbors_j) {
-          sum_j += object.y_attribute.get_val(l);
-        } 
         
         double S_with_j, d_with_j, S_without_j, d_without_j;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j); 
@@ -1896,11 +1762,8 @@ auto xyz_stat_spillover_yy_scaled_global = CHANGESTAT{
       double total_diff = 0;
       // Part A: i's own average
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
-      double sum_i = 0; 
+      double sum_i = object.neighbour_sum_y(unit_i, true, false);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        sum_i += object.y_attribute.get_val(j);
-      } 
       if (deg_i > 0.5) total_diff += (sum_i / deg_i);
       
       auto& in_neighbors = object.z_network.adj_list_in.at(unit_i);
@@ -1941,12 +1804,9 @@ auto xyz_stat_spillover_xx_scaled = CHANGESTAT{
       if (X_i == 0) return 0.0; 
       double X_j = object.x_attribute.get_val(unit_j);
       
-      double current_sum = 0;
+      double current_sum = object.neighbour_sum_x(unit_i, true, true);
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum += object.x_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -1972,12 +1832,9 @@ auto xyz_stat_spillover_xx_scaled = CHANGESTAT{
       double X_j = object.x_attribute.get_val(unit_j);
       
       if (X_i != 0) {
-        double sum_i = 0;
+        double sum_i = object.neighbour_sum_x(unit_i, true, true);
         auto& neighbors_i = object.adj_list_nb.at(unit_i);
         double deg_i = neighbors_i.size();
-        for (int l : neighbors_i) {
-          sum_i += object.x_attribute.get_val(l);
-        }
         
         double S_with_i, d_with_i, S_without_i, d_without_i;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j);
@@ -2001,12 +1858,9 @@ auto xyz_stat_spillover_xx_scaled = CHANGESTAT{
       }
       
       if (X_j != 0) { 
-        double sum_j = 0;
+        double sum_j = object.neighbour_sum_x(unit_j, true, true);
         auto& neighbors_j = object.adj_list_nb.at(unit_j);
         double deg_j = neighbors_j.size();
-        for (int l : neighbors_j) {
-          sum_j += object.x_attribute.get_val(l);
-        } 
         
         double S_with_j, d_with_j, S_without_j, d_without_j;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j); 
@@ -2036,11 +1890,8 @@ auto xyz_stat_spillover_xx_scaled = CHANGESTAT{
       double total_diff = 0;
       // Part A: i's own average
       auto& out_neighbors = object.adj_list_nb.at(unit_i);
-      double sum_i = 0; 
+      double sum_i = object.neighbour_sum_x(unit_i, true, true);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        sum_i += object.x_attribute.get_val(j);
-      } 
       if (deg_i > 0.5) total_diff += (sum_i / deg_i);
       
       auto& in_neighbors = object.adj_list_in_nb.at(unit_i);
@@ -2079,12 +1930,9 @@ auto xyz_stat_spillover_xx_scaled_global = CHANGESTAT{
       if (X_i == 0) return 0.0; 
       double X_j = object.x_attribute.get_val(unit_j);
       
-      double current_sum = 0;
+      double current_sum = object.neighbour_sum_x(unit_i, true, false);
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
       double current_deg = out_neighbors.size();
-      for (int l : out_neighbors) {
-        current_sum += object.x_attribute.get_val(l);
-      }
       double S_with, d_with, S_without, d_without;
       bool tie_exists = object.z_network.get_val(unit_i, unit_j);
       
@@ -2110,12 +1958,9 @@ auto xyz_stat_spillover_xx_scaled_global = CHANGESTAT{
       double X_j = object.x_attribute.get_val(unit_j);
       
       if (X_i != 0) {
-        double sum_i = 0;
+        double sum_i = object.neighbour_sum_x(unit_i, true, false);
         auto& neighbors_i = object.z_network.adj_list.at(unit_i);
         double deg_i = neighbors_i.size();
-        for (int l : neighbors_i) {
-          sum_i += object.x_attribute.get_val(l);
-        }
         
         double S_with_i, d_with_i, S_without_i, d_without_i;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j);
@@ -2139,12 +1984,9 @@ auto xyz_stat_spillover_xx_scaled_global = CHANGESTAT{
       }
       
       if (X_j != 0) { 
-        double sum_j = 0;
+        double sum_j = object.neighbour_sum_x(unit_j, true, false);
         auto& neighbors_j = object.z_network.adj_list.at(unit_j);
         double deg_j = neighbors_j.size();
-        for (int l : neighbors_j) {
-          sum_j += object.x_attribute.get_val(l);
-        } 
         
         double S_with_j, d_with_j, S_without_j, d_without_j;
         bool tie_exists = object.z_network.get_val(unit_i, unit_j); 
@@ -2174,11 +2016,8 @@ auto xyz_stat_spillover_xx_scaled_global = CHANGESTAT{
       double total_diff = 0;
       // Part A: i's own average
       auto& out_neighbors = object.z_network.adj_list.at(unit_i);
-      double sum_i = 0; 
+      double sum_i = object.neighbour_sum_x(unit_i, true, false);
       double deg_i = out_neighbors.size();
-      for (int j : out_neighbors) {
-        sum_i += object.x_attribute.get_val(j);
-      } 
       if (deg_i > 0.5) total_diff += (sum_i / deg_i);
       
       auto& in_neighbors = object.z_network.adj_list_in.at(unit_i);
@@ -2208,176 +2047,98 @@ auto xyz_stat_spillover_xx_scaled_global = CHANGESTAT{
 };
 EFFECT_REGISTER("spillover_xx_scaled_global", ::xyz_stat_spillover_xx_scaled_global, "spillover_xx_scaled_global", 0);
 
-static inline bool has_alternative_h_to_j(
-    int h, int excluded, int j,
-    const XYZ_class &object,
-    const std::vector<int> &in_connections_of_j_nb,
-    const std::vector<int> &neighborhood_h,
-    const std::vector<int> &neighborhood_j
-) {
-  if (h >= object.z_network.adj_list.size()) return false;
-  const auto &out_h = object.z_network.adj_list.at(h);
-  
-  for (int k : out_h) {
-    if (k == excluded) continue;
-    if (std::find(neighborhood_h.begin(), neighborhood_h.end(), k) != neighborhood_h.end() &&
-        std::find(neighborhood_j.begin(), neighborhood_j.end(), k) != neighborhood_j.end() &&
-        std::find(in_connections_of_j_nb.begin(), in_connections_of_j_nb.end(), k) != in_connections_of_j_nb.end()) {
-      return true;
-    }
-  }
-  return false;
-}
-
-static inline bool has_alternative_i_to_h(
-    int i, int excluded, int h,
-    const XYZ_class &object,
-    const std::vector<int> &out_connections_of_i_nb,
-    const std::vector<int> &neighborhood_h,
-    const std::vector<int> &neighborhood_i
-) {
-  if (h >= object.z_network.adj_list_in.size()) return false;
-  const auto &in_h = object.z_network.adj_list_in.at(h);
-  
-  for (int k : in_h) {
+// Whether there is a path from -> k -> to with k != excluded and k in the
+// neighbourhoods of both from and to. The shorter of out(from) and in(to) is
+// scanned, the other side is probed in O(1).
+static inline bool has_transitive_path(int from, int to, int excluded, const XYZ_class &object) {
+  const Network &net = object.z_network;
+  const auto &out_from = net.adj_list.at(from);
+  const auto &in_to = net.directed ? net.adj_list_in.at(to) : net.adj_list.at(to);
+  bool scan_out = out_from.size() <= in_to.size();
+  for (int k : scan_out ? out_from : in_to) {
     if (k == excluded) continue;
-    if (std::find(neighborhood_h.begin(), neighborhood_h.end(), k) != neighborhood_h.end() &&
-        std::find(neighborhood_i.begin(), neighborhood_i.end(), k) != neighborhood_i.end() &&
-        std::find(out_connections_of_i_nb.begin(), out_connections_of_i_nb.end(), k) != out_connections_of_i_nb.end()) {
-      return true;
-    }
+    if (!(scan_out ? net.has_edge(k, to) : net.has_edge(from, k))) continue;
+    if (object.get_val_neighborhood(from, k) && object.get_val_neighborhood(to, k)) return true;
   }
   return false;
 }
 
-
 auto xyz_stat_transitive_edges = CHANGESTAT {
   if (mode != "z") return 0.0;
-  if (object.z_network.directed && 
-     (unit_i >= object.z_network.adj_list_in.size() || 
-      unit_j >= object.z_network.adj_list_in.size()))
+  const Network &net = object.z_network;
+  if (net.directed && 
+     (unit_i >= net.adj_list_in.size() || 
+      unit_j >= net.adj_list_in.size()))
   {
     return 0.0;
   }
   
   double res = 0.0;
+  const auto &out_i = net.adj_list.at(unit_i);
+  const auto &out_j = net.adj_list.at(unit_j);
   
-  const auto &neighborhood_i = object.neighborhood.at(unit_i);
-  const auto &neighborhood_j = object.neighborhood.at(unit_j);
-  const auto &out_i_all = object.z_network.adj_list.at(unit_i);
-  const auto &out_j_all = object.z_network.adj_list.at(unit_j);
-  
-  if (object.z_network.directed) {
-    const auto &in_i_all = object.z_network.adj_list_in.at(unit_i);
-    const auto &in_j_all = object.z_network.adj_list_in.at(unit_j);
-    
-    std::vector<int> in_connections_of_j_nb;
-    in_connections_of_j_nb.reserve(in_j_all.size());
-    for (int n : in_j_all) if (std::find(neighborhood_j.begin(), neighborhood_j.end(), n) != neighborhood_j.end()) in_connections_of_j_nb.push_back(n);
-    
-    std::vector<int> out_connections_of_i_nb;
-    out_connections_of_i_nb.reserve(out_i_all.size());
-    for (int n : out_i_all) if (std::find(neighborhood_i.begin(), neighborhood_i.end(), n) != neighborhood_i.end()) out_connections_of_i_nb.push_back(n);
-    
-    int simple_transitivity_count = 0;
-    const auto *small_nb = (&neighborhood_i);
-    const auto *large_nb = (&neighborhood_j);
-    if (neighborhood_j.size() < neighborhood_i.size()) { small_nb = &neighborhood_j; large_nb = &neighborhood_i; }
-    for (int h : *small_nb) {
+  if (net.directed) {
+    const auto &in_i = net.adj_list_in.at(unit_i);
+    const auto &in_j = net.adj_list_in.at(unit_j);
+    
+    // 1. Step: (i, j) itself is transitive if i -> h -> j for some h in both neighbourhoods
+    bool scan_out = out_i.size() <= in_j.size();
+    for (int h : scan_out ? out_i : in_j) {
       if (h == unit_i || h == unit_j) continue;
-      if (std::find(large_nb->begin(), large_nb->end(), h) == large_nb->end()) continue; 
-      if (std::find(out_i_all.begin(), out_i_all.end(), h) != out_i_all.end() && std::find(in_j_all.begin(), in_j_all.end(), h) != in_j_all.end()) {
-        simple_transitivity_count = 1; 
+      if (!(scan_out ? net.has_edge(h, unit_j) : net.has_edge(unit_i, h))) continue;
+      if (object.get_val_neighborhood(unit_i, h) && object.get_val_neighborhood(unit_j, h)) {
+        res += 1;
         break;
       }
     }
-    if (simple_transitivity_count) res += 1;
     
-    bool check_cond_part2 = std::find(neighborhood_j.begin(), neighborhood_j.end(), unit_i) != neighborhood_j.end();
-    
-    if (check_cond_part2) {
-      const auto *small_in = &in_i_all;
-      const auto *large_in = &in_j_all;
-      if (in_j_all.size() < in_i_all.size()) { small_in = &in_j_all; large_in = &in_i_all; }
-      
-      for (int h : *small_in) {
+    // 2. Step: edges (h, j) that only become transitive through h -> i -> j
+    if (object.get_val_neighborhood(unit_j, unit_i)) {
+      bool scan_i = in_i.size() <= in_j.size();
+      for (int h : scan_i ? in_i : in_j) {
         if (h == unit_i || h == unit_j) continue;
-        if (std::find(large_in->begin(), large_in->end(), h) == large_in->end()) continue;
-        if (std::find(object.neighborhood.at(h).begin(), object.neighborhood.at(h).end(), unit_i) == object.neighborhood.at(h).end()) continue;
-        
-        if (!has_alternative_h_to_j(h, unit_i, unit_j, object, in_connections_of_j_nb,
-                                    object.neighborhood.at(h), neighborhood_j)) {
-          res += 1;
-        }
+        if (!(scan_i ? net.has_edge(h, unit_j) : net.has_edge(h, unit_i))) continue;
+        if (!object.get_val_neighborhood(h, unit_i)) continue;
+        if (!has_transitive_path(h, unit_j, unit_i, object)) res += 1;
       }
     }
     
-    bool check_cond_part3 = std::find(neighborhood_i.begin(), neighborhood_i.end(), unit_j) != neighborhood_i.end();
-    
-    if (check_cond_part3) {
-      const auto *small_out = &out_i_all;
-      const auto *large_out = &out_j_all;
-      if (out_j_all.size() < out_i_all.size()) { small_out = &out_j_all; large_out = &out_i_all; }
-      
-      for (int h : *small_out) {
+    // 3. Step: edges (i, h) that only become transitive through i -> j -> h
+    if (object.get_val_neighborhood(unit_i, unit_j)) {
+      bool scan_i = out_i.size() <= out_j.size();
+      for (int h : scan_i ? out_i : out_j) {
         if (h == unit_i || h == unit_j) continue;
-        if (std::find(large_out->begin(), large_out->end(), h) == large_out->end()) continue;
-        if (std::find(object.neighborhood.at(h).begin(), object.neighborhood.at(h).end(), unit_j) == object.neighborhood.at(h).end()) continue;
-        
-        if (!has_alternative_i_to_h(unit_i, unit_j, h, object, out_connections_of_i_nb,
-                                    object.neighborhood.at(h), neighborhood_i)) {
-          res += 1;
-        }
+        if (!(scan_i ? net.has_edge(unit_j, h) : net.has_edge(unit_i, h))) continue;
+        if (!object.get_val_neighborhood(h, unit_j)) continue;
+        if (!has_transitive_path(unit_i, h, unit_j, object)) res += 1;
       }
     }
   }
   else { // undirected
-    const auto *small_conn = &out_i_all;
-    const auto *large_conn = &out_j_all;
-    if (out_j_all.size() < out_i_all.size()) { small_conn = &out_j_all; large_conn = &out_i_all; }
+    bool scan_i = out_i.size() <= out_j.size();
+    int other = scan_i ? unit_j : unit_i;
+    bool check_cond_part2 = object.get_val_neighborhood(unit_j, unit_i);
+    bool simple_triangle = false;
     
-    int simple_triangle_count = 0;
-    std::vector<int> common_neighbors;
-    common_neighbors.reserve(std::min(small_conn->size(), large_conn->size()));
-    
-    for (int h : *small_conn) {
+    for (int h : scan_i ? out_i : out_j) {
       if (h == unit_i || h == unit_j) continue;
-      if (std::find(large_conn->begin(), large_conn->end(), h) == large_conn->end()) continue;
-      common_neighbors.push_back(h);
-      if (std::find(neighborhood_i.begin(), neighborhood_i.end(), h) != neighborhood_i.end() && std::find(neighborhood_j.begin(), neighborhood_j.end(), h) != neighborhood_j.end()) {
-        simple_triangle_count = 1;
+      if (!net.has_edge(h, other)) continue;
+      // 1. Step: {i, j} itself closes a triangle within both neighbourhoods
+      if (!simple_triangle && object.get_val_neighborhood(unit_i, h) && object.get_val_neighborhood(unit_j, h)) {
+        simple_triangle = true;
       }
-    }
-    if (simple_triangle_count) res += 1;
-    bool check_cond_part2 = std::find(neighborhood_j.begin(), neighborhood_j.end(), unit_i) != neighborhood_j.end();
-    if (check_cond_part2 && !common_neighbors.empty()) {
-      std::vector<int> connections_of_i_nb;
-      connections_of_i_nb.reserve(out_i_all.size());
-      for (int n : out_i_all) if (std::find(neighborhood_i.begin(), neighborhood_i.end(), n) != neighborhood_i.end()) connections_of_i_nb.push_back(n);
-      std::vector<int> connections_of_j_nb;
-      connections_of_j_nb.reserve(out_j_all.size());
-      for (int n : out_j_all) if (std::find(neighborhood_j.begin(), neighborhood_j.end(), n) != neighborhood_j.end()) connections_of_j_nb.push_back(n);
-      
-      for (int h : common_neighbors) {
-        if (std::find(object.neighborhood.at(h).begin(), object.neighborhood.at(h).end(), unit_j) != object.neighborhood.at(h).end()) {
-          if (!has_alternative_h_to_j(h, unit_j, unit_i, object, connections_of_i_nb,
-                                      object.neighborhood.at(h), neighborhood_i)) {
-            res += 1;
-          }
-        }
-        if (std::find(object.neighborhood.at(h).begin(), object.neighborhood.at(h).end(), unit_i) != object.neighborhood.at(h).end()) {
-          if (!has_alternative_h_to_j(h, unit_i, unit_j, object, connections_of_j_nb,
-                                      object.neighborhood.at(h), neighborhood_j)) {
-            res += 1;
-          }
-        }
+      // 2. Step: edges {h, i} and {h, j} that only become transitive through {i, j}
+      if (check_cond_part2) {
+        if (object.get_val_neighborhood(h, unit_j) && !has_transitive_path(h, unit_i, unit_j, object)) res += 1;
+        if (object.get_val_neighborhood(h, unit_i) && !has_transitive_path(h, unit_j, unit_i, object)) res += 1;
       }
     }
+    if (simple_triangle) res += 1;
   } // end undirected
   
-  return static_cast<double>(res);
+  return res;
 };
-EFFECT_REGISTER("transitive", ::xyz_stat_transitive_edges, "transitive", 0);
+EFFECT_REGISTER_MODES("transitive", ::xyz_stat_transitive_edges, "transitive", 0, ::iglm::MODE_Z);
 
 auto xyz_stat_nonisolates= CHANGESTAT{
   if(mode == "z"){ 
@@ -2401,7 +2162,7 @@ auto xyz_stat_nonisolates= CHANGESTAT{
     return(0);
   }  
 };
-EFFECT_REGISTER("nonisolates", ::xyz_stat_nonisolates, "nonisolates", 0);
+EFFECT_REGISTER_MODES("nonisolates", ::xyz_stat_nonisolates, "nonisolates", 0, ::iglm::MODE_Z);
 
 auto xyz_stat_isolates= CHANGESTAT{
   if(mode == "z"){ 
@@ -2426,12 +2187,11 @@ auto xyz_stat_isolates= CHANGESTAT{
     return(0);
   }  
 };
-EFFECT_REGISTER("isolates", ::xyz_stat_isolates, "isolates", 1.0);
+EFFECT_REGISTER_MODES("isolates", ::xyz_stat_isolates, "isolates", 1.0, ::iglm::MODE_Z);
 
 auto xyz_stat_gwesp_local_ITP= CHANGESTAT{
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
@@ -2440,29 +2200,27 @@ auto xyz_stat_gwesp_local_ITP= CHANGESTAT{
     double tmp_count;
     
     // 1. Step: For all ISP of i and j 
-    std::vector<int> itp_ij = object.get_common_partners_nb(unit_i, unit_j, "ITP");
-    double res = expo_pos*(1- pow(expo_min, 
-                                  itp_ij.size()));
+    const std::vector<int>& itp_ij = object.shared_common_partners_nb<PartnerType::ITP>(unit_i, unit_j);
+    double res = gw.expo_pos*(1- gw(itp_ij.size()));
     // 2. Step: For all h in ITP of i and j check their ISP between j and h 
     
     
     for (int k : itp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_j, k, "ITP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
-      tmp_count = object.count_common_partners_nb(k,unit_i, "ITP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::ITP>(unit_j, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::ITP>(k, unit_i);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_local_ITP", ::xyz_stat_gwesp_local_ITP, "gwesp_local_ITP",0.0);
+EFFECT_REGISTER_MODES("gwesp_local_ITP", ::xyz_stat_gwesp_local_ITP, "gwesp_local_ITP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwesp_local_ISP= CHANGESTAT{
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
@@ -2470,36 +2228,34 @@ auto xyz_stat_gwesp_local_ISP= CHANGESTAT{
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     // 1. Step: For all ISP of i and j 
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners_nb(unit_i, unit_j, "ISP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners_nb<PartnerType::ISP>(unit_i, unit_j).size()));
     // 2. Step: For all h in OSP of i and j check their ISP between j and h 
-    std::vector<int> osp_ij = object.get_common_partners_nb(unit_i, unit_j, "OSP");
+    const std::vector<int>& osp_ij = object.shared_common_partners_nb<PartnerType::OSP>(unit_i, unit_j);
     
     
     for (int k : osp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_j, k, "ISP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::ISP>(unit_j, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step: For all h in OTP of i and j check their ISP between h and j
-    std::vector<int> otp_ij = object.get_common_partners_nb(unit_i, unit_j, "OTP");
+    const std::vector<int>& otp_ij = object.shared_common_partners_nb<PartnerType::OTP>(unit_i, unit_j);
     for (int k : otp_ij) {
-      tmp_count = object.count_common_partners_nb(k, unit_j, "ISP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::ISP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     } 
     return(res); 
   }else {
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_local_ISP", ::xyz_stat_gwesp_local_ISP, "gwesp_local_ISP",0.0);
+EFFECT_REGISTER_MODES("gwesp_local_ISP", ::xyz_stat_gwesp_local_ISP, "gwesp_local_ISP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwesp_local_symm= CHANGESTAT{
   if(mode == "z"){
     if(object.z_network.directed){
       Rcpp::stop("This statistic is only for undirected networks");  
     }
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     } 
@@ -2509,23 +2265,23 @@ auto xyz_stat_gwesp_local_symm= CHANGESTAT{
     
     // 1. Step: For all OTP of i and j 
     // 1. Step: 
-    std::vector<int> osp_ij = object.get_common_partners_nb(unit_i, unit_j);
-    double res = expo_pos*(1- pow(expo_min, osp_ij.size()));
+    const std::vector<int>& osp_ij = object.shared_common_partners_nb<PartnerType::OSP>(unit_i, unit_j);
+    double res = gw.expo_pos*(1- gw(osp_ij.size()));
     
     
     
     for (int k : osp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_i, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
-      tmp_count = object.count_common_partners_nb(unit_j, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(unit_j, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else { 
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_local_symm", ::xyz_stat_gwesp_local_symm, "gwesp_local_symm",0.0);
+EFFECT_REGISTER_MODES("gwesp_local_symm", ::xyz_stat_gwesp_local_symm, "gwesp_local_symm",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwesp_global_symm= CHANGESTAT{
   if(mode == "z"){
@@ -2533,30 +2289,29 @@ auto xyz_stat_gwesp_global_symm= CHANGESTAT{
       Rcpp::stop("This statistic is only for undirected networks");  
     }
     
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     // Check if the edge (i,j) currently exists physically in the object
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     
     // 1. Step: For all common partner of i and j 
-    std::vector<int> osp_ij = object.z_network.get_common_partners(unit_i, unit_j);
-    double res = expo_pos*(1- pow(expo_min, osp_ij.size()));
+    const std::vector<int>& osp_ij = object.shared_common_partners<PartnerType::OSP>(unit_i, unit_j);
+    double res = gw.expo_pos*(1- gw(osp_ij.size()));
     
     
     
     for (int k : osp_ij) {
-      tmp_count = object.z_network.count_common_partners(unit_i, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
-      tmp_count = object.z_network.count_common_partners(unit_j, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(unit_j, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else { 
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_global_symm", ::xyz_stat_gwesp_global_symm, "gwesp_global_symm",0.0);
+EFFECT_REGISTER_MODES("gwesp_global_symm", ::xyz_stat_gwesp_global_symm, "gwesp_global_symm",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 
 
@@ -2565,8 +2320,7 @@ auto xyz_stat_gwesp_local_OTP= CHANGESTAT{
     Rcpp::stop("This statistic is only for directed networks");  
   }
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     } 
@@ -2576,35 +2330,33 @@ auto xyz_stat_gwesp_local_OTP= CHANGESTAT{
     
     // 1. Step: For all OTP of i and j 
     
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners_nb(unit_i, unit_j, "OTP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners_nb<PartnerType::OTP>(unit_i, unit_j).size()));
     // 2. Step: 
-    std::vector<int> osp_ij = object.get_common_partners_nb(unit_i, unit_j, "OSP");
+    const std::vector<int>& osp_ij = object.shared_common_partners_nb<PartnerType::OSP>(unit_i, unit_j);
     
     for (int k : osp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_i, k, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OTP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step:
-    std::vector<int> isp_ij = object.get_common_partners_nb(unit_i, unit_j, "ISP");
+    const std::vector<int>& isp_ij = object.shared_common_partners_nb<PartnerType::ISP>(unit_i, unit_j);
     for (int k : isp_ij) {
-      tmp_count = object.count_common_partners_nb(k, unit_j, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OTP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else { 
     return(0.0);
   }
 }; 
-EFFECT_REGISTER("gwesp_local_OTP", ::xyz_stat_gwesp_local_OTP, "gwesp_local_OTP",0.0);
+EFFECT_REGISTER_MODES("gwesp_local_OTP", ::xyz_stat_gwesp_local_OTP, "gwesp_local_OTP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwesp_local_OSP= CHANGESTAT{
   if(!object.z_network.directed){
     Rcpp::stop("This statistic is only for directed networks");  
   }
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }  
@@ -2613,27 +2365,26 @@ auto xyz_stat_gwesp_local_OSP= CHANGESTAT{
     double tmp_count;
     
     // 1. Step: For all OSP of i and j 
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners_nb(unit_i, unit_j, "OSP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners_nb<PartnerType::OSP>(unit_i, unit_j).size()));
     // 2. Step: 
     
-    std::vector<int> otp_ij = object.get_common_partners_nb(unit_i, unit_j, "OTP");
+    const std::vector<int>& otp_ij = object.shared_common_partners_nb<PartnerType::OTP>(unit_i, unit_j);
     for (int k : otp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_i, k, "OSP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step:
-    std::vector<int> isp_ij = object.get_common_partners_nb(unit_i, unit_j, "ISP");
+    const std::vector<int>& isp_ij = object.shared_common_partners_nb<PartnerType::ISP>(unit_i, unit_j);
     for (int k : isp_ij) {
-      tmp_count = object.count_common_partners_nb(k, unit_i, "OSP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(k, unit_i);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else { 
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_local_OSP", ::xyz_stat_gwesp_local_OSP, "gwesp_local_OSP",0.0);
+EFFECT_REGISTER_MODES("gwesp_local_OSP", ::xyz_stat_gwesp_local_OSP, "gwesp_local_OSP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwesp_ITP = CHANGESTAT{
   if(!object.z_network.directed){
@@ -2643,28 +2394,27 @@ auto xyz_stat_gwesp_ITP = CHANGESTAT{
   if(mode == "z"){
     
     
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
-    std::vector<int> itp_ij = object.get_common_partners_nb(unit_i, unit_j, "ITP");
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
+    const std::vector<int>& itp_ij = object.shared_common_partners_nb<PartnerType::ITP>(unit_i, unit_j);
     
     if (itp_ij.empty()) return 0.0;
     double total_change = 0;
-    total_change +=expo_pos*(1- pow(expo_min, itp_ij.size()));
+    total_change +=gw.expo_pos*(1- gw(itp_ij.size()));
     // Check if the edge (i,j) currently exists physically in the object
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     for (int k : itp_ij) {
-      tmp_count = object.count_common_partners_nb(unit_j, k, "ITP");
-      total_change += std::pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count);
-      tmp_count = object.count_common_partners_nb(k, unit_i, "ITP");
-      total_change += std::pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count);
+      tmp_count = object.cached_common_partners_nb<PartnerType::ITP>(unit_j, k);
+      total_change += gw(edge_exists ? (tmp_count - 1) : tmp_count);
+      tmp_count = object.cached_common_partners_nb<PartnerType::ITP>(k, unit_i);
+      total_change += gw(edge_exists ? (tmp_count - 1) : tmp_count);
     } 
     return total_change;
   } else {  
     return 0.0;
   } 
 };
-EFFECT_REGISTER("gwesp_global_ITP", ::xyz_stat_gwesp_ITP, "gwesp_global_ITP", 0.0);
+EFFECT_REGISTER_MODES("gwesp_global_ITP", ::xyz_stat_gwesp_ITP, "gwesp_global_ITP", 0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwesp_ISP= CHANGESTAT{
   if(!object.z_network.directed){
@@ -2672,33 +2422,31 @@ auto xyz_stat_gwesp_ISP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     // 1. Step: For all ISP of i and j 
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners(unit_i, unit_j, "ISP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners<PartnerType::ISP>(unit_i, unit_j).size()));
     // 2. Step: For all h in OSP of i and j check their ISP between j and h 
-    std::vector<int> osp_ij = object.get_common_partners(unit_i, unit_j, "OSP");
+    const std::vector<int>& osp_ij = object.shared_common_partners<PartnerType::OSP>(unit_i, unit_j);
     
     // Check if the edge (i,j) currently exists physically in the object
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     for (int k : osp_ij) {
-      tmp_count = object.count_common_partners(unit_j, k, "ISP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::ISP>(unit_j, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step: For all h in OTP of i and j check their ISP between h and j
-    std::vector<int> otp_ij = object.get_common_partners(unit_i, unit_j, "OTP");
+    const std::vector<int>& otp_ij = object.shared_common_partners<PartnerType::OTP>(unit_i, unit_j);
     for (int k : otp_ij) {
-      tmp_count = object.count_common_partners(k, unit_j, "ISP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::ISP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else {
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_global_ISP", ::xyz_stat_gwesp_ISP, "gwesp_global_ISP",0.0);
+EFFECT_REGISTER_MODES("gwesp_global_ISP", ::xyz_stat_gwesp_ISP, "gwesp_global_ISP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwesp_OTP= CHANGESTAT{
   if(!object.z_network.directed){
@@ -2706,33 +2454,31 @@ auto xyz_stat_gwesp_OTP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     // 1. Step: For all OTP of i and j 
     
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners(unit_i, unit_j, "OTP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners<PartnerType::OTP>(unit_i, unit_j).size()));
     // 2. Step: 
-    std::vector<int> osp_ij = object.get_common_partners(unit_i, unit_j, "OSP");
+    const std::vector<int>& osp_ij = object.shared_common_partners<PartnerType::OSP>(unit_i, unit_j);
     
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     for (int k : osp_ij) {
-      tmp_count = object.count_common_partners(unit_i, k, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OTP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step:
-    std::vector<int> isp_ij = object.get_common_partners(unit_i, unit_j, "ISP");
+    const std::vector<int>& isp_ij = object.shared_common_partners<PartnerType::ISP>(unit_i, unit_j);
     for (int k : isp_ij) {
-      tmp_count = object.count_common_partners(k, unit_j, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OTP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_global_OTP", ::xyz_stat_gwesp_OTP, "gwesp_global_OTP",0.0);
+EFFECT_REGISTER_MODES("gwesp_global_OTP", ::xyz_stat_gwesp_OTP, "gwesp_global_OTP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwesp_OSP= CHANGESTAT{
   if(!object.z_network.directed){
@@ -2740,32 +2486,30 @@ auto xyz_stat_gwesp_OSP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
-    double expo_pos = exp(data.at(0,0));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     // 1. Step: For all OSP of i and j 
-    double res = expo_pos*(1- pow(expo_min, 
-                                  object.count_common_partners(unit_i, unit_j, "OSP")));
+    double res = gw.expo_pos*(1- gw(object.shared_common_partners<PartnerType::OSP>(unit_i, unit_j).size()));
     // 2. Step: 
     
-    std::vector<int> otp_ij = object.get_common_partners(unit_i, unit_j, "OTP");
+    const std::vector<int>& otp_ij = object.shared_common_partners<PartnerType::OTP>(unit_i, unit_j);
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
     for (int k : otp_ij) {
-      tmp_count = object.count_common_partners(unit_i, k, "OSP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     // 3. Step:
-    std::vector<int> isp_ij = object.get_common_partners(unit_i, unit_j, "ISP");
+    const std::vector<int>& isp_ij = object.shared_common_partners<PartnerType::ISP>(unit_i, unit_j);
     for (int k : isp_ij) {
-      tmp_count = object.count_common_partners(k, unit_i, "OSP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(k, unit_i);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }
     return(res);
   }else { 
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwesp_global_OSP", ::xyz_stat_gwesp_OSP, "gwesp_global_OSP",0.0);
+EFFECT_REGISTER_MODES("gwesp_global_OSP", ::xyz_stat_gwesp_OSP, "gwesp_global_OSP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwdsp_symm= CHANGESTAT{
   if(object.z_network.directed){
@@ -2773,7 +2517,7 @@ auto xyz_stat_gwdsp_symm= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     // 1. Step: 
     
@@ -2782,29 +2526,29 @@ auto xyz_stat_gwdsp_symm= CHANGESTAT{
     double tmp_count;
     for (int k : out_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners(unit_i, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }  
     // 2. Step: 
     auto& out_i = object.z_network.adj_list.at(unit_i);
     for (int k : out_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners(k, unit_j);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }  
     return(res);
   }else {     
     return(0);
   } 
 }; 
-EFFECT_REGISTER("gwdsp_global_symm", ::xyz_stat_gwdsp_symm, "gwdsp_global_symm",0.0);
+EFFECT_REGISTER_MODES("gwdsp_global_symm", ::xyz_stat_gwdsp_symm, "gwdsp_global_symm",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwdsp_local_symm= CHANGESTAT{
   if(object.z_network.directed){
     Rcpp::stop("This statistic is only for undirected networks");  
   }
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     } 
@@ -2817,22 +2561,22 @@ auto xyz_stat_gwdsp_local_symm= CHANGESTAT{
     double tmp_count;
     for (int k : out_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners_nb(unit_i, k);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }   
     // 2. Step: 
     auto& out_i = object.z_network.adj_list.at(unit_i);
     for (int k : out_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners_nb(k, unit_j);
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }   
     return(res);
   }else {      
     return(0);
   } 
 }; 
-EFFECT_REGISTER("gwdsp_local_symm", ::xyz_stat_gwdsp_local_symm, "gwdsp_local_symm",0.0);
+EFFECT_REGISTER_MODES("gwdsp_local_symm", ::xyz_stat_gwdsp_local_symm, "gwdsp_local_symm",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 
 auto xyz_stat_gwdsp_ITP= CHANGESTAT{
@@ -2841,7 +2585,7 @@ auto xyz_stat_gwdsp_ITP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     // 1. Step: 
     
@@ -2850,23 +2594,23 @@ auto xyz_stat_gwdsp_ITP= CHANGESTAT{
     double tmp_count;
     for (int k : out_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners(unit_i, k, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OTP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     } 
     // 2. Step: 
     auto& in_i = object.z_network.adj_list_in.at(unit_i);
     for (int k : in_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners(k, unit_j, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners<PartnerType::OTP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     } 
     return(res);
   }else {    
     return(0);
   } 
 }; 
-EFFECT_REGISTER("gwdsp_global_ITP", ::xyz_stat_gwdsp_ITP, "gwdsp_global_ITP",0.0);
-EFFECT_REGISTER("gwdsp_global_OTP", ::xyz_stat_gwdsp_ITP, "gwdsp_global_OTP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_global_ITP", ::xyz_stat_gwdsp_ITP, "gwdsp_global_ITP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
+EFFECT_REGISTER_MODES("gwdsp_global_OTP", ::xyz_stat_gwdsp_ITP, "gwdsp_global_OTP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 auto xyz_stat_gwdsp_ISP= CHANGESTAT{
   if(!object.z_network.directed){
@@ -2874,7 +2618,7 @@ auto xyz_stat_gwdsp_ISP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
@@ -2883,18 +2627,18 @@ auto xyz_stat_gwdsp_ISP= CHANGESTAT{
     auto& out_i = object.z_network.adj_list.at(unit_i);
     for (int k : out_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners(unit_j, k, "ISP");
+      tmp_count = object.cached_common_partners<PartnerType::ISP>(unit_j, k);
       if (edge_exists) {
         tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
       }
-      res += 2.0*pow(expo_min, tmp_count); 
+      res += 2.0*gw(tmp_count); 
     }
     return(res);
   }else {   
     return(0);
   }
 };  
-EFFECT_REGISTER("gwdsp_global_ISP", ::xyz_stat_gwdsp_ISP, "gwdsp_global_ISP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_global_ISP", ::xyz_stat_gwdsp_ISP, "gwdsp_global_ISP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 
 auto xyz_stat_gwdsp_OSP= CHANGESTAT{
@@ -2905,7 +2649,7 @@ auto xyz_stat_gwdsp_OSP= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
@@ -2914,18 +2658,18 @@ auto xyz_stat_gwdsp_OSP= CHANGESTAT{
     auto& in_j = object.z_network.adj_list_in.at(unit_j);
     for (int k : in_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners(unit_i, k, "OSP");
+      tmp_count = object.cached_common_partners<PartnerType::OSP>(unit_i, k);
       if (edge_exists) {
         tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
       }
-      res += 2.0*pow(expo_min, tmp_count); 
+      res += 2.0*gw(tmp_count); 
     }
     return(res);
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwdsp_global_OSP", ::xyz_stat_gwdsp_OSP, "gwdsp_global_OSP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_global_OSP", ::xyz_stat_gwdsp_OSP, "gwdsp_global_OSP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS);
 
 
 auto xyz_stat_gwdsp_ITP_local= CHANGESTAT{
@@ -2934,7 +2678,7 @@ auto xyz_stat_gwdsp_ITP_local= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     // 1. Step: 
     if(object.get_val_overlap(unit_i, unit_j) == false){
@@ -2946,30 +2690,30 @@ auto xyz_stat_gwdsp_ITP_local= CHANGESTAT{
     double tmp_count;
     for (int k : out_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners_nb(unit_i, k, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OTP>(unit_i, k);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     } 
     // 2. Step: 
     auto& in_i = object.adj_list_in_nb.at(unit_i);
     for (int k : in_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners_nb(k, unit_j, "OTP");
-      res += pow(expo_min, edge_exists ? (tmp_count - 1) : tmp_count); 
+      tmp_count = object.cached_common_partners_nb<PartnerType::OTP>(k, unit_j);
+      res += gw(edge_exists ? (tmp_count - 1) : tmp_count); 
     }  
     return(res);
   }else {     
     return(0);
   } 
 }; 
-EFFECT_REGISTER("gwdsp_local_ITP", ::xyz_stat_gwdsp_ITP_local, "gwdsp_local_ITP",0.0);
-EFFECT_REGISTER("gwdsp_local_OTP", ::xyz_stat_gwdsp_ITP_local, "gwdsp_local_OTP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_local_ITP", ::xyz_stat_gwdsp_ITP_local, "gwdsp_local_ITP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
+EFFECT_REGISTER_MODES("gwdsp_local_OTP", ::xyz_stat_gwdsp_ITP_local, "gwdsp_local_OTP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwdsp_ISP_local= CHANGESTAT{
   if(mode == "z"){
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
@@ -2978,18 +2722,18 @@ auto xyz_stat_gwdsp_ISP_local= CHANGESTAT{
     auto& out_i = object.adj_list_nb.at(unit_i);
     for (int k : out_i) {
       if(unit_j == k) continue;
-      tmp_count = object.count_common_partners_nb(unit_j, k, "ISP");
+      tmp_count = object.cached_common_partners_nb<PartnerType::ISP>(unit_j, k);
       if (edge_exists) {
         tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
       }
-      res += 2.0*pow(expo_min, tmp_count); 
+      res += 2.0*gw(tmp_count); 
     } 
     return(res);
   }else {    
     return(0);
   } 
 };  
-EFFECT_REGISTER("gwdsp_local_ISP", ::xyz_stat_gwdsp_ISP_local, "gwdsp_local_ISP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_local_ISP", ::xyz_stat_gwdsp_ISP_local, "gwdsp_local_ISP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwdsp_OSP_local= CHANGESTAT{
   if(!object.z_network.directed){
@@ -3000,7 +2744,7 @@ auto xyz_stat_gwdsp_OSP_local= CHANGESTAT{
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     double res = 0.0;
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count;
@@ -3009,11 +2753,11 @@ auto xyz_stat_gwdsp_OSP_local= CHANGESTAT{
     auto& in_j = object.adj_list_in_nb.at(unit_j);
     for (int k : in_j) {
       if(unit_i == k) continue;
-      tmp_count = object.count_common_partners_nb(unit_i, k, "OSP");
+      tmp_count = object.cached_common_partners_nb<PartnerType::OSP>(unit_i, k);
       if (edge_exists) {
         tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
       } 
-      res += 2.0*pow(expo_min, tmp_count); 
+      res += 2.0*gw(tmp_count); 
     }
     return(res); 
   }else {  
@@ -3021,7 +2765,7 @@ auto xyz_stat_gwdsp_OSP_local= CHANGESTAT{
   }
 }; 
 
-EFFECT_REGISTER("gwdsp_local_OSP", ::xyz_stat_gwdsp_OSP_local, "gwdsp_local_OSP",0.0);
+EFFECT_REGISTER_MODES("gwdsp_local_OSP", ::xyz_stat_gwdsp_OSP_local, "gwdsp_local_OSP",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS | ::iglm::SHARED_PARTNERS_LOCAL);
 
 auto xyz_stat_gwidegree= CHANGESTAT{
   if(!object.z_network.directed){
@@ -3029,50 +2773,50 @@ auto xyz_stat_gwidegree= CHANGESTAT{
   }
   
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count = object.z_network.in_degrees[unit_j];
     if (edge_exists) {
       tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
     }
-    return(pow(expo_min, tmp_count));
+    return(gw(tmp_count));
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwidegree_global", ::xyz_stat_gwidegree, "gwidegree_global",0.0);
+EFFECT_REGISTER_MODES("gwidegree_global", ::xyz_stat_gwidegree, "gwidegree_global",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
 
 auto xyz_stat_gwodegree= CHANGESTAT{
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     bool edge_exists = object.z_network.get_val(unit_i, unit_j);
     double tmp_count = object.z_network.out_degrees[unit_i];
     if (edge_exists) {
       tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
     }
-    double res = pow(expo_min, tmp_count);
+    double res = gw(tmp_count);
     // Add Node j contribution for undirected networks
     if (!object.z_network.directed) {
       double tmp_count_j = object.z_network.out_degrees[unit_j];
       if (edge_exists) {
         tmp_count_j = (tmp_count_j > 0) ? (tmp_count_j - 1) : 0.0; 
       }
-      res += pow(expo_min, tmp_count_j);
+      res += gw(tmp_count_j);
     }
     return(res);
   }else {  
     return(0.0);
   }
 }; 
-EFFECT_REGISTER("gwodegree_global", ::xyz_stat_gwodegree, "gwodegree_global",0.0);
-EFFECT_REGISTER("gwdegree_global", ::xyz_stat_gwodegree, "gwdegree_global",0.0);
+EFFECT_REGISTER_MODES("gwodegree_global", ::xyz_stat_gwodegree, "gwodegree_global",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
+EFFECT_REGISTER_MODES("gwdegree_global", ::xyz_stat_gwodegree, "gwdegree_global",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
 
 auto xyz_stat_gwidegree_local= CHANGESTAT{
   if(!object.z_network.directed){
     Rcpp::stop("This statistic is only for directed networks");  
   }
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
@@ -3081,16 +2825,16 @@ auto xyz_stat_gwidegree_local= CHANGESTAT{
     if (edge_exists) {
       tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
     }
-    return(pow(expo_min, tmp_count));
+    return(gw(tmp_count));
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwidegree_local", ::xyz_stat_gwidegree_local, "gwidegree_local",0.0);
+EFFECT_REGISTER_MODES("gwidegree_local", ::xyz_stat_gwidegree_local, "gwidegree_local",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
 
 auto xyz_stat_gwodegree_local= CHANGESTAT{
   if(mode == "z"){
-    double expo_min = (1-exp(-data.at(0,0)));  
+    const GeometricWeights& gw = object.geometric_weights(data.at(0,0));
     if(object.get_val_overlap(unit_i, unit_j) == false){
       return(0);
     }
@@ -3099,19 +2843,19 @@ auto xyz_stat_gwodegree_local= CHANGESTAT{
     if (edge_exists) {
       tmp_count = (tmp_count > 0) ? (tmp_count - 1) : 0.0; 
     }
-    double res = pow(expo_min, tmp_count);
+    double res = gw(tmp_count);
     // Add Node j contribution for undirected networks
     if (!object.z_network.directed) {
       double tmp_count_j = object.out_degrees_nb[unit_j];
       if (edge_exists) {
         tmp_count_j = (tmp_count_j > 0) ? (tmp_count_j - 1) : 0.0; 
       }
-      res += pow(expo_min, tmp_count_j);
+      res += gw(tmp_count_j);
     }
     return(res);
   }else {  
     return(0);
   }
 }; 
-EFFECT_REGISTER("gwodegree_local", ::xyz_stat_gwodegree_local, "gwodegree_local",0.0);
-EFFECT_REGISTER("gwdegree_local", ::xyz_stat_gwodegree_local, "gwdegree_local",0.0);
+EFFECT_REGISTER_MODES("gwodegree_local", ::xyz_stat_gwodegree_local, "gwodegree_local",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
+EFFECT_REGISTER_MODES("gwdegree_local", ::xyz_stat_gwodegree_local, "gwdegree_local",0.0, ::iglm::MODE_Z | ::iglm::GEOMETRIC_WEIGHTS);
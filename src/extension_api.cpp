@@ -13,10 +13,16 @@ Registry& Registry::instance() {
 bool Registry::add(const std::string& name,
                    ExtFn fn,
                    const std::string& short_name,
-                   double value)
+                   double value,
+                   unsigned modes,
+                   BatchExtFn batch_fn)
 {
   std::lock_guard<std::mutex> lock(mu_);
-  auto result = map_.emplace(name, FUN{fn, short_name, value});
+  auto result = map_.emplace(name, FUN{fn, short_name, value, modes & MODES_ALL, batch_fn,
+                                       (modes & DYAD_INDEPENDENT) != 0,
+                                       (modes & GEOMETRIC_WEIGHTS) != 0,
+                                       (modes & SHARED_PARTNERS) != 0,
+                                       (modes & SHARED_PARTNERS_LOCAL) != 0});
   return result.second; 
 }
 
@@ -25,6 +31,11 @@ bool Registry::has(const std::string& name) const {
   return map_.count(name); 
 }
 
+bool Registry::remove(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mu_);
+  return map_.erase(name) > 0;
+}
+
 ExtFn Registry::get(const std::string& name) const {
   std::lock_guard<std::mutex> lock(mu_);
   auto it = map_.find(name);
@@ -61,6 +72,28 @@ std::vector<FUN> Registry::all_meta() const {
   return out; 
 }
 
+TermTable Registry::table(const std::vector<std::string>& terms) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  TermTable out;
+  out.fns.reserve(terms.size());
+  for (size_t i = 0; i < terms.size(); ++i) {
+    auto it = map_.find(terms[i]);
+    if (it == map_.end())
+      throw std::invalid_argument("The statistic " + terms[i] + " does not exist");
+    out.fns.push_back(it->second.fn);
+    out.dyad_independent = out.dyad_independent && it->second.dyad_independent;
+    if (it->second.geometric_weights) out.geometric_weights.push_back(i);
+    out.shared_partners = out.shared_partners || it->second.shared_partners;
+    out.shared_partners_local = out.shared_partners_local || it->second.shared_partners_local;
+    for (int m = 0; m < N_MODES; ++m) {
+      if (it->second.modes & mode_bit(static_cast<Mode>(m))) {
+        out.by_mode[m].push_back({i, it->second.fn, it->second.batch_fn});
+      }
+    }
+  }
+  return out; 
+}
+
 } // namespace iglm
 
 extern "C" void iglm_register_term_C(const char* name, void* fn_ptr, const char* short_name, double value) {
@@ -72,7 +105,27 @@ extern "C" void iglm_register_term_C(const char* name, void* fn_ptr, const char*
     iglm::Registry::instance().add(n, (iglm::ExtFn)fn_ptr, sn, value);
 }
 
+extern "C" void iglm_register_term_modes_C(const char* name, void* fn_ptr, const char* short_name, double value, unsigned modes) {
+    if (!fn_ptr) {
+        Rcpp::stop("Invalid function pointer passed to iglm_register_term_modes_C");
+    }
+    std::string n(name);
+    std::string sn(short_name);
+    iglm::Registry::instance().add(n, (iglm::ExtFn)fn_ptr, sn, value, modes);
+}
+
+extern "C" void iglm_register_term_batch_C(const char* name, void* fn_ptr, void* batch_fn_ptr, const char* short_name, double value, unsigned modes) {
+    if (!fn_ptr || !batch_fn_ptr) {
+        Rcpp::stop("Invalid function pointer passed to iglm_register_term_batch_C");
+    }
+    std::string n(name);
+    std::string sn(short_name);
+    iglm::Registry::instance().add(n, (iglm::ExtFn)fn_ptr, sn, value, modes, (iglm::BatchExtFn)batch_fn_ptr);
+}
+
 // [[Rcpp::init]]
 void iglm_init_callable(DllInfo *dll) {
     R_RegisterCCallable("iglm", "iglm_register_term_C", (DL_FUNC)iglm_register_term_C);
+    R_RegisterCCallable("iglm", "iglm_register_term_modes_C", (DL_FUNC)iglm_register_term_modes_C);
+    R_RegisterCCallable("iglm", "iglm_register_term_batch_C", (DL_FUNC)iglm_register_term_batch_C);
 }
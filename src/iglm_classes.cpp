@@ -4,6 +4,9 @@
 #include "iglm/xz_class.h"
 #include "iglm/xyz_class.h"
 #include "iglm/helper_functions.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // Attribute implementations
 Attribute::Attribute(int a, std::string type_, double scale_) {
@@ -44,30 +47,32 @@ void Attribute::print() {
 }
 
 // Network implementations
-Network::Network(int n_actor_, bool directed_) {
+Network::Network(int n_actor_, bool directed_, StorageMode storage_) {
     n_actor = n_actor_;
     directed = directed_;
+    storage = resolve_storage_mode(storage_, n_actor);
     adj_list.resize(n_actor + 1);
     if (directed) {
         adj_list_in.resize(n_actor + 1);
     }
-    adj_mat.assign(n_actor * n_actor, 0);
+    reset_bits();
     out_degrees.assign(n_actor + 1, 0);
     in_degrees.assign(n_actor + 1, 0);
     number_edges = 0;
 }
 
-Network::Network(int n_actor_, bool directed_, arma::mat mat) {
+Network::Network(int n_actor_, bool directed_, arma::mat mat, StorageMode storage_) {
     n_actor = n_actor_;
     directed = directed_;
+    storage = resolve_storage_mode(storage_, n_actor);
     adj_list.resize(n_actor + 1);
     if (directed) {
         adj_list_in.resize(n_actor + 1);
     }
-    adj_mat.assign(n_actor * n_actor, 0);
     out_degrees.assign(n_actor + 1, 0);
     in_degrees.assign(n_actor + 1, 0);
-    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in, adj_mat);
+    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in);
+    set_bits_from_lists();
     for(int i = 1; i <= n_actor; i++) {
         out_degrees[i] = adj_list[i].size();
         if (directed) in_degrees[i] = adj_list_in[i].size();
@@ -76,6 +81,50 @@ Network::Network(int n_actor_, bool directed_, arma::mat mat) {
     number_edges = count_edges(); 
 }
 
+void Network::reset_bits() {
+    if (storage == StorageMode::sparse) {
+        adj_bits.assign(0, 0);
+        adj_bits_in.assign(0, 0);
+        adj_set.init(n_actor, StorageMode::sparse);
+        return;
+    }
+    adj_bits.assign(n_actor, n_actor);
+    if (directed) {
+        adj_bits_in.assign(n_actor, n_actor);
+    } else {
+        adj_bits_in.assign(0, 0);
+    }
+    adj_set.init(0, StorageMode::sparse);
+}
+
+void Network::set_bits_from_lists() {
+    reset_bits();
+    for (int i = 1; i <= n_actor; i++) {
+        for (int j : adj_list[i]) {
+            set_edge_flags(i, j);
+        }
+    }
+}
+
+// Only marks the ordered pair (from, to); the undirected callers set both directions
+void Network::set_edge_flags(int from, int to) {
+    if (storage == StorageMode::sparse) {
+        adj_set.set(from, to);
+        return;
+    }
+    adj_bits.set(from - 1, to - 1);
+    if (directed) adj_bits_in.set(to - 1, from - 1);
+}
+
+void Network::reset_edge_flags(int from, int to) {
+    if (storage == StorageMode::sparse) {
+        adj_set.reset(from, to);
+        return;
+    }
+    adj_bits.reset(from - 1, to - 1);
+    if (directed) adj_bits_in.reset(to - 1, from - 1);
+}
+
 void Network::set_network_from_mat(int n_actor_, bool directed_, arma::mat mat){
     n_actor = n_actor_;
     directed = directed_;
@@ -85,10 +134,10 @@ void Network::set_network_from_mat(int n_actor_, bool directed_, arma::mat mat){
         adj_list_in.clear();
         adj_list_in.resize(n_actor + 1);
     }
-    adj_mat.assign(n_actor * n_actor, 0);
     out_degrees.assign(n_actor + 1, 0);
     in_degrees.assign(n_actor + 1, 0);
-    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in, adj_mat);
+    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in);
+    set_bits_from_lists();
     for(int i = 1; i <= n_actor; i++) {
         out_degrees[i] = adj_list[i].size();
         if (directed) in_degrees[i] = adj_list_in[i].size();
@@ -98,7 +147,7 @@ void Network::set_network_from_mat(int n_actor_, bool directed_, arma::mat mat){
 }
 
 void Network::change_edge(int from, int to) {
-    if(adj_mat[get_mat_idx(from, to)]) {
+    if(has_edge(from, to)) {
         delete_edge(from, to);
     } else {
         add_edge(from, to);
@@ -106,75 +155,18 @@ void Network::change_edge(int from, int to) {
 }
 
 size_t Network::count_common_partners(unsigned int from, unsigned int to, std::string type) const {
-    if (type == "OTP") {
-        const std::vector<int>& l1 = adj_list[from];
-        if (directed) {
-            const std::vector<int>& l2 = adj_list_in[to];
-             if (l1.size() < l2.size()) {
-                size_t count = 0;
-                for (int k : l1) if (adj_mat[get_mat_idx(k, to)]) count++;
-                return count;
-            } else {
-                size_t count = 0;
-                for (int k : l2) if (adj_mat[get_mat_idx(from, k)]) count++;
-                return count;
-            }
-        }
-    } else if (type == "ISP") {
-        if (directed) {
-            const std::vector<int>& l1 = adj_list_in[from];
-            const std::vector<int>& l2 = adj_list_in[to];
-            if (l1.size() < l2.size()) {
-                size_t count = 0;
-                for (int k : l1) if (adj_mat[get_mat_idx(k, to)]) count++;
-                return count;
-            } else {
-                size_t count = 0;
-                for (int k : l2) if (adj_mat[get_mat_idx(k, from)]) count++;
-                return count;
-            }
-        }
-    } else if (type == "OSP") {
-        const std::vector<int>& l1 = adj_list[from];
-        const std::vector<int>& l2 = adj_list[to];
-        if (l1.size() < l2.size()) {
-            size_t count = 0;
-            for (int k : l1) if (adj_mat[get_mat_idx(to, k)]) count++;
-            return count;
-        } else {
-            size_t count = 0;
-            for (int k : l2) if (adj_mat[get_mat_idx(from, k)]) count++;
-            return count;
-        }
-    } else if (type == "ITP") {
-        if (directed) {
-            const std::vector<int>& l1 = adj_list_in[from];
-            const std::vector<int>& l2 = adj_list[to];
-            if (l1.size() < l2.size()) {
-                size_t count = 0;
-                for (int k : l1) if (adj_mat[get_mat_idx(to, k)]) count++;
-                return count;
-            } else {
-                size_t count = 0;
-                for (int k : l2) if (adj_mat[get_mat_idx(k, from)]) count++;
-                return count;
-            }
-        }
-    }
+    if (type == "OTP") return count_common_partners<PartnerType::OTP>(from, to);
+    if (type == "ISP") return count_common_partners<PartnerType::ISP>(from, to);
+    if (type == "OSP") return count_common_partners<PartnerType::OSP>(from, to);
+    if (type == "ITP") return count_common_partners<PartnerType::ITP>(from, to);
     return 0;
 }
 
 std::vector<int> Network::get_common_partners(unsigned int from,unsigned int to, std::string type) const {
-    if(type == "OTP"){
-        return(get_intersection_vec(adj_list[from], adj_list_in[to])); 
-    } else  if(type == "ISP"){
-        return(get_intersection_vec(adj_list_in[from], adj_list_in[to])); 
-    }else  if(type == "OSP"){
-        return(get_intersection_vec(adj_list[from], adj_list[to])); 
-    }
-    else  if(type == "ITP"){
-        return(get_intersection_vec(adj_list_in[from], adj_list[to])); 
-    }
+    if (type == "OTP") return get_common_partners<PartnerType::OTP>(from, to);
+    if (type == "ISP") return get_common_partners<PartnerType::ISP>(from, to);
+    if (type == "OSP") return get_common_partners<PartnerType::OSP>(from, to);
+    if (type == "ITP") return get_common_partners<PartnerType::ITP>(from, to);
     return std::vector<int>();
 }
 
@@ -188,24 +180,24 @@ double Network::count_edges() const {
 
 void Network::add_edge(int from, int to) {
     if(directed){
-        if (!adj_mat[get_mat_idx(from, to)]) {
+        if (!has_edge(from, to)) {
             auto& o_list = adj_list[from];
             o_list.insert(std::lower_bound(o_list.begin(), o_list.end(), to), to);
             auto& i_list = adj_list_in[to];
             i_list.insert(std::lower_bound(i_list.begin(), i_list.end(), from), from);
-            adj_mat[get_mat_idx(from, to)] = 1;
+            set_edge_flags(from, to);
             out_degrees[from]++;
             in_degrees[to]++;
             number_edges ++;
         }
     } else{
-        if (!adj_mat[get_mat_idx(from, to)]) {
+        if (!has_edge(from, to)) {
             auto& list_f = adj_list[from];
             list_f.insert(std::lower_bound(list_f.begin(), list_f.end(), to), to);
             auto& list_t = adj_list[to];
             list_t.insert(std::lower_bound(list_t.begin(), list_t.end(), from), from);
-            adj_mat[get_mat_idx(from, to)] = 1;
-            adj_mat[get_mat_idx(to, from)] = 1;
+            set_edge_flags(from, to);
+            set_edge_flags(to, from);
             out_degrees[from]++;
             out_degrees[to]++;
             in_degrees[from]++;
@@ -217,20 +209,20 @@ void Network::add_edge(int from, int to) {
 
 void Network::delete_edge(int from, int to) {
     if(directed){
-        if (adj_mat[get_mat_idx(from, to)]) {
+        if (has_edge(from, to)) {
             adj_list[from].erase(std::remove(adj_list[from].begin(), adj_list[from].end(), to), adj_list[from].end());
             adj_list_in[to].erase(std::remove(adj_list_in[to].begin(), adj_list_in[to].end(), from), adj_list_in[to].end());
-            adj_mat[get_mat_idx(from, to)] = 0;
+            reset_edge_flags(from, to);
             out_degrees[from]--;
             in_degrees[to]--;
             number_edges --;
         }
     } else{
-        if (adj_mat[get_mat_idx(from, to)]) {
+        if (has_edge(from, to)) {
             adj_list[from].erase(std::remove(adj_list[from].begin(), adj_list[from].end(), to), adj_list[from].end());
             adj_list[to].erase(std::remove(adj_list[to].begin(), adj_list[to].end(), from), adj_list[to].end());
-            adj_mat[get_mat_idx(from, to)] = 0;
-            adj_mat[get_mat_idx(to, from)] = 0;
+            reset_edge_flags(from, to);
+            reset_edge_flags(to, from);
             out_degrees[from]--;
             out_degrees[to]--;
             in_degrees[from]--;
@@ -241,119 +233,192 @@ void Network::delete_edge(int from, int to) {
 }
 
 void Network::add_edges_from_mat(arma::mat mat) {
-    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in, adj_mat);
+    mat_to_map_vec(mat, n_actor, directed, adj_list, adj_list_in);
+    set_bits_from_lists();
     number_edges = count_edges();
 }
 
+// Appends (from, to) to a dyad list and records its position
+static inline void dyad_list_push(std::vector<std::pair<int, int>>& list, DyadIndex& idx, int from, int to) {
+    idx.set(from, to, list.size());
+    list.push_back({from, to});
+}
+
+// Swap-with-last removal of (from, to) from a dyad list; a no-op if absent.
+// When the list has exactly one element, last == the removed element, so the
+// re-assignment is harmless and the final erase leaves the index correct.
+// The index is shared by the active and inactive lists (see overlap_nb_idx),
+// so an indexed dyad must be removed from the list that holds it.
+static inline void dyad_list_remove(std::vector<std::pair<int, int>>& list, DyadIndex& idx, int from, int to) {
+    int pos = idx.get(from, to);
+    if (pos == -1) return;
+    auto last = list.back();
+    list[pos] = last;
+    idx.set(last.first, last.second, pos);
+    list.pop_back();
+    idx.erase(from, to);
+}
+
+// Edges and common partner counts of all ordered dyads as seen by Network, so
+// that the tests can compare the bit-packed rows ("partners") and the sorted
+// adjacency lists ("listed") against a dense reference
+Rcpp::List network_partner_counts(const arma::mat& z_network, bool directed, std::string type) {
+    int n_actor = z_network.n_rows;
+    Network net(n_actor, directed, z_network);
+    arma::mat edges(n_actor, n_actor, arma::fill::zeros);
+    arma::mat partners(n_actor, n_actor, arma::fill::zeros);
+    arma::mat listed(n_actor, n_actor, arma::fill::zeros);
+    for (int i = 1; i <= n_actor; i++) {
+        for (int j = 1; j <= n_actor; j++) {
+            edges(i - 1, j - 1) = net.has_edge(i, j);
+            partners(i - 1, j - 1) = net.count_common_partners(i, j, type);
+            listed(i - 1, j - 1) = net.get_common_partners(i, j, type).size();
+        }
+    }
+    return Rcpp::List::create(Rcpp::Named("edges") = edges,
+                              Rcpp::Named("partners") = partners,
+                              Rcpp::Named("listed") = listed);
+}
+
+// Geometric weights (1 - exp(-decay))^count as looked up in the table of
+// GeometricWeights for a network of n_actor actors, together with exp(decay)
+Rcpp::List geometric_weights_table(double decay, int n_actor, const arma::vec& counts) {
+    GeometricWeights gw(decay, n_actor);
+    arma::vec weights(counts.n_elem);
+    for (arma::uword k = 0; k < counts.n_elem; k++) {
+        weights(k) = gw(counts(k));
+    }
+    return Rcpp::List::create(Rcpp::Named("weights") = weights,
+                              Rcpp::Named("expo_pos") = gw.expo_pos);
+}
+
 // XZ_class implementations
-XZ_class::XZ_class(int n_actor_, bool directed_, std::string type_, double scale_):
+XZ_class::XZ_class(int n_actor_, bool directed_, std::string type_, double scale_, StorageMode storage_):
     n_actor(n_actor_),                             
-    z_network(n_actor_, directed_),              
+    z_network(n_actor_, directed_, storage_),              
     x_attribute(n_actor_, type_, scale_)         
 {
-    overlap.resize(n_actor + 1);
-    neighborhood.resize(n_actor + 1);
+    Topology& t = edit_topology();
+    t.overlap.resize(n_actor + 1);
+    t.neighborhood.resize(n_actor + 1);
     adj_list_nb.resize(n_actor + 1);
     adj_list_in_nb.resize(n_actor + 1);
-    overlap_bool_mat.assign(n_actor * n_actor, 0);
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
-    overlap_mat = arma::zeros<arma::mat>(0, 2);
+    t.overlap_flags.init(n_actor, z_network.get_storage_mode());
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
+    t.overlap_mat = arma::zeros<arma::mat>(0, 2);
     out_degrees_nb.assign(n_actor + 1, 0);
     in_degrees_nb.assign(n_actor + 1, 0);
-    active_edges_nb_idx.assign(n_actor * n_actor, -1);
+    overlap_nb_idx.init(n_actor, z_network.get_storage_mode());
     
     for (int i = 1; i <= n_actor; ++i) { 
-        all_actors.push_back(i);
+        t.all_actors.push_back(i);
     } 
     initialize_overlap_counts();
 }
 
-XZ_class::XZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_):
+XZ_class::XZ_class(int n_actor_, bool directed_, arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_,
+                   StorageMode storage_, const arma::mat& group_labels_):
     n_actor(n_actor_),                             
-    z_network(n_actor_, directed_),             
+    z_network(n_actor_, directed_, storage_),             
     x_attribute(n_actor_, type_, scale_)        
 {
-    overlap.resize(n_actor + 1);
-    neighborhood.resize(n_actor + 1);
+    Topology& t = edit_topology();
+    t.overlap.resize(n_actor + 1);
+    t.neighborhood.resize(n_actor + 1);
     adj_list_nb.resize(n_actor + 1);
     adj_list_in_nb.resize(n_actor + 1);
-    overlap_bool_mat.assign(n_actor * n_actor, 0);
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
-
-    mat_to_map_vec(neighborhood_, n_actor, directed_, neighborhood, neighborhood, neighborhood_bool_mat);
-    mat_to_map_vec(overlap_, n_actor, directed_, overlap, overlap, overlap_bool_mat);
-    overlap_mat = overlap_;
     out_degrees_nb.assign(n_actor + 1, 0);
     in_degrees_nb.assign(n_actor + 1, 0);
-    active_edges_nb_idx.assign(n_actor * n_actor, -1);
+    overlap_nb_idx.init(n_actor, z_network.get_storage_mode());
     
     for (int i = 1; i <= n_actor; i++){
-        all_actors.push_back(i);
+        t.all_actors.push_back(i);
     } 
+    // The neighbourhood and overlap are then derived from the labels alone
+    if (group_labels_.n_elem > 0) {
+        set_group_labels(group_labels_);
+        return;
+    }
+    t.overlap_flags.init(n_actor, z_network.get_storage_mode());
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
+    mat_to_map_vec(neighborhood_, n_actor, directed_, t.neighborhood, t.neighborhood, t.neighborhood_flags);
+    mat_to_map_vec(overlap_, n_actor, directed_, t.overlap, t.overlap, t.overlap_flags);
+    t.overlap_mat = overlap_;
     initialize_overlap_counts();
 }
 
 XZ_class::XZ_class(int n_actor_, bool directed_, std::vector<std::vector<int>> neighborhood_,
                    std::vector<std::vector<int>> overlap_,
-                   arma::mat overlap_mat_, std::string type_, double scale_):
+                   arma::mat overlap_mat_, std::string type_, double scale_, StorageMode storage_):
     n_actor(n_actor_),                             
-    z_network(n_actor_, directed_),                
-    x_attribute(n_actor_, type_, scale_),         
-    overlap_mat(overlap_mat_)                     
+    z_network(n_actor_, directed_, storage_),                
+    x_attribute(n_actor_, type_, scale_)         
 {
-    overlap.resize(n_actor + 1);
-    neighborhood.resize(n_actor + 1);
+    Topology& t = edit_topology();
+    t.overlap_mat = overlap_mat_;
+    t.overlap.resize(n_actor + 1);
+    t.neighborhood.resize(n_actor + 1);
     adj_list_nb.resize(n_actor + 1);
     adj_list_in_nb.resize(n_actor + 1);
-    overlap_bool_mat.assign(n_actor * n_actor, 0);
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
+    t.overlap_flags.init(n_actor, z_network.get_storage_mode());
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
     out_degrees_nb.assign(n_actor + 1, 0);
     in_degrees_nb.assign(n_actor + 1, 0);
-    active_edges_nb_idx.assign(n_actor * n_actor, -1);
+    overlap_nb_idx.init(n_actor, z_network.get_storage_mode());
 
     for (int i = 1; i <= n_actor; i++){ 
         for(int neighbor : neighborhood_[i]) {
-            neighborhood[i].push_back(neighbor);
-            neighborhood_bool_mat[get_mat_idx(i, neighbor)] = 1;
+            t.neighborhood[i].push_back(neighbor);
+            t.neighborhood_flags.set(i, neighbor);
         }
         for(int over : overlap_[i]) {
-            overlap[i].push_back(over);
-            overlap_bool_mat[get_mat_idx(i, over)] = 1;
+            t.overlap[i].push_back(over);
+            t.overlap_flags.set(i, over);
         }
-        std::sort(neighborhood[i].begin(), neighborhood[i].end());
-        std::sort(overlap[i].begin(), overlap[i].end());
+        std::sort(t.neighborhood[i].begin(), t.neighborhood[i].end());
+        std::sort(t.overlap[i].begin(), t.overlap[i].end());
 
-        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], overlap[i]);
+        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], t.overlap[i]);
         if(z_network.directed){
-            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], overlap[i]);
+            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], t.overlap[i]);
         }
-        all_actors.push_back(i);
+        t.all_actors.push_back(i);
     }
     initialize_overlap_counts();
 }
 
 XZ_class::XZ_class(int n_actor_, bool directed_, arma::mat z_network_, arma::vec x_attribute_,
-                   arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_):
+                   arma::mat neighborhood_, arma::mat overlap_, std::string type_, double scale_,
+                   StorageMode storage_, const arma::mat& group_labels_):
     n_actor(n_actor_),                               
-    z_network(n_actor_, directed_, z_network_),      
+    z_network(n_actor_, directed_, z_network_, storage_),      
     x_attribute(n_actor_, x_attribute_, type_, scale_)
 {
-    overlap.resize(n_actor + 1);
-    neighborhood.resize(n_actor + 1);
+    Topology& t = edit_topology();
+    t.overlap.resize(n_actor + 1);
+    t.neighborhood.resize(n_actor + 1);
     adj_list_nb.resize(n_actor + 1);
     adj_list_in_nb.resize(n_actor + 1);
-    overlap_bool_mat.assign(n_actor * n_actor, 0);
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
+    overlap_nb_idx.init(n_actor, z_network.get_storage_mode());
+    if (group_labels_.n_elem > 0) {
+        for (int i = 1; i <= n_actor; i++){
+            t.all_actors.push_back(i);
+        }
+        set_group_labels(group_labels_);
+        return;
+    }
+    t.overlap_flags.init(n_actor, z_network.get_storage_mode());
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
 
-    mat_to_map_vec(neighborhood_, n_actor, directed_, neighborhood, neighborhood, neighborhood_bool_mat);
-    mat_to_map_vec(overlap_, n_actor, directed_, overlap, overlap, overlap_bool_mat);
-    overlap_mat = overlap_;
+    mat_to_map_vec(neighborhood_, n_actor, directed_, t.neighborhood, t.neighborhood, t.neighborhood_flags);
+    mat_to_map_vec(overlap_, n_actor, directed_, t.overlap, t.overlap, t.overlap_flags);
+    t.overlap_mat = overlap_;
     for (int i = 1; i <= n_actor; i++){
-        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], overlap[i]);
+        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], t.overlap[i]);
         if(z_network.directed){
-            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], overlap[i]);
+            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], t.overlap[i]);
         }
-        all_actors.push_back(i);
+        t.all_actors.push_back(i);
     }
     initialize_overlap_counts();
 }
@@ -361,38 +426,47 @@ XZ_class::XZ_class(int n_actor_, bool directed_, arma::mat z_network_, arma::vec
 void XZ_class::set_network_from_mat(int n_actor_, bool directed_, arma::mat mat){
     z_network.set_network_from_mat(n_actor_, directed_, mat); 
     for (int i = 1; i <= n_actor; i++){
-        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], overlap[i]);
+        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], topology_->overlap[i]);
         if(z_network.directed){
-            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], overlap[i]);
+            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], topology_->overlap[i]);
         } 
     }
     initialize_overlap_counts();
 }
 
 void XZ_class::initialize_overlap_counts() {
-    if (overlap_mat.is_empty() || overlap_mat.n_cols < 2) {
+    rebuild_partner_cache();
+    // Called from the constructors of XZ_class, where the y_sums of a derived
+    // XYZ_class are built afterwards by its own constructor
+    rebuild_neighbour_sums();
+    const arma::mat& overlap_dyads = topology_->overlap_mat;
+    if (overlap_dyads.is_empty() || overlap_dyads.n_cols < 2) {
         N_total_overlap = 0;
         N_1_overlap = 0;
+        active_edges_nb.clear();
+        inactive_edges_nb.clear();
         return;
     }
     int K = z_network.directed ? 1 : 2;
-    N_total_overlap = (int)overlap_mat.n_rows / K;
+    N_total_overlap = (int)overlap_dyads.n_rows / K;
     N_1_overlap = 0;
     out_degrees_nb.assign(n_actor + 1, 0);
     in_degrees_nb.assign(n_actor + 1, 0);
     active_edges_nb.clear();
-    active_edges_nb_idx.assign(n_actor * n_actor, -1);
+    inactive_edges_nb.clear();
+    overlap_nb_idx.init(n_actor, z_network.get_storage_mode());
     
-    for (int idx = 0; idx < (int)overlap_mat.n_rows; ++idx) {
-        int from = (int)overlap_mat(idx, 0);
-        int to = (int)overlap_mat(idx, 1);
+    for (int idx = 0; idx < (int)overlap_dyads.n_rows; ++idx) {
+        int from = (int)overlap_dyads(idx, 0);
+        int to = (int)overlap_dyads(idx, 1);
         if (from >= 1 && from <= z_network.get_n_actor() && to >= 1 && to <= z_network.get_n_actor()) {
             if (z_network.get_val(from, to)) {
                 N_1_overlap++;
                 out_degrees_nb[from]++;
                 in_degrees_nb[to]++;
-                active_edges_nb_idx[get_mat_idx(from, to)] = active_edges_nb.size();
-                active_edges_nb.push_back({from, to});
+                dyad_list_push(active_edges_nb, overlap_nb_idx, from, to);
+            } else if (overlap_nb_idx.get(from, to) == -1) {
+                dyad_list_push(inactive_edges_nb, overlap_nb_idx, from, to);
             }
         }
     }
@@ -402,10 +476,11 @@ void XZ_class::initialize_overlap_counts() {
 }
 
 void XZ_class::add_edge(int from, int to) {
+    invalidate_dyad_contexts();
     if(z_network.directed){
         if(!z_network.get_val(from, to)){
             z_network.add_edge(from, to);
-            if(overlap_bool_mat[get_mat_idx(from, to)]){
+            if(get_val_overlap_stored(from, to)){
                 N_1_overlap++;
                 out_degrees_nb[from]++;
                 in_degrees_nb[to]++;
@@ -413,14 +488,17 @@ void XZ_class::add_edge(int from, int to) {
                 l_nb.insert(std::lower_bound(l_nb.begin(), l_nb.end(), to), to);
                 auto& li_nb = adj_list_in_nb[to];
                 li_nb.insert(std::lower_bound(li_nb.begin(), li_nb.end(), from), from);
-                active_edges_nb_idx[get_mat_idx(from, to)] = active_edges_nb.size();
-                active_edges_nb.push_back({from, to});
+                dyad_list_remove(inactive_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_push(active_edges_nb, overlap_nb_idx, from, to);
+                edge_toggled(from, to, 1, true);
+            } else {
+                edge_toggled(from, to, 1, false);
             }
         }
     } else{
         if(!z_network.get_val(from, to)){
             z_network.add_edge(from, to);
-            if(overlap_bool_mat[get_mat_idx(from, to)]){
+            if(get_val_overlap_stored(from, to)){
                 N_1_overlap++;
                 out_degrees_nb[from]++;
                 out_degrees_nb[to]++;
@@ -430,44 +508,40 @@ void XZ_class::add_edge(int from, int to) {
                 l_f.insert(std::lower_bound(l_f.begin(), l_f.end(), to), to);
                 auto& l_t = adj_list_nb[to];
                 l_t.insert(std::lower_bound(l_t.begin(), l_t.end(), from), from);
-                active_edges_nb_idx[get_mat_idx(from, to)] = active_edges_nb.size();
-                active_edges_nb.push_back({from, to});
-                active_edges_nb_idx[get_mat_idx(to, from)] = active_edges_nb.size();
-                active_edges_nb.push_back({to, from});
+                dyad_list_remove(inactive_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_remove(inactive_edges_nb, overlap_nb_idx, to, from);
+                dyad_list_push(active_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_push(active_edges_nb, overlap_nb_idx, to, from);
+                edge_toggled(from, to, 1, true);
+            } else {
+                edge_toggled(from, to, 1, false);
             }
         }
     } 
 }
 
 void XZ_class::delete_edge(int from, int to) {
+    invalidate_dyad_contexts();
     if(z_network.directed){
         if(z_network.get_val(from, to)){
             z_network.delete_edge(from, to);
-            if(overlap_bool_mat[get_mat_idx(from, to)]){
+            if(get_val_overlap_stored(from, to)){
                 N_1_overlap--;
                 out_degrees_nb[from]--;
                 in_degrees_nb[to]--;
                 adj_list_nb[from].erase(std::remove(adj_list_nb[from].begin(), adj_list_nb[from].end(), to), adj_list_nb[from].end());
                 adj_list_in_nb[to].erase(std::remove(adj_list_in_nb[to].begin(), adj_list_in_nb[to].end(), from), adj_list_in_nb[to].end());
-                
-                int idx = active_edges_nb_idx[get_mat_idx(from, to)];
-                if (idx != -1) {
-                    // Swap-with-last removal. When the list has exactly one
-                    // element, last_edge == the element being removed, so the
-                    // re-assignment to idx is a no-op; the subsequent -1 write
-                    // below still leaves the index in the correct state.
-                    auto last_edge = active_edges_nb.back();
-                    active_edges_nb[idx] = last_edge;
-                    active_edges_nb_idx[get_mat_idx(last_edge.first, last_edge.second)] = idx;
-                    active_edges_nb.pop_back();
-                    active_edges_nb_idx[get_mat_idx(from, to)] = -1;
-                }
+                dyad_list_remove(active_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_push(inactive_edges_nb, overlap_nb_idx, from, to);
+                edge_toggled(from, to, -1, true);
+            } else {
+                edge_toggled(from, to, -1, false);
             }
         }
     } else{ 
         if(z_network.get_val(from, to)){
             z_network.delete_edge(from, to);
-            if(overlap_bool_mat[get_mat_idx(from, to)]){
+            if(get_val_overlap_stored(from, to)){
                 N_1_overlap--;
                 out_degrees_nb[from]--;
                 out_degrees_nb[to]--;
@@ -475,32 +549,65 @@ void XZ_class::delete_edge(int from, int to) {
                 in_degrees_nb[to]--;
                 adj_list_nb[from].erase(std::remove(adj_list_nb[from].begin(), adj_list_nb[from].end(), to), adj_list_nb[from].end());
                 adj_list_nb[to].erase(std::remove(adj_list_nb[to].begin(), adj_list_nb[to].end(), from), adj_list_nb[to].end());
-                
-                int idx1 = active_edges_nb_idx[get_mat_idx(from, to)];
-                if (idx1 != -1) {
-                    // Swap-with-last removal (see directed case above for
-                    // explanation of the safe single-element edge case).
-                    auto last_edge = active_edges_nb.back();
-                    active_edges_nb[idx1] = last_edge;
-                    active_edges_nb_idx[get_mat_idx(last_edge.first, last_edge.second)] = idx1;
-                    active_edges_nb.pop_back();
-                    active_edges_nb_idx[get_mat_idx(from, to)] = -1;
-                }
-                
-                int idx2 = active_edges_nb_idx[get_mat_idx(to, from)];
-                if (idx2 != -1) {
-                    // Swap-with-last removal (see directed case above).
-                    auto last_edge = active_edges_nb.back();
-                    active_edges_nb[idx2] = last_edge;
-                    active_edges_nb_idx[get_mat_idx(last_edge.first, last_edge.second)] = idx2;
-                    active_edges_nb.pop_back();
-                    active_edges_nb_idx[get_mat_idx(to, from)] = -1;
-                }
+                dyad_list_remove(active_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_remove(active_edges_nb, overlap_nb_idx, to, from);
+                dyad_list_push(inactive_edges_nb, overlap_nb_idx, from, to);
+                dyad_list_push(inactive_edges_nb, overlap_nb_idx, to, from);
+                edge_toggled(from, to, -1, true);
+            } else {
+                edge_toggled(from, to, -1, false);
             }
         }
     } 
 }
 
+// Starts maintaining the shared-partner counts of all edges (global) and/or of
+// all edges within the overlap (local); a cache that is not requested is dropped
+void XZ_class::enable_partner_cache(bool global, bool local) {
+    if (global) partner_cache.enable();
+    else partner_cache.disable();
+    if (local) partner_cache_nb.enable();
+    else partner_cache_nb.disable();
+    rebuild_partner_cache();
+}
+
+void XZ_class::rebuild_partner_cache() {
+    bool directed = z_network.directed;
+    if (partner_cache.enabled()) {
+        partner_cache.build(n_actor, directed,
+                            [&](int a) -> const std::vector<int>& { return z_network.adj_list[a]; },
+                            [&](int a) -> const std::vector<int>& { return directed ? z_network.adj_list_in[a] : z_network.adj_list[a]; });
+    }
+    if (partner_cache_nb.enabled()) {
+        partner_cache_nb.build(n_actor, directed,
+                               [&](int a) -> const std::vector<int>& { return adj_list_nb[a]; },
+                               [&](int a) -> const std::vector<int>& { return directed ? adj_list_in_nb[a] : adj_list_nb[a]; });
+    }
+}
+
+// Bookkeeping after the edge (from, to) was added (delta = 1) or deleted (delta = -1)
+void XZ_class::edge_toggled(int from, int to, int delta, bool in_overlap) {
+    toggle_attribute_sums(from, to, delta, in_overlap);
+    // Adding or removing a self-loop is rare and simply triggers a rebuild
+    if (from == to) {
+        rebuild_partner_cache();
+        return;
+    }
+    bool directed = z_network.directed;
+    if (partner_cache.enabled()) {
+        partner_cache.toggle(from, to, delta, directed,
+                             [&](int a) -> const std::vector<int>& { return z_network.adj_list[a]; },
+                             [&](int a) -> const std::vector<int>& { return directed ? z_network.adj_list_in[a] : z_network.adj_list[a]; },
+                             [&](int a, int b) { return z_network.has_edge(a, b); });
+    }
+    if (in_overlap && partner_cache_nb.enabled()) {
+        partner_cache_nb.toggle(from, to, delta, directed,
+                                [&](int a) -> const std::vector<int>& { return adj_list_nb[a]; },
+                                [&](int a) -> const std::vector<int>& { return directed ? adj_list_in_nb[a] : adj_list_nb[a]; },
+                                [&](int a, int b) { return std::binary_search(adj_list_nb[a].begin(), adj_list_nb[a].end(), b); });
+    }
+}
+
 double XZ_class::count_edges() const {
     return z_network.count_edges();
 }
@@ -521,50 +628,24 @@ size_t XZ_class::count_common_partners(unsigned int from, unsigned int to, std::
 }
   
 std::vector<int> XZ_class::get_common_partners_nb(unsigned int from,unsigned int to, std::string type) const {
-    if(type == "OTP"){
-        return(get_intersection_vec(adj_list_nb[from], adj_list_in_nb[to])); 
-    } else  if(type == "ISP"){ 
-        return(get_intersection_vec(adj_list_in_nb[from], adj_list_in_nb[to])); 
-    }else  if(type == "OSP"){ 
-        return(get_intersection_vec(adj_list_nb[from], adj_list_nb[to])); 
-    } 
-    else  if(type == "ITP"){
-        return(get_intersection_vec(adj_list_in_nb[from], adj_list_nb[to])); 
-    } 
+    if (type == "OTP") return get_common_partners_nb<PartnerType::OTP>(from, to);
+    if (type == "ISP") return get_common_partners_nb<PartnerType::ISP>(from, to);
+    if (type == "OSP") return get_common_partners_nb<PartnerType::OSP>(from, to);
+    if (type == "ITP") return get_common_partners_nb<PartnerType::ITP>(from, to);
     return std::vector<int>();
 }
 
 size_t XZ_class::count_common_partners_nb(unsigned int from, unsigned int to, std::string type) const {
-    const std::vector<int>* l1_ptr = nullptr;
-    if (type == "OTP") {
-        l1_ptr = &adj_list_nb[from];
-    } else if (type == "ISP") {
-        l1_ptr = &adj_list_in_nb[from];
-    } else if (type == "OSP") {
-        l1_ptr = &adj_list_nb[from];
-    } else if (type == "ITP") {
-        l1_ptr = &adj_list_in_nb[from];
-    } else {
-        return 0;
-    }
-
-    const std::vector<int>& l1 = *l1_ptr;
-    size_t count = 0;
-    if (type == "OTP") {
-        for (int k : l1) if (z_network.adj_mat[get_mat_idx(k, to)] && overlap_bool_mat[get_mat_idx(k, to)]) count++;
-    } else if (type == "ISP") {
-        for (int k : l1) if (z_network.adj_mat[get_mat_idx(k, to)] && overlap_bool_mat[get_mat_idx(k, to)]) count++;
-    } else if (type == "OSP") {
-        for (int k : l1) if (z_network.adj_mat[get_mat_idx(to, k)] && overlap_bool_mat[get_mat_idx(to, k)]) count++;
-    } else if (type == "ITP") {
-        for (int k : l1) if (z_network.adj_mat[get_mat_idx(to, k)] && overlap_bool_mat[get_mat_idx(to, k)]) count++;
-    }
-    return count;
+    if (type == "OTP") return count_common_partners_nb<PartnerType::OTP>(from, to);
+    if (type == "ISP") return count_common_partners_nb<PartnerType::ISP>(from, to);
+    if (type == "OSP") return count_common_partners_nb<PartnerType::OSP>(from, to);
+    if (type == "ITP") return count_common_partners_nb<PartnerType::ITP>(from, to);
+    return 0;
 }
 
 bool XZ_class::check_if_full_neighborhood() const {
     for(int i = 1; i <= n_actor; ++i) {
-        if(neighborhood[i].size() != static_cast<size_t>(n_actor)) {
+        if(topology_->neighborhood[i].size() != static_cast<size_t>(n_actor)) {
             return false; 
         }
     }
@@ -572,100 +653,343 @@ bool XZ_class::check_if_full_neighborhood() const {
 }
 
 void XZ_class::print() {
-    Rcout << "Network: Implemented as dense flat structures" << std::endl;
+    if (get_storage_mode() == StorageMode::sparse) {
+        Rcout << "Network: Implemented as sparse hashed structures" << std::endl;
+    } else {
+        Rcout << "Network: Implemented as dense flat structures" << std::endl;
+    }
+}
+
+DyadContext& XZ_class::dyad_context() const {
+#ifdef _OPENMP
+    return dyad_contexts[omp_get_thread_num()];
+#else
+    return dyad_contexts[0];
+#endif
+}
+
+void XZ_class::reserve_dyad_contexts(int n_threads) const {
+    if ((int)dyad_contexts.size() < n_threads) dyad_contexts.resize(n_threads);
+}
+
+Topology& XZ_class::edit_topology() {
+    if (topology_.use_count() > 1) topology_ = std::make_shared<Topology>(*topology_);
+    return *topology_;
+}
+
+void XZ_class::invalidate_dyad_contexts() {
+    for (DyadContext& context : dyad_contexts) context.invalidate();
 }
 
 void XZ_class::copy_from(const XZ_class& obj) {
+    invalidate_dyad_contexts();
     z_network = obj.z_network;
     x_attribute = obj.x_attribute;
-    neighborhood = obj.neighborhood;
-    overlap = obj.overlap;
+    topology_ = obj.topology_;
     adj_list_nb = obj.adj_list_nb;
     adj_list_in_nb = obj.adj_list_in_nb;
     out_degrees_nb = obj.out_degrees_nb;
     in_degrees_nb = obj.in_degrees_nb;
-    overlap_bool_mat = obj.overlap_bool_mat;
-    neighborhood_bool_mat = obj.neighborhood_bool_mat;
     n_actor = obj.n_actor;
-    overlap_mat = obj.overlap_mat;
-    all_actors = obj.all_actors;
     N_total_overlap = obj.N_total_overlap;
     N_1_overlap = obj.N_1_overlap;
-    // Copy the active-edge cache. These two members are derived from
-    // z_network + overlap_bool_mat and must stay in sync with them.
+    // Copy the (in)active-edge caches. These members are derived from
+    // z_network + topology().overlap_flags and must stay in sync with them.
     // Omitting them would cause delete_edge()'s swap-with-last logic to
     // use stale indices, silently corrupting the active-edge list.
     active_edges_nb = obj.active_edges_nb;
-    active_edges_nb_idx = obj.active_edges_nb_idx;
+    inactive_edges_nb = obj.inactive_edges_nb;
+    overlap_nb_idx = obj.overlap_nb_idx;
+    partner_cache = obj.partner_cache;
+    partner_cache_nb = obj.partner_cache_nb;
+    x_sums = obj.x_sums;
+    gw_tables = obj.gw_tables;
+}
+
+void XZ_class::build_neighbour_sums(NeighbourSums& sums, const Attribute& attr) const {
+    bool directed = z_network.directed;
+    sums.out.assign(n_actor + 1, 0.0);
+    sums.in.assign(n_actor + 1, 0.0);
+    sums.out_nb.assign(n_actor + 1, 0.0);
+    sums.in_nb.assign(n_actor + 1, 0.0);
+    for (int i = 1; i <= n_actor; i++) {
+        for (int k : z_network.adj_list[i]) sums.out[i] += attr.get_val(k);
+        for (int k : adj_list_nb[i]) sums.out_nb[i] += attr.get_val(k);
+        if (directed) {
+            for (int k : z_network.adj_list_in[i]) sums.in[i] += attr.get_val(k);
+            for (int k : adj_list_in_nb[i]) sums.in_nb[i] += attr.get_val(k);
+        } else {
+            sums.in[i] = sums.out[i];
+            sums.in_nb[i] = sums.out_nb[i];
+        }
+    }
+}
+
+// The edge (from, to) was added (sign = 1) or deleted (sign = -1)
+void XZ_class::toggle_neighbour_sums(NeighbourSums& sums, const Attribute& attr, int from, int to,
+                                     double sign, bool in_overlap) const {
+    if (sums.out.empty()) return;
+    double val_from = sign * attr.get_val(from);
+    double val_to = sign * attr.get_val(to);
+    if (z_network.directed) {
+        sums.out[from] += val_to;
+        sums.in[to] += val_from;
+        if (in_overlap) {
+            sums.out_nb[from] += val_to;
+            sums.in_nb[to] += val_from;
+        }
+    } else {
+        sums.out[from] += val_to;
+        sums.out[to] += val_from;
+        sums.in[from] = sums.out[from];
+        sums.in[to] = sums.out[to];
+        if (in_overlap) {
+            sums.out_nb[from] += val_to;
+            sums.out_nb[to] += val_from;
+            sums.in_nb[from] = sums.out_nb[from];
+            sums.in_nb[to] = sums.out_nb[to];
+        }
+    }
+}
+
+// The attribute of actor changed by delta (on the scale of get_val)
+void XZ_class::shift_neighbour_sums(NeighbourSums& sums, int actor, double delta) const {
+    if (sums.out.empty() || delta == 0.0) return;
+    if (z_network.directed) {
+        for (int k : z_network.adj_list[actor]) sums.in[k] += delta;
+        for (int k : z_network.adj_list_in[actor]) sums.out[k] += delta;
+        for (int k : adj_list_nb[actor]) sums.in_nb[k] += delta;
+        for (int k : adj_list_in_nb[actor]) sums.out_nb[k] += delta;
+    } else {
+        for (int k : z_network.adj_list[actor]) {
+            sums.out[k] += delta;
+            sums.in[k] = sums.out[k];
+        }
+        for (int k : adj_list_nb[actor]) {
+            sums.out_nb[k] += delta;
+            sums.in_nb[k] = sums.out_nb[k];
+        }
+    }
+}
+
+void XZ_class::set_x_value(int actor, double val) {
+    double old_val = x_attribute.get_val(actor);
+    x_attribute.set_attr_value(actor, val);
+    shift_neighbour_sums(x_sums, actor, x_attribute.get_val(actor) - old_val);
+}
+
+void XZ_class::rebuild_neighbour_sums() {
+    build_neighbour_sums(x_sums, x_attribute);
+}
+
+void XZ_class::toggle_attribute_sums(int from, int to, int delta, bool in_overlap) {
+    toggle_neighbour_sums(x_sums, x_attribute, from, to, delta, in_overlap);
+}
+
+// Builds the neighbourhood (pairs sharing a label in some column) and the
+// overlap (pairs with a common neighbour) from the labels. The membership tests
+// and the TNT draws then use the labels instead of per-dyad flags.
+void XZ_class::set_group_labels(const arma::mat& labels) {
+    Topology& t = edit_topology();
+    t.group_labels.clear();
+    t.overlap_labels.clear();
+    t.group_blocks.clear();
+    t.group_blocks_cum_pairs.clear();
+    if (labels.n_elem == 0) return;
+    if ((int)labels.n_rows != n_actor) {
+        Rcpp::stop("The group labels must have one row per actor.");
+    }
+    // Ordered pairs of the neighbourhood and of the overlap, only enumerated
+    // within the groups
+    std::vector<std::pair<int, int>> nb_pairs, overlap_pairs;
+    for (arma::uword c = 0; c < labels.n_cols; c++) {
+        // Map the labels of this column to 0, 1, ... and collect the members
+        std::vector<int> column(n_actor + 1, -1);
+        std::unordered_map<long long, int> label_idx;
+        std::vector<std::vector<int>> members;
+        for (int i = 1; i <= n_actor; i++) {
+            double val = labels(i - 1, c);
+            if (std::isnan(val)) continue;
+            auto it = label_idx.find((long long)val);
+            if (it == label_idx.end()) {
+                it = label_idx.emplace((long long)val, (int)members.size()).first;
+                members.emplace_back();
+            }
+            column[i] = it->second;
+            members[it->second].push_back(i);
+        }
+        t.group_labels.push_back(column);
+        for (const auto& block : members) {
+            for (int a : block) for (int b : block) if (a != b) nb_pairs.push_back({a, b});
+        }
+        if (labels.n_cols > 1) continue;
+        // One column: the overlap consists of the pairs within groups of at
+        // least three actors (a pair alone has no common neighbour)
+        double total_pairs = 0.0;
+        t.overlap_labels.assign(n_actor + 1, -1);
+        for (auto& block : members) {
+            if (block.size() < 3) continue;
+            for (int i : block) t.overlap_labels[i] = column[i];
+            for (int a : block) for (int b : block) if (a != b) overlap_pairs.push_back({a, b});
+            total_pairs += (double)block.size() * (block.size() - 1);
+            t.group_blocks.push_back(block);
+            t.group_blocks_cum_pairs.push_back(total_pairs);
+        }
+    }
+    std::sort(nb_pairs.begin(), nb_pairs.end());
+    nb_pairs.erase(std::unique(nb_pairs.begin(), nb_pairs.end()), nb_pairs.end());
+    if (labels.n_cols > 1) {
+        // Several columns: i and j overlap iff they have a common neighbour k,
+        // i.e., the off-diagonal pairs of every neighbour list
+        std::vector<std::vector<int>> nb_of(n_actor + 1);
+        for (const auto& d : nb_pairs) nb_of[d.first].push_back(d.second);
+        for (int k = 1; k <= n_actor; k++) {
+            for (int a : nb_of[k]) for (int b : nb_of[k]) if (a != b) overlap_pairs.push_back({a, b});
+        }
+    }
+    std::sort(overlap_pairs.begin(), overlap_pairs.end());
+    overlap_pairs.erase(std::unique(overlap_pairs.begin(), overlap_pairs.end()), overlap_pairs.end());
+    // Both relations are symmetric and the pairs are sorted, so the lists come
+    // out sorted and without duplicates
+    const bool directed = z_network.directed;
+    for (int i = 0; i <= n_actor; i++) {
+        t.neighborhood[i].clear();
+        t.overlap[i].clear();
+    }
+    for (const auto& d : nb_pairs) t.neighborhood[d.first].push_back(d.second);
+    for (const auto& d : overlap_pairs) t.overlap[d.first].push_back(d.second);
+    t.overlap_mat.set_size(overlap_pairs.size(), 2);
+    for (size_t d = 0; d < overlap_pairs.size(); d++) {
+        t.overlap_mat(d, 0) = overlap_pairs[d].first;
+        t.overlap_mat(d, 1) = overlap_pairs[d].second;
+    }
+    // Membership is answered by label comparisons, except for the overlap of
+    // several columns, which is flagged dyad by dyad
+    t.neighborhood_flags.init(n_actor, StorageMode::sparse);
+    t.overlap_flags.init(n_actor, StorageMode::sparse);
+    if (t.overlap_labels.empty()) {
+        for (const auto& d : overlap_pairs) t.overlap_flags.set(d.first, d.second);
+    }
+    for (int i = 1; i <= n_actor; i++) {
+        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], t.overlap[i]);
+        if (directed) {
+            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], t.overlap[i]);
+        }
+    }
+    initialize_overlap_counts();
+}
+
+// Draws an ordered dyad uniformly from the overlap
+void XZ_class::draw_overlap_dyad(int& from, int& to) const {
+    const Topology& t = *topology_;
+    if (t.group_blocks.empty()) {
+        int proposal_idx = (int)(rng.unif() * t.overlap_mat.n_rows);
+        from = t.overlap_mat(proposal_idx, 0);
+        to = t.overlap_mat(proposal_idx, 1);
+        return;
+    }
+    // The blocks of a single label column partition the overlap: pick a block
+    // proportional to its number of ordered pairs and a pair within it
+    double u = rng.unif() * t.group_blocks_cum_pairs.back();
+    size_t b = std::upper_bound(t.group_blocks_cum_pairs.begin(), t.group_blocks_cum_pairs.end(), u) - t.group_blocks_cum_pairs.begin();
+    if (b >= t.group_blocks.size()) b = t.group_blocks.size() - 1;
+    const std::vector<int>& block = t.group_blocks[b];
+    int n_block = (int)block.size();
+    int a = (int)(rng.unif() * n_block);
+    int c = (int)(rng.unif() * (n_block - 1));
+    if (c >= a) c++;
+    from = block[a];
+    to = block[c];
 }
 
 void XZ_class::set_neighborhood_from_mat(arma::mat mat) {
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
+    Topology& t = edit_topology();
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
     for (int i = 1; i <= n_actor; i++){
-        neighborhood[i].clear();
+        t.neighborhood[i].clear();
         for(int j = 1; j <= n_actor; j++) {
             if(mat(i-1, j-1) == 1) {
-                neighborhood[i].push_back(j);
-                neighborhood_bool_mat[get_mat_idx(i, j)] = 1;
+                t.neighborhood[i].push_back(j);
+                t.neighborhood_flags.set(i, j);
             }
         }
     }
 }
 
 void XZ_class::neighborhood_initialize() {
+    Topology& t = edit_topology();
     for (int i = 1; i <= n_actor; i++){
-        neighborhood[i].clear();
+        t.neighborhood[i].clear();
     }
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
 }
 
 void XZ_class::assign_neighborhood(const std::unordered_map< int, std::unordered_set<int>>& new_neighborhood) {
-    neighborhood_bool_mat.assign(n_actor * n_actor, 0);
+    Topology& t = edit_topology();
+    t.neighborhood_flags.init(n_actor, z_network.get_storage_mode());
     for (int i = 1; i <= n_actor; i++){
-        neighborhood[i].clear();
+        t.neighborhood[i].clear();
         for(int neighbor : new_neighborhood.at(i)) {
-            neighborhood[i].push_back(neighbor);
-            neighborhood_bool_mat[get_mat_idx(i, neighbor)] = 1;
+            t.neighborhood[i].push_back(neighbor);
+            t.neighborhood_flags.set(i, neighbor);
         }
-        std::sort(neighborhood[i].begin(), neighborhood[i].end());
+        std::sort(t.neighborhood[i].begin(), t.neighborhood[i].end());
     }
 }
 
 void XZ_class::change_neighborhood(int actor, std::unordered_set<int> new_neighborhood) {
-    for(int old_n : neighborhood[actor]) {
-        neighborhood_bool_mat[get_mat_idx(actor, old_n)] = 0;
+    Topology& t = edit_topology();
+    for(int old_n : t.neighborhood[actor]) {
+        t.neighborhood_flags.reset(actor, old_n);
     }
-    neighborhood[actor].clear();
+    t.neighborhood[actor].clear();
     for(int new_n : new_neighborhood) {
-        neighborhood[actor].push_back(new_n);
-        neighborhood_bool_mat[get_mat_idx(actor, new_n)] = 1;
+        t.neighborhood[actor].push_back(new_n);
+        t.neighborhood_flags.set(actor, new_n);
     }
-    std::sort(neighborhood[actor].begin(), neighborhood[actor].end());
+    std::sort(t.neighborhood[actor].begin(), t.neighborhood[actor].end());
 }
 
 // XYZ_class implementations
 void XYZ_class::print() {
-    Rcout << "XYZ Class: Implemented as dense flat structures" << std::endl;
+    if (get_storage_mode() == StorageMode::sparse) {
+        Rcout << "XYZ Class: Implemented as sparse hashed structures" << std::endl;
+    } else {
+        Rcout << "XYZ Class: Implemented as dense flat structures (bit-packed adjacency)" << std::endl;
+    }
 }
 
 void XYZ_class::set_info_arma(arma::vec x_attribute_, arma::vec y_attribute_, arma::mat z_network_) {
     x_attribute.attribute = x_attribute_;
     y_attribute.attribute = y_attribute_;
-    mat_to_map_vec(z_network_, n_actor, z_network.directed, z_network.adj_list, z_network.adj_list_in, z_network.adj_mat);
+    z_network.set_network_from_mat(n_actor, z_network.directed, z_network_);
     for (int i = 1; i <= n_actor; i++){
-        z_network.out_degrees[i] = z_network.adj_list[i].size();
-        if (z_network.directed) z_network.in_degrees[i] = z_network.adj_list_in[i].size();
-        else z_network.in_degrees[i] = z_network.out_degrees[i];
-        
-        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], overlap[i]);
+        adj_list_nb[i] = get_intersection_vec(z_network.adj_list[i], topology().overlap[i]);
         if(z_network.directed){
-            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], overlap[i]);
+            adj_list_in_nb[i] = get_intersection_vec(z_network.adj_list_in[i], topology().overlap[i]);
         } 
     }
     initialize_overlap_counts();
 }
 
+void XYZ_class::toggle_attribute_sums(int from, int to, int delta, bool in_overlap) {
+    XZ_class::toggle_attribute_sums(from, to, delta, in_overlap);
+    toggle_neighbour_sums(y_sums, y_attribute, from, to, delta, in_overlap);
+}
+
+void XYZ_class::set_y_value(int actor, double val) {
+    double old_val = y_attribute.get_val(actor);
+    y_attribute.set_attr_value(actor, val);
+    shift_neighbour_sums(y_sums, actor, y_attribute.get_val(actor) - old_val);
+}
+
+void XYZ_class::rebuild_neighbour_sums() {
+    XZ_class::rebuild_neighbour_sums();
+    build_neighbour_sums(y_sums, y_attribute);
+}
+
 void XYZ_class::copy_from(const XYZ_class& obj) {
     XZ_class::copy_from(obj);
     y_attribute = obj.y_attribute;
+    y_sums = obj.y_sums;
 }
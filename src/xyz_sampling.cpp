@@ -2,11 +2,15 @@
 #include <RcppArmadilloExtensions/sample.h>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <progress.hpp>
 #include <progress_bar.hpp>
 #include <limits>
+#include <cstring>
 #include "iglm/xyz_class.h"
 #include "iglm/extension_api.hpp"
+#include "iglm/degree_hessian.h"
+#include "iglm/weighted_gram.h"
 
 using xyz_ValidateFunction = double(*)(const XYZ_class &object,
                                     const int &actor_i,
@@ -14,6 +18,7 @@ using xyz_ValidateFunction = double(*)(const XYZ_class &object,
                                     const arma::mat &data,
                                     const double &type,
                                     const std::string &mode, const bool &is_full_neighborhood);
+using xyz_TermTable = iglm::TermTable;
 
 //[[Rcpp::depends(RcppProgress)]]
 
@@ -45,20 +50,31 @@ void iglm_print_registered_functions() {
 }
 
 
-std::vector<xyz_ValidateFunction> xyz_change_statistics_generate_new(std::vector<std::string> terms) {
-  // Res
-  std::vector<xyz_ValidateFunction> fns;
-  fns.reserve(terms.size());
-  // Get all the registered functions 
-  auto& reg = iglm::Registry::instance();
-  
-  for (size_t i = 0; i < terms.size(); ++i) {
-    const std::string& name = terms[i];
-    if (!reg.has(name)) {
-      throw std::invalid_argument("The statistic " + name + " does not exist");
-    }    fns.push_back(reg.get(name));
+xyz_TermTable xyz_change_statistics_generate_new(std::vector<std::string> terms) {
+  // Split the registered functions of the terms into per-mode tables
+  return iglm::Registry::instance().table(terms);
+}
+
+// The terms flagged SHARED_PARTNERS(_LOCAL) query the common partners of many
+// edges per proposal. During MCMC those counts are maintained incrementally
+// instead (see SharedPartnerCache).
+void xyz_enable_partner_cache(XYZ_class& object, const xyz_TermTable& functions) {
+  if (functions.shared_partners || functions.shared_partners_local) {
+    object.enable_partner_cache(functions.shared_partners, functions.shared_partners_local);
+  }
+}
+
+// The gw* terms weight partner counts and degrees geometrically with a decay
+// that is fixed for the whole run, so the weights are tabulated once per decay
+// before any term is evaluated (see GEOMETRIC_WEIGHTS).
+void xyz_prepare_geometric_weights(XYZ_class& object, const xyz_TermTable& functions,
+                                   const std::vector<arma::mat>& data_list) {
+  for (size_t i : functions.geometric_weights) {
+    if (data_list[i].n_elem == 0) {
+      Rcpp::stop("The term at position " + std::to_string(i + 1) + " needs its decay as data");
+    }
+    object.prepare_geometric_weights(data_list[i].at(0,0));
   }
-  return fns;
 }
 
 
@@ -89,14 +105,100 @@ inline void xyz_calculate_change_stats(arma::vec & change_stat,
                                        const XYZ_class &object,
                                        const std::vector<arma::mat> &data_list,
                                        const std::vector<double> &type_list,
-                                       const std::string &mode,
+                                       const iglm::Mode mode,
                                        const bool &is_full_neighborhood,
-                                       const std::vector<xyz_ValidateFunction> functions){
-  
-  // Rcout << functions.size() << std::endl;
-  for (size_t a = 0; a < functions.size(); ++a) {
-    change_stat[a] = functions[a](object, actor_i, actor_j, data_list[a], type_list[a], mode, is_full_neighborhood);
+                                       const xyz_TermTable &functions){
+  // Only the terms responding to this mode are called, all others are 0
+  change_stat.zeros();
+  // Quantities shared between terms are computed at most once for this dyad
+  object.dyad_context().begin(actor_i, actor_j);
+  const std::string& mode_str = iglm::mode_name(mode);
+  for (const auto& term : functions[mode]) {
+    change_stat[term.pos] = term.fn(object, actor_i, actor_j, data_list[term.pos], type_list[term.pos], mode_str, is_full_neighborhood);
+  }
+}
+
+// Change statistics of the n pairs (units_i[d], units_j[d]) at the current state,
+// written to rows row_start, ..., row_start + n - 1 of res_covs (one column per
+// term). Terms with a batched implementation fill their column span in one call,
+// all others fall back to the scalar function.
+inline void xyz_calculate_change_stats_block(arma::mat &res_covs,
+                                             const size_t row_start,
+                                             const int *units_i,
+                                             const int *units_j,
+                                             const size_t n,
+                                             const XYZ_class &object,
+                                             const std::vector<arma::mat> &data_list,
+                                             const std::vector<double> &type_list,
+                                             const iglm::Mode mode,
+                                             const bool &is_full_neighborhood,
+                                             const xyz_TermTable &functions){
+  if (n == 0) return;
+  res_covs.rows(row_start, row_start + n - 1).zeros();
+  const std::string& mode_str = iglm::mode_name(mode);
+  for (const auto& term : functions[mode]) {
+    double* out = res_covs.colptr(term.pos) + row_start;
+    if (term.batch_fn) {
+      term.batch_fn(object, units_i, units_j, n, data_list[term.pos], type_list[term.pos], mode_str, is_full_neighborhood, out);
+    } else {
+      for (size_t d = 0; d < n; ++d) {
+        object.dyad_context().begin(units_i[d], units_j[d]);
+        out[d] = term.fn(object, units_i[d], units_j[d], data_list[term.pos], type_list[term.pos], mode_str, is_full_neighborhood);
+      }
+    }
+  }
+}
+
+// Same for all pairs in units_i and units_j. With n_threads > 1 the rows are
+// split into blocks that are evaluated in parallel; every row is computed by
+// the same code as in the serial case, so the result does not depend on the
+// number of threads. Interrupts are checked between waves of blocks on the
+// main thread.
+inline void xyz_calculate_change_stats_batch(arma::mat &res_covs,
+                                             const size_t row_start,
+                                             const std::vector<int> &units_i,
+                                             const std::vector<int> &units_j,
+                                             const XYZ_class &object,
+                                             const std::vector<arma::mat> &data_list,
+                                             const std::vector<double> &type_list,
+                                             const iglm::Mode mode,
+                                             const bool &is_full_neighborhood,
+                                             const xyz_TermTable &functions,
+                                             const int n_threads = 1){
+  const size_t n = units_i.size();
+  const size_t block = 1024;
+#ifdef _OPENMP
+  if (n_threads > 1 && n > block) {
+    object.reserve_dyad_contexts(n_threads);
+    // The first block runs on the main thread, so that terms rejecting the
+    // network (Rcpp::stop) do so outside of the parallel region
+    xyz_calculate_change_stats_block(res_covs, row_start, units_i.data(), units_j.data(), block,
+                                     object, data_list, type_list, mode, is_full_neighborhood, functions);
+    const long n_blocks = (long)((n + block - 1) / block);
+    const long wave = 16L * n_threads;
+    bool failed = false;
+    for (long first = 1; first < n_blocks && !failed; first += wave) {
+      Rcpp::checkUserInterrupt();
+      const long last = std::min(n_blocks, first + wave);
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic)
+      for (long b = first; b < last; b++) {
+        const size_t start = (size_t)b * block;
+        const size_t len = std::min(block, n - start);
+        try {
+          xyz_calculate_change_stats_block(res_covs, row_start + start, units_i.data() + start, units_j.data() + start, len,
+                                           object, data_list, type_list, mode, is_full_neighborhood, functions);
+        } catch (...) {
+#pragma omp atomic write
+          failed = true;
+        }
+      }
+    }
+    if (failed) Rcpp::stop("The change statistics could not be evaluated in parallel, try n_threads = 1");
+    return;
   }
+#endif
+  xyz_calculate_change_stats_block(res_covs, row_start, units_i.data(), units_j.data(), n,
+                                   object, data_list, type_list, mode, is_full_neighborhood, functions);
 }
 
 
@@ -104,24 +206,25 @@ inline void xyz_calculate_change_stats(arma::vec & change_stat,
 arma::vec xyz_count_global_statistic( const XYZ_class &object,
                                       std::vector<arma::mat> &data_list,
                                       std::vector<double> &type_list,
-                                      std::vector<xyz_ValidateFunction> functions, 
+                                      xyz_TermTable functions, 
                                       std::string type_x, 
                                       std::string type_y, 
                                       double attr_x_scale, 
                                       double attr_y_scale) {
   // Generate empty network that we will fill as we go through all observed edges in the network
   XYZ_class alt_object(object.n_actor,object.z_network.directed, 
-                       object.neighborhood, 
-                       object.overlap,
-                       object.overlap_mat,
-                       type_x, type_y,attr_x_scale, attr_y_scale);
+                       object.topology().neighborhood, 
+                       object.topology().overlap,
+                       object.topology().overlap_mat,
+                       type_x, type_y,attr_x_scale, attr_y_scale,
+                       object.get_storage_mode());
   // XYZ_class alt_object(object.n_actor, object.z_network.directed, neighborhood);
   bool is_full_neighborhood = object.check_if_full_neighborhood();
   arma::vec res(functions.size());
   arma::vec change_stat(functions.size());
   // arma::vec tmp_row;
   std::vector<int> tmp_js;
-  std::string z = "z", x = "x", y = "y";
+  const iglm::Mode z = iglm::Mode::z, x = iglm::Mode::x, y = iglm::Mode::y;
   // Go through all actors i and switch them incrementally from 0 to 1
   for (int i = 1; i <= object.n_actor; i++){
     tmp_js = object.z_network.adj_list.at(i);
@@ -177,7 +280,7 @@ arma::vec xyz_count_global_statistic( const XYZ_class &object,
     // Rcout << object.x_attribute.attribute.size() << std::endl;
     // Rcout << object.x_attribute.attribute(i-1) << std::endl;
     
-    alt_object.x_attribute.set_attr_value(i, object.x_attribute.attribute.at(i-1));
+    alt_object.set_x_value(i, object.x_attribute.attribute.at(i-1));
     res +=change_stat*object.x_attribute.get_val(i);
   }
   // Rcout << "Y Attr" << std::endl;
@@ -194,7 +297,7 @@ arma::vec xyz_count_global_statistic( const XYZ_class &object,
                                functions);
     // Rcout << change_stat << std::endl;
     // Rcout << "Here" << std::endl;
-    alt_object.y_attribute.set_attr_value(i, object.y_attribute.attribute.at(i-1));
+    alt_object.set_y_value(i, object.y_attribute.attribute.at(i-1));
     res +=change_stat*object.y_attribute.get_val(i);
   }
   return(res);
@@ -202,6 +305,12 @@ arma::vec xyz_count_global_statistic( const XYZ_class &object,
 
 
 
+// Optional group labels (one column per label vector), empty if there are none
+arma::mat xyz_group_labels(const Rcpp::Nullable<Rcpp::NumericMatrix> &neighborhood_groups) {
+  if (neighborhood_groups.isNull()) return arma::mat();
+  return Rcpp::as<arma::mat>(neighborhood_groups.get());
+}
+
 // [[Rcpp::export]]
 arma::vec xyz_count_global(const arma::mat& z_network,
                            const arma::vec& x_attribute,
@@ -216,16 +325,19 @@ arma::vec xyz_count_global(const arma::mat& z_network,
                            std::string type_x, 
                            std::string type_y, 
                            double attr_x_scale, 
-                           double attr_y_scale) {
+                           double attr_y_scale,
+                           Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue) {
   // std::unordered_map< int, std::unordered_set<int>> edges;
   // // Convert the matrix to two unordered_map objects
   // edges = mat_to_map(network,1, n_actor);
-  XYZ_class object(n_actor,directed, x_attribute,y_attribute,z_network, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  XYZ_class object(n_actor,directed, x_attribute,y_attribute,z_network, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale,
+                   StorageMode::automatic, xyz_group_labels(neighborhood_groups));
   // object.initialize(z_network, x_attribute,y_attribute,neighborhood );
   // object.print();
-  std::vector<xyz_ValidateFunction> functions, functions_new;
+  xyz_TermTable functions;
   // functions = xyz_change_statistics_generate(terms);
   functions = xyz_change_statistics_generate_new(terms);
+  xyz_prepare_geometric_weights(object, functions, data_list);
   arma::vec at_zero;
   at_zero = xyz_eval_at_empty_network_new(terms, object);
   // Rcout << xyz_change_statistics_generate_new(terms) << std::endl;
@@ -258,6 +370,94 @@ arma::vec xyz_count_global(const arma::mat& z_network,
   return(global_stats);
 }
 
+// Change statistics of the pairs (units_i[d], units_j[d]) at the observed state
+// for one mode, so that the tests can compare the per-mode term tables
+// ("dispatch") against calling every term of the model ("full") and against
+// the batched evaluation ("batch")
+List xyz_change_stats_modes(const arma::mat& z_network,
+                            const arma::vec& x_attribute,
+                            const arma::vec& y_attribute,
+                            const arma::mat& neighborhood,
+                            const arma::mat& overlap,
+                            bool directed,
+                            std::vector<std::string> terms,
+                            int n_actor,
+                            std::vector<arma::mat> &data_list,
+                            std::vector<double> &type_list,
+                            std::string type_x,
+                            std::string type_y,
+                            double attr_x_scale,
+                            double attr_y_scale,
+                            std::string mode,
+                            std::vector<int> units_i,
+                            std::vector<int> units_j) {
+  iglm::Mode m;
+  if (mode == "z") m = iglm::Mode::z;
+  else if (mode == "x") m = iglm::Mode::x;
+  else if (mode == "y") m = iglm::Mode::y;
+  else Rcpp::stop("The mode must be 'z', 'x' or 'y'.");
+  if (units_i.size() != units_j.size()) {
+    Rcpp::stop("units_i and units_j must have the same length");
+  }
+  XYZ_class object(n_actor,directed, x_attribute,y_attribute,z_network, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  xyz_TermTable functions = xyz_change_statistics_generate_new(terms);
+  xyz_prepare_geometric_weights(object, functions, data_list);
+  bool is_full_neighborhood = object.check_if_full_neighborhood();
+  auto& reg = iglm::Registry::instance();
+  const std::string& mode_str = iglm::mode_name(m);
+
+  const size_t n = units_i.size();
+  arma::mat dispatch(n, terms.size()), full(n, terms.size()), batch(n, terms.size());
+  arma::vec change_stat(terms.size());
+  for (size_t d = 0; d < n; d++) {
+    xyz_calculate_change_stats(change_stat, units_i[d], units_j[d], object, data_list, type_list,
+                               m, is_full_neighborhood, functions);
+    dispatch.row(d) = change_stat.t();
+    object.dyad_context().begin(units_i[d], units_j[d]);
+    for (size_t t = 0; t < terms.size(); t++) {
+      full(d, t) = reg.get(terms[t])(object, units_i[d], units_j[d], data_list[t], type_list[t],
+                                     mode_str, is_full_neighborhood);
+    }
+  }
+  xyz_calculate_change_stats_batch(batch, 0, units_i, units_j, object, data_list, type_list,
+                                   m, is_full_neighborhood, functions);
+  return List::create(Named("dispatch") = dispatch,
+                      Named("full") = full,
+                      Named("batch") = batch);
+}
+
+// A state dependent term with a scalar and a batched implementation that is
+// registered through the C callable of extension packages (see
+// xyz_register_batch_test_term): the dyadic covariate weighted by 1 + z_ji
+static double xyz_stat_batch_abi_test(const XYZ_class &object, const int &unit_i, const int &unit_j,
+                                      const arma::mat &data, const double &type,
+                                      const std::string &mode, const bool &is_full_neighborhood) {
+  if (mode != "z") return 0.0;
+  return data.at(unit_i - 1, unit_j - 1) * (1 + object.z_network.get_val(unit_j, unit_i));
+}
+
+static void xyz_stat_batch_abi_test_batch(const XYZ_class &object, const int *units_i, const int *units_j,
+                                          const size_t &n, const arma::mat &data, const double &type,
+                                          const std::string &mode, const bool &is_full_neighborhood,
+                                          double *out) {
+  for (size_t d = 0; d < n; d++) {
+    out[d] = mode != "z" ? 0.0 :
+      data.at(units_i[d] - 1, units_j[d] - 1) * (1 + object.z_network.get_val(units_j[d], units_i[d]));
+  }
+}
+
+// Registers the term "batch_abi_test" the way an extension package does
+// (EFFECT_REGISTER_BATCH outside of iglm), so that the tests can compare its
+// batched and scalar change statistics
+bool xyz_register_batch_test_term() {
+  typedef void (*reg_batch_fn_t)(const char*, void*, void*, const char*, double, unsigned);
+  reg_batch_fn_t reg = (reg_batch_fn_t)R_GetCCallable("iglm", "iglm_register_term_batch_C");
+  if (!reg) Rcpp::stop("iglm_register_term_batch_C is not registered");
+  reg("batch_abi_test", (void*)&xyz_stat_batch_abi_test, (void*)&xyz_stat_batch_abi_test_batch,
+      "batch_abi_test", 0, iglm::MODE_Z);
+  return iglm::Registry::instance().has("batch_abi_test");
+}
+
 arma::vec xyz_count_global_internal(const XYZ_class& object,
                                     std::vector<std::string> terms,
                                     int n_actor,
@@ -267,7 +467,7 @@ arma::vec xyz_count_global_internal(const XYZ_class& object,
                                     std::string type_y, 
                                     double attr_x_scale, 
                                     double attr_y_scale) {
-  std::vector<xyz_ValidateFunction> functions;
+  xyz_TermTable functions;
   functions = xyz_change_statistics_generate_new(terms);
   arma::vec at_zero;
   // Rcout << "at_zero" << std::endl;
@@ -293,10 +493,10 @@ void xyz_simulate_network_consecutive_mh( const arma::vec &coef,
                                           const std::vector<arma::mat> &data_list,
                                           const std::vector<double> &type_list,
                                           const bool &is_full_neighborhood,
-                                          const std::vector<xyz_ValidateFunction> &functions,
+                                          const xyz_TermTable &functions,
                                           arma::vec &global_stats, 
                                           const double offset_nonoverlap) {
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   arma::vec change_stat(functions.size());
   arma::vec tmp_vec, tmp_stat;
   
@@ -324,7 +524,7 @@ void xyz_simulate_network_consecutive_mh( const arma::vec &coef,
         
         double HR_val = 1.0 / (1.0 + std::exp(-arma::dot(coef, tmp_stat) - offset_nonoverlap));
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           if(object.z_network.get_val(i,j) == 0){
             object.add_edge(i,j);
             global_stats += tmp_stat;
@@ -356,7 +556,7 @@ void xyz_simulate_network_consecutive_mh( const arma::vec &coef,
         tmp_stat=change_stat;
         double HR_val = 1.0 / (1.0 + std::exp(-arma::dot(coef, tmp_stat) - offset_nonoverlap));
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           if(object.z_network.get_val(i,j) == 0){
             object.add_edge(i,j);
             global_stats += tmp_stat;
@@ -380,10 +580,10 @@ void xyz_simulate_network_consecutive_degrees_mh( const arma::vec &coef_nondegre
                                                   const std::vector<arma::mat> &data_list,
                                                   const std::vector<double> &type_list,
                                                   const bool &is_full_neighborhood,
-                                                  const std::vector<xyz_ValidateFunction> &functions,
+                                                  const xyz_TermTable &functions,
                                                   arma::vec &global_stats, 
                                                   const double offset_nonoverlap) {
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   arma::vec change_stat(functions.size());
   
   // Go through a loop for all actor changes
@@ -412,7 +612,7 @@ void xyz_simulate_network_consecutive_degrees_mh( const arma::vec &coef_nondegre
         // 3. Calculate the Hastings Ratios by exp(delta(tmp_entry)*coef)
         double HR_val = 1.0 / (1.0 + std::exp(-arma::dot(coef_nondegrees, change_stat) - offset_nonoverlap - (coef_degrees_i + coef_degrees(j-1+object.n_actor))));
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           if(object.z_network.get_val(i,j) == 0){
             object.add_edge(i,j);
             global_stats += change_stat;
@@ -444,7 +644,7 @@ void xyz_simulate_network_consecutive_degrees_mh( const arma::vec &coef_nondegre
         // 3. Calculate the Hastings Ratios by exp(delta(tmp_entry)*coef)
         double HR_val = 1.0 / (1.0 + std::exp(-arma::dot(coef_nondegrees, change_stat) - offset_nonoverlap - (coef_degrees_i + coef_degrees(j-1))));
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           if(object.z_network.get_val(i,j) == 0){
             object.add_edge(i,j);
             global_stats += change_stat;
@@ -466,10 +666,10 @@ void xyz_simulate_network_consecutive_mh_directed(const arma::vec &coef,
                                                   const std::vector<arma::mat> &data_list,
                                                   const std::vector<double> &type_list,
                                                   const bool &is_full_neighborhood,
-                                                  const std::vector<xyz_ValidateFunction> &functions,
+                                                  const xyz_TermTable &functions,
                                                   arma::vec &global_stats, 
                                                   const double offset_nonoverlap) {
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   
   arma::vec change_stat_10(functions.size());
   arma::vec change_stat_01(functions.size());
@@ -518,7 +718,7 @@ void xyz_simulate_network_consecutive_mh_directed(const arma::vec &coef,
       P_10 /= sum_P;
       P_01 /= sum_P;
       
-      double r = R::unif_rand();
+      double r = object.rng.unif();
       
       if (r < P_00) {
         // stay (0,0)
@@ -543,10 +743,10 @@ void xyz_simulate_network_consecutive_degrees_mh_directed(const arma::vec &coef_
                                                           const std::vector<arma::mat> &data_list,
                                                           const std::vector<double> &type_list,
                                                           const bool &is_full_neighborhood,
-                                                          const std::vector<xyz_ValidateFunction> &functions,
+                                                          const xyz_TermTable &functions,
                                                           arma::vec &global_stats, 
                                                           const double offset_nonoverlap) {
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   
   arma::vec change_stat_10(functions.size());
   arma::vec change_stat_01(functions.size());
@@ -596,7 +796,7 @@ void xyz_simulate_network_consecutive_degrees_mh_directed(const arma::vec &coef_
       P_10 /= sum_P;
       P_01 /= sum_P;
       
-      double r = R::unif_rand();
+      double r = object.rng.unif();
       
       if (r < P_00) {
         // stay (0,0)
@@ -621,19 +821,19 @@ void xyz_simulate_network_mh(const arma::vec coef,
                              const std::vector<arma::mat> &data_list,
                              const std::vector<double> &type_list,
                              const bool &is_full_neighborhood,
-                             const std::vector<xyz_ValidateFunction> &functions,
+                             const xyz_TermTable &functions,
                              arma::vec &global_stats, 
                              const bool tnt = true) {
-  if (n_proposals == 0 || object.overlap_mat.n_rows == 0) return;
+  if (n_proposals == 0 || object.topology().overlap_mat.n_rows == 0) return;
   
   int proposed_change;
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   arma::mat HR;
   arma::vec change_stat(functions.size());
   
   arma::vec tmp_stat;
   int multiplier = 1;
-  int tmp_i, tmp_j, proposal_idx, tmp_switch; 
+  int tmp_i, tmp_j, tmp_switch; 
   
   // // Track strictly overlap dyads
   // int K = object.z_network.directed ? 1 : 2;
@@ -656,10 +856,10 @@ void xyz_simulate_network_mh(const arma::vec coef,
     
     if (tnt) {
       double p_drop_forward = (object.N_1_overlap == 0) ? 0.0 : ((N_0_overlap == 0) ? 1.0 : 0.5);
-      bool propose_drop = R::unif_rand() < p_drop_forward;
+      bool propose_drop = object.rng.unif() < p_drop_forward;
       
       if (propose_drop) {
-        int target_edge_idx = (int)(R::unif_rand() * object.active_edges_nb.size());
+        int target_edge_idx = (int)(object.rng.unif() * object.active_edges_nb.size());
         auto edge = object.active_edges_nb[target_edge_idx];
         tmp_i = edge.first;
         tmp_j = edge.second;
@@ -668,21 +868,18 @@ void xyz_simulate_network_mh(const arma::vec coef,
         hr_adj = std::log(p_add_reverse / p_drop_forward) + std::log((double)object.N_1_overlap / (double)(N_0_overlap + 1));
         
       } else {
-        // Rejection sample strictly a non-edge within the overlap
-        do {
-          proposal_idx = (int)(R::unif_rand() * object.overlap_mat.n_rows);
-          tmp_i = object.overlap_mat(proposal_idx, 0);
-          tmp_j = object.overlap_mat(proposal_idx, 1);
-        } while (object.z_network.get_val(tmp_i, tmp_j));
+        // Draw a non-edge within the overlap uniformly (constant time)
+        int target_dyad_idx = (int)(object.rng.unif() * object.inactive_edges_nb.size());
+        auto dyad = object.inactive_edges_nb[target_dyad_idx];
+        tmp_i = dyad.first;
+        tmp_j = dyad.second;
         
         double p_drop_reverse = (object.N_1_overlap + 1 == 0) ? 0.0 : ((N_0_overlap - 1 == 0) ? 1.0 : 0.5);
         double p_add_forward = 1.0 - p_drop_forward;
         hr_adj = std::log(p_drop_reverse / p_add_forward) + std::log((double)N_0_overlap / (double)(object.N_1_overlap + 1));
       }
     } else {
-      proposal_idx = (int)(R::unif_rand() * object.overlap_mat.n_rows);
-      tmp_i = object.overlap_mat(proposal_idx, 0);
-      tmp_j = object.overlap_mat(proposal_idx, 1);
+      object.draw_overlap_dyad(tmp_i, tmp_j);
       hr_adj = 0.0;
     }
     
@@ -710,7 +907,7 @@ void xyz_simulate_network_mh(const arma::vec coef,
     // Non-overlap offset removed; mathematically impossible to propose outside overlap
     double HR_val = std::exp(arma::dot(coef, tmp_stat) + hr_adj);
     
-    if (R::unif_rand() < HR_val) {
+    if (object.rng.unif() < HR_val) {
       // accepted_proposals++;
       global_stats += tmp_stat;
       if (proposed_change == 0) {
@@ -732,19 +929,19 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
                                      const std::vector<arma::mat> &data_list,
                                      const std::vector<double> &type_list,
                                      const bool &is_full_neighborhood,
-                                     const std::vector<xyz_ValidateFunction> &functions,
+                                     const xyz_TermTable &functions,
                                      arma::vec &global_stats, 
                                      const bool tnt = true) {
-  if (n_proposals == 0 || object.overlap_mat.n_rows == 0) return;
+  if (n_proposals == 0 || object.topology().overlap_mat.n_rows == 0) return;
   
   int proposed_change;
-  std::string z = "z";
+  const iglm::Mode z = iglm::Mode::z;
   arma::mat HR;
   arma::vec change_stat(functions.size());
   
   arma::vec tmp_stat;
   int multiplier = 1;
-  int tmp_i, tmp_j, proposal_idx, tmp_switch; 
+  int tmp_i, tmp_j, tmp_switch; 
   
   // int K = object.z_network.directed ? 1 : 2;
   // int N_total_overlap = object.overlap_mat.n_rows / K;
@@ -765,10 +962,10 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
     
     if (tnt) {
       double p_drop_forward = (object.N_1_overlap == 0) ? 0.0 : ((N_0_overlap == 0) ? 1.0 : 0.5);
-      bool propose_drop = R::unif_rand() < p_drop_forward;
+      bool propose_drop = object.rng.unif() < p_drop_forward;
       
       if (propose_drop) {
-        int target_edge_idx = (int)(R::unif_rand() * object.active_edges_nb.size());
+        int target_edge_idx = (int)(object.rng.unif() * object.active_edges_nb.size());
         auto edge = object.active_edges_nb[target_edge_idx];
         tmp_i = edge.first;
         tmp_j = edge.second;
@@ -777,20 +974,18 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
         hr_adj = std::log(p_add_reverse / p_drop_forward) + std::log((double)object.N_1_overlap / (double)(N_0_overlap + 1));
         
       } else {
-        do {
-          proposal_idx = (int)(R::unif_rand() * object.overlap_mat.n_rows);
-          tmp_i = object.overlap_mat(proposal_idx, 0);
-          tmp_j = object.overlap_mat(proposal_idx, 1);
-        } while (object.z_network.get_val(tmp_i, tmp_j));
+        // Draw a non-edge within the overlap uniformly (constant time)
+        int target_dyad_idx = (int)(object.rng.unif() * object.inactive_edges_nb.size());
+        auto dyad = object.inactive_edges_nb[target_dyad_idx];
+        tmp_i = dyad.first;
+        tmp_j = dyad.second;
         
         double p_drop_reverse = (object.N_1_overlap + 1 == 0) ? 0.0 : ((N_0_overlap - 1 == 0) ? 1.0 : 0.5);
         double p_add_forward = 1.0 - p_drop_forward;
         hr_adj = std::log(p_drop_reverse / p_add_forward) + std::log((double)N_0_overlap / (double)(object.N_1_overlap + 1));
       }
     } else {
-      proposal_idx = (int)(R::unif_rand() * object.overlap_mat.n_rows);
-      tmp_i = object.overlap_mat(proposal_idx, 0);
-      tmp_j = object.overlap_mat(proposal_idx, 1);
+      object.draw_overlap_dyad(tmp_i, tmp_j);
       hr_adj = 0.0;
     } 
     
@@ -818,7 +1013,7 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
     if (object.z_network.directed) {
       double HR_val = std::exp(arma::dot(coef_nondegrees, tmp_stat) + hr_adj + 
         multiplier * (coef_degrees(tmp_i - 1) + coef_degrees(tmp_j - 1 + object.n_actor)));
-      if (R::unif_rand() < HR_val) {
+      if (object.rng.unif() < HR_val) {
         global_stats += tmp_stat;
         if (proposed_change == 0) object.delete_edge(tmp_i, tmp_j);
         if (proposed_change == 1) object.add_edge(tmp_i, tmp_j);
@@ -826,7 +1021,7 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
     } else {
       double HR_val = std::exp(arma::dot(coef_nondegrees, tmp_stat) + hr_adj + 
         multiplier * (coef_degrees(tmp_i - 1) + coef_degrees(tmp_j - 1)));  
-      if (R::unif_rand() < HR_val) {
+      if (object.rng.unif() < HR_val) {
         global_stats += tmp_stat;
         if (proposed_change == 0) object.delete_edge(tmp_i, tmp_j);
         if (proposed_change == 1) object.add_edge(tmp_i, tmp_j);
@@ -837,15 +1032,64 @@ void xyz_simulate_network_mh_degrees(const arma::vec coef_nondegrees,
   // Rcpp::Rcout << "MH Degrees Sampler Acceptance Rate: " << (double)accepted_proposals / n_proposals << "\n";
 }
 
+// Draws Z_overlapping | X, Y in a single pass if all terms are dyad independent.
+// Every dyad of the overlap is then an independent Bernoulli variable, so the
+// change statistics of all dyads are evaluated in one batch and each dyad is
+// drawn from its conditional probability, irrespective of the current state.
+void xyz_simulate_network_independent(const arma::vec &coef,
+                                      const arma::vec &coef_degrees,
+                                      const bool degrees,
+                                      XYZ_class &object,
+                                      const std::vector<arma::mat> &data_list,
+                                      const std::vector<double> &type_list,
+                                      const bool &is_full_neighborhood,
+                                      const xyz_TermTable &functions,
+                                      arma::vec &global_stats) {
+  const arma::mat &overlap_mat = object.topology().overlap_mat;
+  if (overlap_mat.n_rows == 0) return;
+  const bool directed = object.z_network.directed;
+  std::vector<int> units_i, units_j;
+  units_i.reserve(overlap_mat.n_rows);
+  units_j.reserve(overlap_mat.n_rows);
+  for (arma::uword r = 0; r < overlap_mat.n_rows; r++) {
+    int from = (int)overlap_mat(r, 0);
+    int to = (int)overlap_mat(r, 1);
+    // Undirected overlaps hold both orientations of every dyad
+    if (from == to || (!directed && from > to)) continue;
+    units_i.push_back(from);
+    units_j.push_back(to);
+  }
+  arma::mat change_stats(units_i.size(), functions.size());
+  xyz_calculate_change_stats_batch(change_stats, 0, units_i, units_j, object, data_list, type_list,
+                                   iglm::Mode::z, is_full_neighborhood, functions);
+  arma::vec eta = change_stats * coef;
+  
+  for (size_t d = 0; d < units_i.size(); d++) {
+    int i = units_i[d], j = units_j[d];
+    if (degrees) {
+      eta.at(d) += coef_degrees(i - 1) + coef_degrees(j - 1 + (directed ? object.n_actor : 0));
+    }
+    bool edge = object.rng.unif() < 1.0 / (1.0 + std::exp(-eta.at(d)));
+    bool present = object.z_network.get_val(i, j);
+    if (edge && !present) {
+      object.add_edge(i, j);
+      global_stats += change_stats.row(d).t();
+    } else if (!edge && present) {
+      object.delete_edge(i, j);
+      global_stats -= change_stats.row(d).t();
+    }
+  }
+}
+
 void xyz_simulate_attribute_mh( const arma::vec coef,
                                 XYZ_class &object,
                                 const int &n_proposals,
                                 const  std::vector<arma::mat> &data_list,
                                 const std::vector<double> &type_list,
                                 const bool &is_full_neighborhood,
-                                const std::vector<xyz_ValidateFunction> &functions,
+                                const xyz_TermTable &functions,
                                 arma::vec &global_stats, 
-                                const std::string type) {
+                                const iglm::Mode mode) {
   if(n_proposals == 0){
     return;
   }
@@ -860,17 +1104,17 @@ void xyz_simulate_attribute_mh( const arma::vec coef,
   // Go through a loop for each proposed change
   for(int a = 0; a <=(n_proposals-1); a ++ ) {
     // Here we pick the random entry
-    tmp_i = (int)(R::unif_rand() * object.n_actor) + 1;
+    tmp_i = (int)(object.rng.unif() * object.n_actor) + 1;
     // Here we calculate the change stat from turning y_i from 0 to 1
     xyz_calculate_change_stats(change_stat, tmp_i,
                                tmp_i,
                                object,
                                data_list,
                                type_list,
-                               type,
+                               mode,
                                is_full_neighborhood,
                                functions);
-    if(type == "x"){
+    if(mode == iglm::Mode::x){
       if(object.x_attribute.type == "binomial"){
         if(object.x_attribute.get_val(tmp_i)){
           proposed_change = 0;
@@ -884,30 +1128,30 @@ void xyz_simulate_attribute_mh( const arma::vec coef,
         double HR_val = std::exp(arma::dot(coef, tmp_stat));
         
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           global_stats += (multiplier * 1.0) * change_stat;
           // Here we modify the network
           if(proposed_change == 0){
-            object.x_attribute.set_attr_0(tmp_i);  
+            object.set_x_value(tmp_i, 0);  
           } else {
-            object.x_attribute.set_attr_1(tmp_i);
+            object.set_x_value(tmp_i, 1);
           }
         }
       }
       if(object.x_attribute.type == "poisson"){
         double safe_eta = std::min(arma::dot(coef, change_stat), MAX_LOG_RATE);
-        double tmp_val = R::rpois(exp(safe_eta)); 
+        double tmp_val = object.rng.poisson(exp(safe_eta)); 
         global_stats += (tmp_val - object.x_attribute.get_val_no_scale(tmp_i)) * change_stat;
-        object.x_attribute.set_attr_value(tmp_i, tmp_val);  
+        object.set_x_value(tmp_i, tmp_val);  
       }
       if(object.x_attribute.type == "normal"){
         double HR_val = arma::dot(coef, change_stat);
-        double tmp_val = R::rnorm(HR_val, sqrt(object.x_attribute.scale)); 
+        double tmp_val = object.rng.normal(HR_val, sqrt(object.x_attribute.scale)); 
         global_stats += (tmp_val- object.x_attribute.get_val_no_scale(tmp_i))/object.x_attribute.scale * change_stat;
-        object.x_attribute.set_attr_value(tmp_i, tmp_val);  
+        object.set_x_value(tmp_i, tmp_val);  
       }
     }
-    if(type == "y"){
+    if(mode == iglm::Mode::y){
       if(object.y_attribute.type == "binomial"){
         if(object.y_attribute.get_val(tmp_i)){
           proposed_change = 0;
@@ -920,27 +1164,27 @@ void xyz_simulate_attribute_mh( const arma::vec coef,
         tmp_stat=change_stat*multiplier;
         double HR_val = std::exp(arma::dot(coef, tmp_stat));
         // 4. Step: Sample a random number between 0 and 1, accept if it is > HR
-        if(R::unif_rand() < HR_val){
+        if(object.rng.unif() < HR_val){
           global_stats += (multiplier * 1.0 / object.y_attribute.scale) * change_stat;
           // Here we modify the network
           if(proposed_change == 0){
-            object.y_attribute.set_attr_0(tmp_i);  
+            object.set_y_value(tmp_i, 0);  
           } else {
-            object.y_attribute.set_attr_1(tmp_i);
+            object.set_y_value(tmp_i, 1);
           }
         }
       }
       if(object.y_attribute.type == "poisson"){
         double safe_eta = std::min(arma::dot(coef, change_stat), MAX_LOG_RATE);
-        double tmp_val = R::rpois(exp(safe_eta)); 
+        double tmp_val = object.rng.poisson(exp(safe_eta)); 
         global_stats +=  (tmp_val - object.y_attribute.get_val_no_scale(tmp_i)) * change_stat;
-        object.y_attribute.set_attr_value(tmp_i, tmp_val);  
+        object.set_y_value(tmp_i, tmp_val);  
       }
       if(object.y_attribute.type == "normal"){
         double HR_val = arma::dot(coef, change_stat);
-        double tmp_val = R::rnorm(HR_val, sqrt(object.y_attribute.scale)); 
+        double tmp_val = object.rng.normal(HR_val, sqrt(object.y_attribute.scale)); 
         global_stats += (tmp_val - object.y_attribute.get_val_no_scale(tmp_i))/object.y_attribute.scale * change_stat;
-        object.y_attribute.set_attr_value(tmp_i, tmp_val);  
+        object.set_y_value(tmp_i, tmp_val);  
       }
       
     }
@@ -951,6 +1195,85 @@ void xyz_simulate_attribute_mh( const arma::vec coef,
   }
 }
 
+// One sweep of the Gibbs sampler: x | y, z (unless fix_x), y | x, z and
+// z | x, y (unless fix_z), keeping global_stats up to date
+void xyz_simulate_sweep(XYZ_class & object,
+                        const arma::vec& coef,
+                        const arma::vec& coef_degrees,
+                        const std::vector<arma::mat>& data_list,
+                        const std::vector<double>& type_list,
+                        arma::vec & global_stats,
+                        const int n_proposals_x,
+                        const int n_proposals_y,
+                        const int n_proposals_z,
+                        const bool is_full_neighborhood,
+                        const xyz_TermTable &functions,
+                        const bool degrees, 
+                        const double offset_nonoverlap, 
+                        const bool fix_x, 
+                        const bool fix_z, 
+                        const bool nonoverlap_random,
+                        const bool tnt){
+  const iglm::Mode x = iglm::Mode::x, y = iglm::Mode::y;
+  if(!fix_x){
+    // Rcout << "Sampling X| Y,Z" << std::endl;
+    // Sample X| Y,Z
+    xyz_simulate_attribute_mh(coef,object,
+                              n_proposals_x,
+                              data_list, 
+                              type_list,
+                              is_full_neighborhood, 
+                              functions,
+                              global_stats, x);  
+  }
+  // Rcout << "Sampling Y| X,Z" << std::endl;
+  // Sample Y| X,Z
+  xyz_simulate_attribute_mh(coef,object,
+                            n_proposals_y,
+                            data_list, type_list,
+                            is_full_neighborhood, functions,
+                            global_stats, y);
+  
+  if(!fix_z){
+    // Sample Z_overlapping|X,Y
+    if(functions.dyad_independent && !object.has_group_labels() && n_proposals_z > 0){
+      xyz_simulate_network_independent(coef, coef_degrees, degrees, object,
+                                       data_list, type_list,
+                                       is_full_neighborhood, functions,
+                                       global_stats);
+    } else if(degrees){
+      xyz_simulate_network_mh_degrees(coef,
+                                      coef_degrees,
+                                      object,
+                                      n_proposals_z,
+                                      data_list, type_list,
+                                      is_full_neighborhood, functions,
+                                      global_stats, tnt); 
+    } else {
+      xyz_simulate_network_mh(coef,object,
+                              n_proposals_z,
+                              data_list, type_list,
+                              is_full_neighborhood, functions,
+                              global_stats, tnt);  
+    }
+    if(nonoverlap_random){
+      // Sample Z_nonoverlapping|X,Y
+      if(degrees){
+        xyz_simulate_network_consecutive_degrees_mh(coef,
+                                                    coef_degrees,object,
+                                                    data_list, type_list,
+                                                    is_full_neighborhood, functions,
+                                                    global_stats, offset_nonoverlap);
+      } else {
+        xyz_simulate_network_consecutive_mh(coef,object,
+                                            data_list, type_list,
+                                            is_full_neighborhood, functions,
+                                            global_stats, offset_nonoverlap);
+      }
+    }
+  }
+}
+
 arma::mat xyz_simulate_internal(XYZ_class & object,
                                 const arma::vec& coef,
                                 const  arma::vec& coef_degrees,
@@ -960,7 +1283,6 @@ arma::mat xyz_simulate_internal(XYZ_class & object,
                                 const int n_proposals_x,
                                 const int n_proposals_y,
                                 const  int n_proposals_z,
-                                const int seed,
                                 const int n_burn_in,
                                 const  int n_simulation,
                                 std::vector<arma::vec>& res_x,
@@ -968,7 +1290,7 @@ arma::mat xyz_simulate_internal(XYZ_class & object,
                                 std::vector<std::vector<std::vector<int>>>& res_z,
                                 const bool only_stats,
                                 const bool is_full_neighborhood,
-                                const std::vector<xyz_ValidateFunction> functions,
+                                const xyz_TermTable &functions,
                                 const bool display_progress, 
                                 const bool degrees, 
                                 const double offset_nonoverlap, 
@@ -978,13 +1300,6 @@ arma::mat xyz_simulate_internal(XYZ_class & object,
                                 const bool tnt = true){
   arma::mat stats(n_simulation,functions.size());
   stats.fill(0);
-  std::string x, y; 
-  x = "x";
-  y = "y";
-  if (seed != NA_INTEGER) {
-    Rcpp::Function set_seed_r("set.seed");
-    set_seed_r(seed);
-  }
   Progress p(n_simulation + n_burn_in, display_progress);
   // Start for a burn in period with the normal number of proposals
   // Intialize global statistics and then adapt them peu a peu
@@ -993,58 +1308,10 @@ arma::mat xyz_simulate_internal(XYZ_class & object,
     // Rcout << global_stats << std::endl;
     // Rcout << "Updated Global Statistics: " << global_stats.t() << std::endl;
     p.increment(); // update progress
-    if(!fix_x){
-      // Rcout << "Sampling X| Y,Z" << std::endl;
-      // Sample X| Y,Z
-      xyz_simulate_attribute_mh(coef,object,
-                                n_proposals_x,
-                                data_list, 
-                                type_list,
-                                is_full_neighborhood, 
-                                functions,
-                                global_stats, x);  
-    }
-    // Rcout << "Sampling Y| X,Z" << std::endl;
-    // Sample Y| X,Z
-    xyz_simulate_attribute_mh(coef,object,
-                              n_proposals_y,
-                              data_list, type_list,
-                              is_full_neighborhood, functions,
-                              global_stats, y);
-    
-    if(!fix_z){
-      // Sample Z_overlapping|X,Y
-      if(degrees){
-        xyz_simulate_network_mh_degrees(coef,
-                                        coef_degrees,
-                                        object,
-                                        n_proposals_z,
-                                        data_list, type_list,
-                                        is_full_neighborhood, functions,
-                                        global_stats, tnt); 
-      } else {
-        xyz_simulate_network_mh(coef,object,
-                                n_proposals_z,
-                                data_list, type_list,
-                                is_full_neighborhood, functions,
-                                global_stats, tnt);  
-      }
-      if(nonoverlap_random){
-        // Sample Z_nonoverlapping|X,Y
-        if(degrees){
-          xyz_simulate_network_consecutive_degrees_mh(coef,
-                                                      coef_degrees,object,
-                                                      data_list, type_list,
-                                                      is_full_neighborhood, functions,
-                                                      global_stats, offset_nonoverlap);
-        } else {
-          xyz_simulate_network_consecutive_mh(coef,object,
-                                              data_list, type_list,
-                                              is_full_neighborhood, functions,
-                                              global_stats, offset_nonoverlap);
-        }
-      }
-    }
+    xyz_simulate_sweep(object, coef, coef_degrees, data_list, type_list, global_stats,
+                       n_proposals_x, n_proposals_y, n_proposals_z,
+                       is_full_neighborhood, functions, degrees, offset_nonoverlap,
+                       fix_x, fix_z, nonoverlap_random, tnt);
     // We throw the first n_burn_in samples away
     if(i>n_burn_in){
       if(only_stats){
@@ -1067,6 +1334,225 @@ arma::mat xyz_simulate_internal(XYZ_class & object,
   return(stats);
 }
 
+// Runs n_chains independent chains on n_chains threads. Every chain starts from
+// its own copy of object and global_stats, draws from stream k of the native
+// generator (chain k = 0, ..., n_chains - 1), runs the full burn-in and then
+// fills the rows first(k), ..., first(k + 1) - 1 of the n_simulation samples,
+// which are split as evenly as possible. The samples only depend on seed and
+// n_chains, not on how the chains are scheduled on the threads.
+arma::mat xyz_simulate_chains(const XYZ_class & object,
+                              const arma::vec& coef,
+                              const arma::vec& coef_degrees,
+                              const std::vector<arma::mat>& data_list,
+                              const std::vector<double>& type_list,
+                              const arma::vec & global_stats,
+                              const int n_proposals_x,
+                              const int n_proposals_y,
+                              const int n_proposals_z,
+                              const int seed,
+                              const int n_burn_in,
+                              const int n_simulation,
+                              std::vector<arma::vec>& res_x,
+                              std::vector<arma::vec>& res_y,
+                              std::vector<std::vector<std::vector<int>>>& res_z,
+                              const bool only_stats,
+                              const bool is_full_neighborhood,
+                              const xyz_TermTable &functions,
+                              const bool display_progress, 
+                              const bool degrees, 
+                              const double offset_nonoverlap, 
+                              const bool fix_x, 
+                              const bool fix_z, 
+                              const bool nonoverlap_random,
+                              const bool tnt,
+                              const int n_chains){
+  arma::mat stats(n_simulation, functions.size(), arma::fill::zeros);
+  std::vector<int> first(n_chains + 1);
+  for (int k = 0; k <= n_chains; k++) {
+    first[k] = (int)(((long long)n_simulation * k) / n_chains);
+  }
+  // All chains share one seed (drawn from R's generator on this thread if
+  // none is given) and differ in their streams
+  const int chain_seed = (seed != NA_INTEGER) ? seed : (int)(R::unif_rand() * 2147483646.0);
+  object.reserve_dyad_contexts(n_chains);
+  Progress p(n_chains * n_burn_in + n_simulation, display_progress);
+  bool failed = false;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_chains) schedule(dynamic)
+#endif
+  for (int k = 0; k < n_chains; k++) {
+    try {
+      XYZ_class chain = object;
+      arma::vec chain_stats = global_stats;
+      chain.rng.seed(true, chain_seed, k);
+      for (int i = -n_burn_in; i < first[k + 1] - first[k]; i++) {
+        if (Progress::check_abort()) break;
+        p.increment();
+        xyz_simulate_sweep(chain, coef, coef_degrees, data_list, type_list, chain_stats,
+                           n_proposals_x, n_proposals_y, n_proposals_z,
+                           is_full_neighborhood, functions, degrees, offset_nonoverlap,
+                           fix_x, fix_z, nonoverlap_random, tnt);
+        if (i < 0) continue;
+        const int row = first[k] + i;
+        stats.row(row) = chain_stats.as_row();
+        if (!only_stats) {
+          res_x.at(row) = chain.x_attribute.attribute;
+          res_y.at(row) = chain.y_attribute.attribute;
+          res_z.at(row) = chain.z_network.adj_list;
+        }
+      }
+    } catch (...) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+      failed = true;
+    }
+  }
+  if (failed) Rcpp::stop("The chains could not be simulated in parallel, try n_chains = 1");
+  if (Progress::check_abort()) Rcpp::stop("The simulation was interrupted");
+  return(stats);
+}
+
+
+// State of a simulation that persists across calls from R (see
+// xyz_session_create): the XYZ_class, its term table, the running global
+// statistics and the settings of the sweeps. Every run continues the chain
+// where the previous one stopped, including the random number generator.
+// Copies (see xyz_session_snapshot) share the topology of the state.
+struct SamplerSession {
+  XYZ_class object;
+  xyz_TermTable functions;
+  std::vector<arma::mat> data_list;
+  std::vector<double> type_list;
+  arma::vec coef;
+  arma::vec coef_degrees;
+  arma::vec global_stats;
+  int n_proposals_x, n_proposals_y, n_proposals_z;
+  bool is_full_neighborhood, degrees, fix_x, fix_z, nonoverlap_random, tnt;
+  double offset_nonoverlap;
+
+  SamplerSession(XYZ_class object_) : object(std::move(object_)) {}
+};
+
+// The degree coefficients hold one entry per actor, or two (out and in) if the
+// network is directed
+void xyz_check_coef_degrees(const arma::vec& coef_degrees, bool degrees, bool directed, int n_actor) {
+  if (!degrees) return;
+  const arma::uword expected = directed ? 2 * n_actor : n_actor;
+  if (coef_degrees.n_elem != expected) {
+    Rcpp::stop("The session needs " + std::to_string(expected) + " degree coefficients, got " +
+               std::to_string(coef_degrees.n_elem));
+  }
+}
+
+// Builds the starting state of a simulation from the inputs of xyz_simulate_cpp:
+// the network and attributes, the term table and the global statistics
+SamplerSession xyz_session_setup(const arma::vec& coef,
+                                 const arma::vec& coef_degrees,
+                                 const std::vector<std::string>& terms,
+                                 int n_actor,
+                                 const arma::mat& z_network,
+                                 const arma::mat& neighborhood,
+                                 const arma::mat& overlap,
+                                 const arma::vec& x_attribute,
+                                 const arma::vec& y_attribute,
+                                 bool init_empty,
+                                 bool directed,
+                                 bool degrees,
+                                 std::vector<arma::mat>& data_list,
+                                 std::vector<double>& type_list,
+                                 double offset_nonoverlap,
+                                 const std::string& type_x, 
+                                 const std::string& type_y, 
+                                 double attr_x_scale, 
+                                 double attr_y_scale,
+                                 bool nonoverlap_random, 
+                                 int n_proposals_x,
+                                 int n_proposals_y,
+                                 int n_proposals_z,
+                                 bool fix_x, 
+                                 bool fix_z,
+                                 bool tnt,
+                                 Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups){
+  xyz_check_coef_degrees(coef_degrees, degrees, directed, n_actor);
+  SamplerSession session(XYZ_class(n_actor,directed, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale,
+                                   StorageMode::automatic, xyz_group_labels(neighborhood_groups)));
+  XYZ_class &object = session.object;
+  if(!init_empty){
+    object.set_info_arma(x_attribute,y_attribute, z_network);
+  }
+  session.is_full_neighborhood = object.check_if_full_neighborhood();
+  // Generate change statistic function from the terms
+  session.functions = xyz_change_statistics_generate_new(terms);
+  xyz_enable_partner_cache(object, session.functions);
+  xyz_prepare_geometric_weights(object, session.functions, data_list);
+  session.global_stats = xyz_count_global_internal( object,
+                                                    terms,
+                                                    n_actor,
+                                                    data_list,
+                                                    type_list,
+                                                    type_x, type_y, 
+                                                    attr_x_scale, 
+                                                    attr_y_scale);
+  session.data_list = data_list;
+  session.type_list = type_list;
+  session.coef = coef;
+  session.coef_degrees = coef_degrees;
+  session.n_proposals_x = n_proposals_x;
+  session.n_proposals_y = n_proposals_y;
+  session.n_proposals_z = n_proposals_z;
+  session.degrees = degrees;
+  session.offset_nonoverlap = offset_nonoverlap;
+  session.fix_x = fix_x;
+  session.fix_z = fix_z;
+  session.nonoverlap_random = nonoverlap_random;
+  session.tnt = tnt;
+  return session;
+}
+
+// Result of xyz_simulate_cpp, the samples are only returned if !only_stats
+List xyz_simulation_list(const arma::mat &stats,
+                         const std::vector<arma::vec>& res_x,
+                         const std::vector<arma::vec>& res_y,
+                         const std::vector<std::vector<std::vector<int>>>& res_z,
+                         bool only_stats){
+  if(only_stats){
+    return(List::create(_["stats"] = stats));
+  } else {
+    return(List::create(_["simulation_attributes_x"] =res_x,_["simulation_attributes_y"] =res_y,
+                        _["simulation_networks_z"] =res_z, _["stats"] = stats));  
+  }
+}
+
+// Runs n_burn_in sweeps on the state of the session and returns the n_simulation
+// sweeps that follow; the session continues from the last one
+List xyz_session_simulate(SamplerSession &session,
+                          int n_burn_in,
+                          int n_simulation,
+                          bool only_stats,
+                          bool display_progress){
+  std::vector<arma::vec> res_x(n_simulation);
+  std::vector<arma::vec> res_y(n_simulation);
+  std::vector<std::vector<std::vector<int>>> res_z(n_simulation);
+  arma::mat stats = xyz_simulate_internal(session.object, session.coef, session.coef_degrees,
+                                          session.data_list, session.type_list, session.global_stats,
+                                          session.n_proposals_x,
+                                          session.n_proposals_y,
+                                          session.n_proposals_z,
+                                          n_burn_in, n_simulation,
+                                          res_x,res_y,res_z,
+                                          only_stats, 
+                                          session.is_full_neighborhood, 
+                                          session.functions, 
+                                          display_progress, 
+                                          session.degrees,
+                                          session.offset_nonoverlap, 
+                                          session.fix_x, 
+                                          session.fix_z, 
+                                          session.nonoverlap_random,
+                                          session.tnt);
+  return xyz_simulation_list(stats, res_x, res_y, res_z, only_stats);
+}
 
 // [[Rcpp::export]]
 List xyz_simulate_cpp(arma::vec& coef,
@@ -1099,66 +1585,279 @@ List xyz_simulate_cpp(arma::vec& coef,
                       bool display_progress = false, 
                       bool fix_x = false, 
                       bool fix_z = false,
-                      bool tnt = true){
-  // res(n_simulation);
-  // stats2.fill(0);
-  XYZ_class object(n_actor,directed, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale);
-  if(!init_empty){
-    object.set_info_arma(x_attribute,y_attribute, z_network);
+                      bool tnt = true,
+                      Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue,
+                      bool native_rng = false,
+                      int stream = 0,
+                      int n_chains = 1){
+  if(n_chains > 1 && !native_rng){
+    Rcpp::stop("Several chains require the native generator (rng = \"xoshiro\")");
+  }
+  SamplerSession session = xyz_session_setup(coef, coef_degrees, terms, n_actor, z_network,
+                                             neighborhood, overlap, x_attribute, y_attribute,
+                                             init_empty, directed, degrees, data_list, type_list,
+                                             offset_nonoverlap, type_x, type_y, attr_x_scale, attr_y_scale,
+                                             nonoverlap_random, n_proposals_x, n_proposals_y, n_proposals_z,
+                                             fix_x, fix_z, tnt, neighborhood_groups);
+  if(n_chains <= 1){
+    session.object.rng.seed(native_rng, seed, stream);
+    return xyz_session_simulate(session, n_burn_in, n_simulation, only_stats, display_progress);
   }
-  bool is_full_neighborhood = object.check_if_full_neighborhood();
-  // Rcout <<object.overlap.at(1)<< std::endl;
-  
-  // object.set_neighborhood_from_mat(neighborhood);
-  // Generate change statistic function from the terms
-  std::vector<xyz_ValidateFunction> functions;
-  
-  functions = xyz_change_statistics_generate_new(terms);
-  // arma::vec at_zero;
-  // at_zero = xyz_eval_at_empty_network_new(terms);
-  // // Start for a burn in period with the normal number of proposals
-  // // Intialize global statistics and then adapt them peu a peu
-  // arma::vec global_stats(functions.size());
-  // global_stats.fill(0);
-  // global_stats = global_stats + at_zero;
-  // Rcout << "Here"<< std::endl;
-  arma::vec global_stats = xyz_count_global_internal( object,
-                                                      terms,
-                                                      n_actor,
-                                                      data_list,
-                                                      type_list,
-                                                      type_x, type_y, 
-                                                      attr_x_scale, 
-                                                      attr_y_scale);
-  // Rcout << global_stats << std::endl;
   std::vector<arma::vec> res_x(n_simulation);
   std::vector<arma::vec> res_y(n_simulation);
   std::vector<std::vector<std::vector<int>>> res_z(n_simulation);
-  // Rcout << "B"<< std::endl;
-  arma::mat stats = xyz_simulate_internal(object, coef,coef_degrees, data_list, type_list, global_stats,
-                                          n_proposals_x,
-                                          n_proposals_y,
-                                          n_proposals_z, seed,
-                                          n_burn_in, n_simulation,
-                                          res_x,res_y,res_z,
-                                          only_stats, 
-                                          is_full_neighborhood, 
-                                          functions, 
-                                          display_progress, 
-                                          degrees,
-                                          offset_nonoverlap, 
-                                          fix_x, 
-                                          fix_z, 
-                                          nonoverlap_random,
-                                          tnt);
-  if(only_stats){
-    return(List::create(_["stats"] = stats));
+  arma::mat stats = xyz_simulate_chains(session.object, coef, coef_degrees, data_list, type_list,
+                                        session.global_stats,
+                                        n_proposals_x,
+                                        n_proposals_y,
+                                        n_proposals_z, seed,
+                                        n_burn_in, n_simulation,
+                                        res_x,res_y,res_z,
+                                        only_stats, 
+                                        session.is_full_neighborhood, 
+                                        session.functions, 
+                                        display_progress, 
+                                        degrees,
+                                        offset_nonoverlap, 
+                                        fix_x, 
+                                        fix_z, 
+                                        nonoverlap_random,
+                                        tnt, n_chains);
+  return xyz_simulation_list(stats, res_x, res_y, res_z, only_stats);
+}
+
+// Sessions are handed to R as external pointers that delete the session when
+// they are garbage collected. Pointers restored from a saved workspace are
+// NULL and rejected here.
+SamplerSession &xyz_session_get(SEXP session){
+  Rcpp::XPtr<SamplerSession> ptr(session);
+  if(ptr.get() == NULL){
+    Rcpp::stop("The sampler session is no longer valid, create a new one");
+  }
+  return *ptr;
+}
+
+// Starts a session from the inputs of xyz_simulate_cpp (without n_burn_in,
+// n_simulation and n_chains, which are given per run), so that repeated runs
+// neither rebuild the state and term table nor recount the global statistics
+// [[Rcpp::export]]
+SEXP xyz_session_create(arma::vec& coef,
+                        arma::vec& coef_degrees,
+                        std::vector<std::string>& terms,
+                        int& n_actor,
+                        arma::mat z_network,
+                        arma::mat neighborhood,
+                        arma::mat overlap,
+                        arma::vec x_attribute,
+                        arma::vec y_attribute,
+                        bool init_empty,
+                        bool directed,
+                        bool degrees,
+                        std::vector<arma::mat>& data_list,
+                        std::vector<double>& type_list,
+                        double offset_nonoverlap,
+                        std::string type_x, 
+                        std::string type_y, 
+                        double attr_x_scale, 
+                        double attr_y_scale,
+                        bool nonoverlap_random = false, 
+                        int n_proposals_x = 100,
+                        int n_proposals_y = 100,
+                        int n_proposals_z = 100,
+                        int seed = 123,
+                        bool fix_x = false, 
+                        bool fix_z = false,
+                        bool tnt = true,
+                        Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue,
+                        bool native_rng = false,
+                        int stream = 0){
+  SamplerSession *session = new SamplerSession(
+    xyz_session_setup(coef, coef_degrees, terms, n_actor, z_network,
+                      neighborhood, overlap, x_attribute, y_attribute,
+                      init_empty, directed, degrees, data_list, type_list,
+                      offset_nonoverlap, type_x, type_y, attr_x_scale, attr_y_scale,
+                      nonoverlap_random, n_proposals_x, n_proposals_y, n_proposals_z,
+                      fix_x, fix_z, tnt, neighborhood_groups));
+  Rcpp::XPtr<SamplerSession> ptr(session, true);
+  session->object.rng.seed(native_rng, seed, stream);
+  return ptr;
+}
+
+// Runs n_burn_in and then n_simulation sweeps from the current state of the
+// session, returns the same list as xyz_simulate_cpp
+// [[Rcpp::export]]
+List xyz_session_run(SEXP session,
+                     int n_simulation = 1,
+                     int n_burn_in = 0,
+                     bool only_stats = false,
+                     bool display_progress = false){
+  return xyz_session_simulate(xyz_session_get(session), n_burn_in, n_simulation,
+                              only_stats, display_progress);
+}
+
+// Replaces the coefficients of the session; the state and its global
+// statistics do not depend on them and are kept
+// [[Rcpp::export]]
+void xyz_session_set_coef(SEXP session, arma::vec& coef, arma::vec& coef_degrees){
+  SamplerSession &res = xyz_session_get(session);
+  if(coef.n_elem != res.functions.size()){
+    Rcpp::stop("The session needs one coefficient per term");
+  }
+  xyz_check_coef_degrees(coef_degrees, res.degrees, res.object.z_network.directed, res.object.n_actor);
+  res.coef = coef;
+  res.coef_degrees = coef_degrees;
+}
+
+// Current state of the session in the format of one sample of xyz_simulate_cpp
+// together with its global statistics
+// [[Rcpp::export]]
+List xyz_session_get_state(SEXP session){
+  const SamplerSession &res = xyz_session_get(session);
+  return(List::create(_["x_attribute"] = res.object.x_attribute.attribute,
+                      _["y_attribute"] = res.object.y_attribute.attribute,
+                      _["z_network"] = res.object.z_network.adj_list,
+                      _["stats"] = res.global_stats));
+}
+
+// Independent copy of the session (including the state of its random number
+// generator) that shares the topology of its state
+// [[Rcpp::export]]
+SEXP xyz_session_snapshot(SEXP session){
+  Rcpp::XPtr<SamplerSession> ptr(new SamplerSession(xyz_session_get(session)), true);
+  return ptr;
+}
+
+// Number of non-edges drawn from a stratum with n0 non-edges
+inline double xyz_stratum_sample_size(double n0, double fraction) {
+  if (n0 <= 0) return 0;
+  return std::min(n0, std::max(1.0, std::round(fraction * n0)));
+}
+
+// Dyads of a case-control pseudo-likelihood: all edges and, separately within
+// and outside of the overlap, a simple random sample of a fraction of the
+// non-edges. A sampled non-edge stands for n0 / m non-edges of its stratum (n0
+// non-edges, m of them drawn), which is its weight; edges have weight 1. The
+// work is linear in the number of edges, the size of the overlap and the sample.
+// Dyads are returned sorted, undirected ones as (i, j) with i < j.
+void xyz_sample_pl_dyads(const XYZ_class &object,
+                         double fraction,
+                         std::vector<int> &units_i,
+                         std::vector<int> &units_j,
+                         std::vector<double> &weights) {
+  const int n_actor = object.n_actor;
+  const bool directed = object.z_network.directed;
+  struct Dyad { int i, j; double w; };
+  std::vector<Dyad> dyads;
+  double ties = 0, ties_overlap = 0;
+  for (int i = 1; i <= n_actor; i++) {
+    for (int j : object.z_network.adj_list[i]) {
+      if (j == i || (!directed && j < i)) continue;
+      dyads.push_back({i, j, 1.0});
+      ties += 1;
+      if (object.get_val_overlap(i, j)) ties_overlap += 1;
+    }
+  }
+  // Non-edges within the overlap, drawn without replacement by a partial shuffle
+  std::vector<std::pair<int, int>> pool;
+  pool.reserve(object.inactive_edges_nb.size());
+  for (const auto &d : object.inactive_edges_nb) {
+    if (d.first == d.second) continue;
+    if (directed) pool.push_back(d);
+    else pool.push_back({std::min(d.first, d.second), std::max(d.first, d.second)});
+  }
+  if (!directed) {
+    std::sort(pool.begin(), pool.end());
+    pool.erase(std::unique(pool.begin(), pool.end()), pool.end());
+  }
+  const double n0_overlap = pool.size();
+  const double m_overlap = xyz_stratum_sample_size(n0_overlap, fraction);
+  for (size_t k = 0; k < (size_t)m_overlap; k++) {
+    size_t r = k + (size_t)(R::unif_rand() * (pool.size() - k));
+    std::swap(pool[k], pool[r]);
+    dyads.push_back({pool[k].first, pool[k].second, n0_overlap / m_overlap});
+  }
+  // Non-edges outside of the overlap. Rejection needs about
+  // n_dyads * log(n0_rest / (n0_rest - m_rest)) draws, which exceeds a pass over
+  // all dyads once m_rest > (1 - 1/e) * n0_rest; the stratum is then enumerated
+  // and drawn by a partial shuffle as above.
+  const double n_dyads = directed ? (double)n_actor * (n_actor - 1) : (double)n_actor * (n_actor - 1) / 2;
+  const double n0_rest = n_dyads - (n0_overlap + ties_overlap) - (ties - ties_overlap);
+  const double m_rest = xyz_stratum_sample_size(n0_rest, fraction);
+  if (m_rest >= (1 - std::exp(-1.0)) * n0_rest) {
+    pool.clear();
+    pool.reserve((size_t)n0_rest);
+    for (int i = 1; i <= n_actor; i++) {
+      for (int j = directed ? 1 : i + 1; j <= n_actor; j++) {
+        if (i == j || object.get_val_overlap(i, j) || object.z_network.get_val(i, j)) continue;
+        pool.push_back({i, j});
+      }
+    }
+    for (size_t k = 0; k < (size_t)m_rest; k++) {
+      size_t r = k + (size_t)(R::unif_rand() * (pool.size() - k));
+      std::swap(pool[k], pool[r]);
+      dyads.push_back({pool[k].first, pool[k].second, n0_rest / m_rest});
+    }
   } else {
-    return(List::create(_["simulation_attributes_x"] =res_x,_["simulation_attributes_y"] =res_y,
-                        _["simulation_networks_z"] =res_z, _["stats"] = stats));  
+    std::unordered_set<std::uint64_t> drawn;
+    for (std::uint64_t n_draws = 0; drawn.size() < (size_t)m_rest; n_draws++) {
+      if ((n_draws & 0xFFFF) == 0) Rcpp::checkUserInterrupt();
+      int i = 1 + (int)(R::unif_rand() * n_actor);
+      int j = 1 + (int)(R::unif_rand() * n_actor);
+      if (i == j) continue;
+      if (!directed && i > j) std::swap(i, j);
+      if (object.get_val_overlap(i, j) || object.z_network.get_val(i, j)) continue;
+      if (drawn.insert(dyad_key(i, j, n_actor)).second) {
+        dyads.push_back({i, j, n0_rest / m_rest});
+      }
+    }
+  }
+  std::sort(dyads.begin(), dyads.end(), [](const Dyad &a, const Dyad &b) {
+    return a.i < b.i || (a.i == b.i && a.j < b.j);
+  });
+  units_i.resize(dyads.size());
+  units_j.resize(dyads.size());
+  weights.resize(dyads.size());
+  for (size_t d = 0; d < dyads.size(); d++) {
+    units_i[d] = dyads[d].i;
+    units_j[d] = dyads[d].j;
+    weights[d] = dyads[d].w;
+  }
+}
+
+// Case-control sample of the dyads of a network (see xyz_sample_pl_dyads) with
+// the weights of the sampled dyads and whether they lie in the overlap, so that
+// the tests can check the strata
+List xyz_sample_pl_dyads_cpp(const arma::mat& z_network,
+                             const arma::mat& neighborhood,
+                             const arma::mat& overlap,
+                             bool directed,
+                             int n_actor,
+                             double fraction) {
+  arma::vec attribute(n_actor, arma::fill::zeros);
+  XYZ_class object(n_actor, directed, attribute, attribute, z_network, neighborhood, overlap,
+                   "binomial", "binomial", 1, 1);
+  std::vector<int> units_i, units_j;
+  std::vector<double> weights;
+  xyz_sample_pl_dyads(object, fraction, units_i, units_j, weights);
+  std::vector<int> in_overlap(units_i.size()), edge(units_i.size());
+  for (size_t d = 0; d < units_i.size(); d++) {
+    in_overlap[d] = object.get_val_overlap(units_i[d], units_j[d]);
+    edge[d] = object.z_network.get_val(units_i[d], units_j[d]);
   }
+  return List::create(Named("i") = units_i,
+                      Named("j") = units_j,
+                      Named("weight") = weights,
+                      Named("overlap") = in_overlap,
+                      Named("edge") = edge);
 }
-std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
+
+// Design matrix and response of the pseudo-likelihood: one row per dyad (unless
+// fix_z) followed by one row per actor for x (unless fix_x) and y. The dyads
+// are written to i_vec, j_vec and overlap_vec. With sample_fraction < 1 only a
+// case-control sample of the dyads is used (see xyz_sample_pl_dyads), whose
+// weights are returned in net_weights. If given, dyad_independent is set to
+// whether all terms of the resolved term table are dyad independent.
+std::tuple<arma::mat, arma::vec> xyz_get_info_pl(XYZ_class& object,
                                                  std::vector<std::string> terms,
                                                  std::vector<arma::mat> &data_list,
                                                  std::vector<double> &type_list, 
@@ -1168,28 +1867,56 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
                                                  arma::uvec &overlap_vec, 
                                                  int n_actor, 
                                                  bool fix_x, 
-                                                 bool fix_z) {
+                                                 bool fix_z, 
+                                                 int n_threads = 1, 
+                                                 double sample_fraction = 1.0, 
+                                                 arma::vec *net_weights = nullptr,
+                                                 bool *dyad_independent = nullptr) {
   bool is_full_neighborhood = object.check_if_full_neighborhood();
   // Generate vector of functions that calculate the sufficient statistics 
-  std::vector<xyz_ValidateFunction> functions;
+  xyz_TermTable functions;
   functions = xyz_change_statistics_generate_new(terms);
+  if (dyad_independent) *dyad_independent = functions.dyad_independent;
+  // Filled up front, the terms only read them (possibly from several threads)
+  xyz_prepare_geometric_weights(object, functions, data_list);
   // strings z, x, and y later needed to tell the sufficient statistics 
   // what type of change statistic is wanted
-  std::string z = "z", x = "x", y = "y";
-  // Just a temporary vector of the change statistics for one dyad of the network
-  arma::vec change_stat_network(functions.size()),
-  // The same thing but for the attributes i and j
-  change_stat_attribute_i(functions.size()), change_stat_attribute_j(functions.size());
+  const iglm::Mode z = iglm::Mode::z, x = iglm::Mode::x, y = iglm::Mode::y;
+  // Dyads (and actors) whose change statistics are evaluated in one batch
+  std::vector<int> units_i, units_j;
+  std::vector<double> sample_weights;
+  const bool sampled = !fix_z && sample_fraction < 1.0;
+  if (sampled) {
+    if (!net_weights) Rcpp::stop("Weights are needed for a sample of the dyads");
+    xyz_sample_pl_dyads(object, sample_fraction, units_i, units_j, sample_weights);
+  }
+  const arma::uword n_net = fix_z ? 0 : (sampled ? units_i.size() :
+    (arma::uword)n_actor * (n_actor - 1) / (object.z_network.directed ? 1 : 2));
   double x_i, y_i, z_ij;
   // int ncores = 5;
-  arma::mat res_covs((!fix_z) * (n_actor* (n_actor - 1) * (object.z_network.directed + 1) / 2) + 
-    n_actor * (!fix_x + 1), terms.size());
-  arma::vec res_target((!fix_z) * (n_actor* (n_actor - 1) * (object.z_network.directed + 1) / 2) + 
-    n_actor * (!fix_x + 1));
+  arma::mat res_covs(n_net + n_actor * (!fix_x + 1), terms.size());
+  arma::vec res_target(n_net + n_actor * (!fix_x + 1));
+  i_vec.set_size(n_net);
+  j_vec.set_size(n_net);
+  overlap_vec.set_size(n_net);
+  if (net_weights) {
+    *net_weights = sampled ? arma::conv_to<arma::vec>::from(sample_weights) : arma::vec();
+  }
   
   Progress p(res_target.size(), display_progress);
   int now = 0;
-  if(!fix_z){
+  if(sampled){
+    for(size_t d = 0; d < units_i.size(); d++){
+      p.increment();
+      res_target.at(now) = object.z_network.get_val(units_i[d], units_j[d]);
+      i_vec.at(now) = units_i[d];
+      j_vec.at(now) = units_j[d];
+      overlap_vec.at(now) = object.get_val_overlap(units_i[d], units_j[d]);
+      now += 1;
+    }
+    xyz_calculate_change_stats_batch(res_covs, 0, units_i, units_j, object, data_list, type_list,
+                                     z, is_full_neighborhood, functions, n_threads);
+  } else if(!fix_z){
     if(object.z_network.directed){
       for(int i: seq(1,n_actor)){
         Rcpp::checkUserInterrupt();
@@ -1201,16 +1928,8 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
             continue;
           }
           z_ij = object.z_network.get_val(i,j);
-          xyz_calculate_change_stats(change_stat_network, i,
-                                     j,
-                                     object,
-                                     data_list,
-                                     type_list,
-                                     z,
-                                     is_full_neighborhood,
-                                     functions);
-          // change_stat_network(change_stat_network.size()+1) =x_ij;
-          res_covs.row(now)= (change_stat_network).as_row();
+          units_i.push_back(i);
+          units_j.push_back(j);
           res_target.at(now) = z_ij;
           i_vec.at(now) = i;
           j_vec.at(now) = j;
@@ -1225,16 +1944,8 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
           p.increment(); // update progress
           
           z_ij = object.z_network.get_val(i,j);
-          xyz_calculate_change_stats(change_stat_network, i,
-                                     j,
-                                     object,
-                                     data_list,
-                                     type_list,
-                                     z,
-                                     is_full_neighborhood,
-                                     functions);
-          // change_stat_network(change_stat_network.size()+1) =x_ij;
-          res_covs.row(now)= (change_stat_network).as_row();
+          units_i.push_back(i);
+          units_j.push_back(j);
           res_target.at(now) = z_ij;
           i_vec.at(now) = i;
           j_vec.at(now) = j;
@@ -1243,40 +1954,386 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
         } 
       }
     }
+    xyz_calculate_change_stats_batch(res_covs, 0, units_i, units_j, object, data_list, type_list,
+                                     z, is_full_neighborhood, functions, n_threads);
   } 
+  // The rows of x_i and y_i alternate, so both are evaluated in separate
+  // matrices first and then interleaved
+  std::vector<int> actors(n_actor);
+  for(int i = 1; i <= n_actor; i++){
+    actors[i - 1] = i;
+  }
+  arma::mat covs_x(n_actor, terms.size()), covs_y(n_actor, terms.size());
+  if(!fix_x){
+    xyz_calculate_change_stats_batch(covs_x, 0, actors, actors, object, data_list, type_list,
+                                     x, is_full_neighborhood, functions, n_threads);
+  }
+  xyz_calculate_change_stats_batch(covs_y, 0, actors, actors, object, data_list, type_list,
+                                   y, is_full_neighborhood, functions, n_threads);
   for(int i: seq(1,n_actor)){
     if(!fix_x){
       p.increment(); 
       x_i = object.x_attribute.get_val_no_scale(i);
-      xyz_calculate_change_stats(change_stat_attribute_i, i,
-                                 i,
-                                 object,
-                                 data_list,
-                                 type_list,
-                                 x,
-                                 is_full_neighborhood,
-                                 functions);
-      res_covs.row(now)= (change_stat_attribute_i).as_row();
+      res_covs.row(now)= covs_x.row(i - 1);
       res_target.at(now) = x_i;
       now += 1;  
     }
     p.increment(); 
     y_i = object.y_attribute.get_val_no_scale(i);
-    xyz_calculate_change_stats(change_stat_attribute_i, i,
-                               i,
-                               object,
-                               data_list,
-                               type_list,
-                               y,
-                               is_full_neighborhood,
-                               functions);
-    res_covs.row(now)= (change_stat_attribute_i).as_row();
+    res_covs.row(now)= covs_y.row(i - 1);
     res_target.at(now) = y_i;
     now += 1;
   } 
   
   return(std::tuple<arma::mat, arma::vec> {res_covs, res_target});
-} 
+}
+
+// Evaluates the network rows of the pseudo-likelihood in chunks of chunk_size
+// dyads (in the order of xyz_get_info_pl) and calls f(X, Y, overlap) for every
+// chunk, so that at most chunk_size rows of the design are held in memory.
+template <class F>
+void xyz_for_each_pl_chunk(const XYZ_class &object,
+                           const xyz_TermTable &functions,
+                           const std::vector<arma::mat> &data_list,
+                           const std::vector<double> &type_list,
+                           size_t chunk_size,
+                           int n_threads,
+                           F f) {
+  const int n_actor = object.n_actor;
+  const bool directed = object.z_network.directed;
+  const bool is_full_neighborhood = object.check_if_full_neighborhood();
+  std::vector<int> units_i, units_j;
+  units_i.reserve(chunk_size);
+  units_j.reserve(chunk_size);
+  arma::mat X;
+  arma::vec Y, overlap;
+  auto flush = [&]() {
+    const size_t n = units_i.size();
+    if (n == 0) return;
+    Rcpp::checkUserInterrupt();
+    X.set_size(n, functions.size());
+    Y.set_size(n);
+    overlap.set_size(n);
+    for (size_t d = 0; d < n; d++) {
+      Y.at(d) = object.z_network.get_val(units_i[d], units_j[d]);
+      overlap.at(d) = object.get_val_overlap(units_i[d], units_j[d]);
+    }
+    xyz_calculate_change_stats_batch(X, 0, units_i, units_j, object, data_list, type_list,
+                                     iglm::Mode::z, is_full_neighborhood, functions, n_threads);
+    f(X, Y, overlap);
+    units_i.clear();
+    units_j.clear();
+  };
+  for (int i = 1; i <= n_actor; i++) {
+    for (int j = directed ? 1 : i + 1; j <= n_actor; j++) {
+      if (i == j) continue;
+      units_i.push_back(i);
+      units_j.push_back(j);
+      if (units_i.size() == chunk_size) flush();
+    }
+  }
+  flush();
+}
+
+// Network rows of the pseudo-likelihood streamed in chunks of chunk_size dyads
+// ("X", "Y", "overlap" and the size of every chunk) together with the same rows
+// of the full design of xyz_get_info_pl ("X_full", "Y_full"), for the tests
+List xyz_pl_chunks(const arma::mat& z_network,
+                   const arma::vec& x_attribute,
+                   const arma::vec& y_attribute,
+                   const arma::mat& neighborhood,
+                   const arma::mat& overlap,
+                   bool directed,
+                   std::vector<std::string> terms,
+                   int n_actor,
+                   std::vector<arma::mat> &data_list,
+                   std::vector<double> &type_list,
+                   std::string type_x,
+                   std::string type_y,
+                   double attr_x_scale,
+                   double attr_y_scale,
+                   int chunk_size,
+                   int n_threads = 1) {
+  if (chunk_size < 1) Rcpp::stop("chunk_size must be positive");
+  XYZ_class object(n_actor,directed, x_attribute,y_attribute,z_network, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  const xyz_TermTable functions = xyz_change_statistics_generate_new(terms);
+  arma::uvec i_vec, j_vec, overlap_vec;
+  std::tuple<arma::mat, arma::vec> full = xyz_get_info_pl(object, terms, data_list, type_list, false,
+                                                          i_vec, j_vec, overlap_vec, n_actor, true, false);
+  const arma::uword n_net = i_vec.n_elem;
+  arma::mat X(n_net, terms.size());
+  arma::vec Y(n_net), overlap_flags(n_net);
+  std::vector<int> sizes;
+  arma::uword now = 0;
+  xyz_for_each_pl_chunk(object, functions, data_list, type_list, chunk_size, n_threads,
+                        [&](const arma::mat &X_c, const arma::vec &Y_c, const arma::vec &overlap_c) {
+                          if (now + X_c.n_rows > n_net) Rcpp::stop("The chunks hold more rows than the design");
+                          X.rows(now, now + X_c.n_rows - 1) = X_c;
+                          Y.subvec(now, now + X_c.n_rows - 1) = Y_c;
+                          overlap_flags.subvec(now, now + X_c.n_rows - 1) = overlap_c;
+                          now += X_c.n_rows;
+                          sizes.push_back(X_c.n_rows);
+                        });
+  return List::create(Named("X") = X.rows(0, now - 1),
+                      Named("Y") = Y.head(now),
+                      Named("overlap") = overlap_flags.head(now),
+                      Named("sizes") = sizes,
+                      Named("X_full") = std::get<0>(full).rows(0, n_net - 1),
+                      Named("Y_full") = std::get<1>(full).head(n_net));
+}
+
+// X.rows(from, to - 1) * coef together with the weighted cross-products of the
+// same rows (see weighted_gram.h), with X stored in double or, if
+// single_precision, in single precision, for the tests
+List xyz_weighted_crossprod(const arma::mat& X,
+                            int from,
+                            int to,
+                            const arma::vec& w,
+                            const arma::vec& r,
+                            const arma::vec& coef,
+                            int n_threads = 1,
+                            bool single_precision = false) {
+  if (from < 0 || to < from || to > (int)X.n_rows) Rcpp::stop("The rows must satisfy 0 <= from <= to <= nrow(X)");
+  if ((w.n_elem > 0 && (int)w.n_elem != to - from) || (r.n_elem > 0 && (int)r.n_elem != to - from)) {
+    Rcpp::stop("w and r need one entry per row");
+  }
+  arma::vec score(X.n_cols, arma::fill::zeros), eta;
+  arma::mat fisher(X.n_cols, X.n_cols, arma::fill::zeros);
+  if (single_precision) {
+    const arma::fmat X_f = arma::conv_to<arma::fmat>::from(X);
+    weighted_crossprod(X_f, from, to, w, r, score, fisher, n_threads);
+    eta = design_times(X_f, from, to, coef, n_threads);
+  } else {
+    weighted_crossprod(X, from, to, w, r, score, fisher, n_threads);
+    eta = design_times(X, from, to, coef, n_threads);
+  }
+  return List::create(Named("score") = score,
+                      Named("fisher") = fisher,
+                      Named("eta") = eta);
+}
+
+// Distinct network rows of the pseudo-likelihood, each given by its change
+// statistics, response and overlap flag (width values), with the summed (and
+// summed squared) weights of the dyads they stand for and the first of these
+// dyads (and its position).
+// The hash set holds row numbers into values, so it stays valid as values grows.
+struct PlRowTable {
+  const arma::uword width;
+  std::vector<double> values;
+  std::vector<double> weights, weights_sq;
+  std::vector<arma::uword> first;
+  std::vector<int> first_i, first_j;
+  struct Hash {
+    const PlRowTable *table;
+    std::size_t operator()(arma::uword r) const {
+      std::uint64_t h = 1469598103934665603ULL;
+      const double *v = table->values.data() + r * table->width;
+      for (arma::uword c = 0; c < table->width; c++) {
+        // + 0.0 maps -0 to 0, which compare equal
+        double val = v[c] + 0.0;
+        std::uint64_t bits;
+        std::memcpy(&bits, &val, sizeof(bits));
+        h = (h ^ bits) * 1099511628211ULL;
+        h ^= h >> 29;
+      }
+      return (std::size_t)h;
+    }
+  };
+  struct Equal {
+    const PlRowTable *table;
+    bool operator()(arma::uword a, arma::uword b) const {
+      const double *va = table->values.data() + a * table->width;
+      const double *vb = table->values.data() + b * table->width;
+      for (arma::uword c = 0; c < table->width; c++) {
+        if (va[c] != vb[c]) return false;
+      }
+      return true;
+    }
+  };
+  std::unordered_set<arma::uword, Hash, Equal> rows;
+
+  explicit PlRowTable(arma::uword width_) :
+    width(width_), rows(1024, Hash{this}, Equal{this}) {}
+  PlRowTable(const PlRowTable &) = delete;
+  PlRowTable &operator=(const PlRowTable &) = delete;
+
+  size_t size() const { return weights.size(); }
+  // Adds dyad (i, j) at position pos with weight w (and squared weight w_sq,
+  // which differs from w * w when merging tables) to the row given by the
+  // width values in row
+  void add(const double *row, double w, double w_sq, arma::uword pos, int i, int j) {
+    const arma::uword r = weights.size();
+    values.insert(values.end(), row, row + width);
+    auto it = rows.insert(r);
+    if (it.second) {
+      weights.push_back(w);
+      weights_sq.push_back(w_sq);
+      first.push_back(pos);
+      first_i.push_back(i);
+      first_j.push_back(j);
+      return;
+    }
+    values.resize(values.size() - width);
+    const arma::uword e = *it.first;
+    weights[e] += w;
+    weights_sq[e] += w_sq;
+    if (pos < first[e]) {
+      first[e] = pos;
+      first_i[e] = i;
+      first_j[e] = j;
+    }
+  }
+};
+
+// Builds the network rows of the pseudo-likelihood in compressed form, without
+// holding the full design: the dyads (all of them in the order of
+// xyz_get_info_pl, or the sample of xyz_sample_pl_dyads if sample_fraction < 1)
+// are evaluated in chunks of chunk_size, every thread hashes its share of a
+// chunk into its own PlRowTable and the tables are merged at the end. Without
+// degree parameters a network row enters score, Fisher information and
+// likelihood only through these values, so the weighted rows give the same
+// estimates. On return X and Y hold the distinct rows in the order of their first
+// dyad, i_vec, j_vec and overlap_vec that dyad, weights the multiplicities (or
+// the sums of the sampling weights), weights_sq the sums of the squared sampling
+// weights (empty without sampling) and n_rows the number of dyads.
+// Returns false if less than half of the rows would be saved (e.g., with
+// continuous dyadic covariates); the outputs are then unspecified.
+bool xyz_compressed_pl_rows(const XYZ_class &object,
+                            const xyz_TermTable &functions,
+                            const std::vector<arma::mat> &data_list,
+                            const std::vector<double> &type_list,
+                            double sample_fraction,
+                            size_t chunk_size,
+                            int n_threads,
+                            arma::mat &X,
+                            arma::vec &Y,
+                            arma::uvec &i_vec,
+                            arma::uvec &j_vec,
+                            arma::uvec &overlap_vec,
+                            arma::vec &weights,
+                            arma::vec &weights_sq,
+                            arma::uword &n_rows) {
+  const int n_actor = object.n_actor;
+  const bool directed = object.z_network.directed;
+  const bool is_full_neighborhood = object.check_if_full_neighborhood();
+  const arma::uword n_col = functions.size(), width = n_col + 2;
+  std::vector<int> sample_i, sample_j;
+  std::vector<double> sample_weights;
+  const bool sampled = sample_fraction < 1.0;
+  if (sampled) {
+    xyz_sample_pl_dyads(object, sample_fraction, sample_i, sample_j, sample_weights);
+    n_rows = sample_i.size();
+  } else {
+    n_rows = (arma::uword)n_actor * (n_actor - 1) / (directed ? 1 : 2);
+  }
+  if (n_rows == 0) return false;
+  if (chunk_size == 0) chunk_size = 65536;
+  int n_tables = 1;
+#ifdef _OPENMP
+  n_tables = std::max(1, n_threads);
+#endif
+  std::vector<std::unique_ptr<PlRowTable>> tables;
+  for (int t = 0; t < n_tables; t++) tables.emplace_back(new PlRowTable(width));
+
+  std::vector<int> units_i, units_j;
+  units_i.reserve(chunk_size);
+  units_j.reserve(chunk_size);
+  arma::mat X_c;
+  arma::uword pos = 0;
+  bool too_many = false;
+  auto flush = [&]() {
+    const size_t n = units_i.size();
+    if (n == 0 || too_many) return;
+    Rcpp::checkUserInterrupt();
+    X_c.set_size(n, n_col);
+    xyz_calculate_change_stats_batch(X_c, 0, units_i, units_j, object, data_list, type_list,
+                                     iglm::Mode::z, is_full_neighborhood, functions, n_threads);
+    auto add_range = [&](size_t from, size_t to, PlRowTable &table) {
+      std::vector<double> row(width);
+      for (size_t d = from; d < to; d++) {
+        for (arma::uword c = 0; c < n_col; c++) row[c] = X_c.at(d, c);
+        row[n_col] = object.z_network.get_val(units_i[d], units_j[d]);
+        row[n_col + 1] = object.get_val_overlap(units_i[d], units_j[d]);
+        const double w = sampled ? sample_weights[pos + d] : 1.0;
+        table.add(row.data(), w, w * w, pos + d, units_i[d], units_j[d]);
+      }
+    };
+#ifdef _OPENMP
+    if (n_tables > 1) {
+#pragma omp parallel for num_threads(n_tables) schedule(static)
+      for (int t = 0; t < n_tables; t++) {
+        add_range(n * t / n_tables, n * (t + 1) / n_tables, *tables[t]);
+      }
+    } else {
+      add_range(0, n, *tables[0]);
+    }
+#else
+    add_range(0, n, *tables[0]);
+#endif
+    pos += n;
+    units_i.clear();
+    units_j.clear();
+    // Every table holds distinct rows, so any of them bounds the merged size
+    for (const auto &table : tables) {
+      if (table->size() >= n_rows / 2) too_many = true;
+    }
+  };
+  if (sampled) {
+    for (size_t d = 0; d < sample_i.size() && !too_many; d++) {
+      units_i.push_back(sample_i[d]);
+      units_j.push_back(sample_j[d]);
+      if (units_i.size() == chunk_size) flush();
+    }
+  } else {
+    for (int i = 1; i <= n_actor && !too_many; i++) {
+      for (int j = directed ? 1 : i + 1; j <= n_actor; j++) {
+        if (i == j) continue;
+        units_i.push_back(i);
+        units_j.push_back(j);
+        if (units_i.size() == chunk_size) flush();
+      }
+    }
+  }
+  flush();
+  if (too_many) return false;
+  // Merge into the first table and order the rows by their first dyad, which
+  // gives the same rows as a serial pass
+  PlRowTable &merged = *tables[0];
+  for (int t = 1; t < n_tables; t++) {
+    const PlRowTable &table = *tables[t];
+    for (size_t r = 0; r < table.size(); r++) {
+      merged.add(table.values.data() + r * width, table.weights[r], table.weights_sq[r],
+                 table.first[r], table.first_i[r], table.first_j[r]);
+    }
+    tables[t].reset();
+  }
+  if (merged.size() >= n_rows / 2) return false;
+  std::vector<arma::uword> order(merged.size());
+  for (size_t r = 0; r < order.size(); r++) order[r] = r;
+  std::sort(order.begin(), order.end(), [&](arma::uword a, arma::uword b) {
+    return merged.first[a] < merged.first[b];
+  });
+  const arma::uword n_unique = order.size();
+  X.set_size(n_unique, n_col);
+  Y.set_size(n_unique);
+  i_vec.set_size(n_unique);
+  j_vec.set_size(n_unique);
+  overlap_vec.set_size(n_unique);
+  weights.set_size(n_unique);
+  weights_sq.set_size(sampled ? n_unique : 0);
+  for (arma::uword k = 0; k < n_unique; k++) {
+    const arma::uword r = order[k];
+    const double *v = merged.values.data() + r * width;
+    for (arma::uword c = 0; c < n_col; c++) X.at(k, c) = v[c];
+    Y.at(k) = v[n_col];
+    overlap_vec.at(k) = (arma::uword)v[n_col + 1];
+    weights.at(k) = merged.weights[r];
+    if (sampled) weights_sq.at(k) = merged.weights_sq[r];
+    i_vec.at(k) = merged.first_i[r];
+    j_vec.at(k) = merged.first_j[r];
+  }
+  return true;
+}
 
 // Version where the argument of a XYZ_class object 
 // and not the separate attributes and network as in the function xyz_prepare_composite_estimation_internal
@@ -1289,7 +2346,7 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
 //                                     arma::vec overlap_vec) {
 //   // Set up objects
 //   int n_actor = object.n_actor;
-//   std::vector<xyz_ValidateFunction> functions;
+//   xyz_TermTable functions;
 //   functions = xyz_change_statistics_generate(terms);
 //   std::string z = "z", x = "x", y = "y";
 //   // arma::vec change_stat_x_i(functions.size()),
@@ -1367,7 +2424,122 @@ std::tuple<arma::mat, arma::vec> xyz_get_info_pl(const XYZ_class& object,
 //   
 // }
 
-arma::mat get_A_exact(arma::uvec i_vec, 
+// Kernels of the degree parameters. The network rows only enter through the
+// linear predictor of the other terms, which is computed once per call by one
+// GEMV (xyz_degree_base_eta) instead of once per dyad and iteration. Sums over
+// the dyads of an actor are scatter-adds into the accumulators of the degree
+// parameters, i.e., into i_vec - 1 and j_vec - 1 + shift with shift = n_actor
+// for the in-degrees of directed networks and 0 otherwise.
+
+// Number of dyads from which the scatter-adds are split over threads
+const arma::uword xyz_degree_parallel_min = 16384;
+
+// X_net * coef_nondegrees plus offset_nonoverlap for the dyads outside of the overlap
+arma::vec xyz_degree_base_eta(const arma::mat &X_all, const arma::uvec &overlap_vec,
+                              const arma::vec &coef_nondegrees, double offset_nonoverlap) {
+  return X_all.head_rows(overlap_vec.n_elem) * coef_nondegrees +
+    (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
+}
+
+// 1 / (1 + exp(-eta)), which is 1 (and not NaN) for eta = Inf
+inline arma::vec xyz_sigmoid(const arma::vec &eta) {
+  return 1.0 / (1.0 + arma::exp(-eta));
+}
+
+// acc(i_vec(l) - 1) += v(l) and acc(j_vec(l) - 1 + shift) += v(l) for all dyads l.
+// With n_threads > 1 every thread adds a contiguous range of dyads to its own
+// buffer and the buffers are summed in a fixed order.
+void xyz_degree_scatter(const arma::uvec &i_vec, const arma::uvec &j_vec, arma::uword shift,
+                        const arma::vec &v, arma::vec &acc, int n_threads = 1) {
+  const arma::uword n = i_vec.n_elem;
+  auto add_range = [&](arma::uword from, arma::uword to, double *out) {
+    const arma::uword *ip = i_vec.memptr(), *jp = j_vec.memptr();
+    const double *vp = v.memptr();
+    for (arma::uword l = from; l < to; l++) {
+      out[ip[l] - 1] += vp[l];
+      out[jp[l] - 1 + shift] += vp[l];
+    }
+  };
+#ifdef _OPENMP
+  if (n_threads > 1 && n >= xyz_degree_parallel_min) {
+    arma::mat buffers(acc.n_elem, n_threads, arma::fill::zeros);
+#pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (int t = 0; t < n_threads; t++) {
+      add_range(n * t / n_threads, n * (t + 1) / n_threads, buffers.colptr(t));
+    }
+    acc += arma::sum(buffers, 1);
+    return;
+  }
+#endif
+  add_range(0, n, acc.memptr());
+}
+
+// B.col(i_vec(l) - 1) and B.col(j_vec(l) - 1 + shift) += v(l) * X_all.row(l)' for all dyads l
+void xyz_degree_scatter_rows(const arma::mat &X_all, const arma::uvec &i_vec, const arma::uvec &j_vec,
+                             arma::uword shift, const arma::vec &v, arma::mat &B, int n_threads = 1) {
+  const arma::uword n = i_vec.n_elem;
+  // Weighted rows as contiguous columns
+  const arma::mat W = (X_all.head_rows(n).each_col() % v).t();
+  auto add_range = [&](arma::uword from, arma::uword to, arma::mat &out) {
+    for (arma::uword l = from; l < to; l++) {
+      out.col(i_vec.at(l) - 1) += W.col(l);
+      out.col(j_vec.at(l) - 1 + shift) += W.col(l);
+    }
+  };
+#ifdef _OPENMP
+  if (n_threads > 1 && n >= xyz_degree_parallel_min) {
+    std::vector<arma::mat> buffers(n_threads, arma::mat(B.n_rows, B.n_cols, arma::fill::zeros));
+#pragma omp parallel for num_threads(n_threads) schedule(static)
+    for (int t = 0; t < n_threads; t++) {
+      add_range(n * t / n_threads, n * (t + 1) / n_threads, buffers[t]);
+    }
+    for (const arma::mat &buffer : buffers) B += buffer;
+    return;
+  }
+#endif
+  add_range(0, n, B);
+}
+
+// A0^-1 x for the degree block A0 of the Fisher information at probability 1/2
+// in a complete network, which bounds the degree block from above and gives the
+// MM updates (Fritz et al., 2025). A0 = (a - c) I + c 11' with a = (n - 1) / 4 and
+// c = 1 / 4 for undirected networks. For directed networks the out- and in-degree
+// of every actor form 2x2 blocks [a, -c; -c, a] and all out-degrees are coupled
+// to all in-degrees by the rank two term c (1_out 1_in' + 1_in 1_out'), which
+// the Woodbury identity handles in O(n_actor). The in-degree of the last actor
+// is fixed, its entry of x is ignored and its entry of the result is 0. This is
+// get_A_inv(n_actor) * x without the dense matrix.
+arma::vec xyz_degree_bound_solve(const arma::vec &x, int n_actor, bool directed) {
+  const double a = (n_actor - 1) / 4.0, c = 0.25;
+  if (!directed) {
+    return (x - c / (a - c + n_actor * c) * arma::accu(x)) / (a - c);
+  }
+  const double det = a * a - c * c;
+  // Inverse of the 2x2 blocks
+  auto K_solve = [&](const arma::vec &v) {
+    arma::vec res(2 * n_actor, arma::fill::zeros);
+    for (int k = 0; k < n_actor - 1; k++) {
+      res[k] = (a * v[k] + c * v[n_actor + k]) / det;
+      res[n_actor + k] = (c * v[k] + a * v[n_actor + k]) / det;
+    }
+    res[n_actor - 1] = v[n_actor - 1] / a;
+    return res;
+  };
+  arma::vec u_out(2 * n_actor, arma::fill::zeros), u_in(2 * n_actor, arma::fill::zeros);
+  u_out.head(n_actor).ones();
+  u_in.subvec(n_actor, 2 * n_actor - 2).ones();
+  const arma::vec K_out = K_solve(u_out), K_in = K_solve(u_in);
+  arma::mat G(2, 2);
+  G(0, 0) = arma::dot(u_out, K_out);
+  G(0, 1) = 1 / c + arma::dot(u_out, K_in);
+  G(1, 0) = 1 / c + arma::dot(u_in, K_out);
+  G(1, 1) = arma::dot(u_in, K_in);
+  const arma::vec y = K_solve(x);
+  arma::vec w = arma::solve(G, arma::vec({arma::dot(u_out, y), arma::dot(u_in, y)}));
+  return y - w[0] * K_out - w[1] * K_in;
+}
+
+DegreeHessian get_A_exact(arma::uvec i_vec, 
                       arma::uvec  j_vec,
                       arma::uvec  overlap_vec,
                       std::tuple<arma::mat,arma::vec> &pseudo_lh, 
@@ -1375,50 +2547,46 @@ arma::mat get_A_exact(arma::uvec i_vec,
                       arma::vec &coef_nondegrees, 
                       double &offset_nonoverlap, 
                       bool directed, 
-                      int n_actor){
-  arma::vec res;
-  arma::vec exp_tmp;
-  arma::mat A(coef_degrees.size(),coef_degrees.size());
-  unsigned int number_elements_network = i_vec.size();
-  // For the calculation of B we only have to regard network information (relating to the first entries)
-  
-  for(unsigned int i = 0; i < number_elements_network; i++){
-    if(overlap_vec.at(i)){
-      if(directed) {
-        exp_tmp = arma::exp(std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1+ n_actor));  
-      } else {
-        exp_tmp = arma::exp(std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1));  
-      }
-    } else {
-      if(directed) {
-        exp_tmp = arma::exp(offset_nonoverlap + std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1 + n_actor));
-      } else {
-        exp_tmp = arma::exp(offset_nonoverlap + std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1));
-      }
-    }
-    double e_eta = exp_tmp.at(0);
-    double p_val = (std::isinf(e_eta)) ? 1.0 : (e_eta / (1.0 + e_eta));
-    double v_val = p_val * (1.0 - p_val);
-    res = arma::vec({v_val});
-    
-    A.at(i_vec.at(i)-1, i_vec.at(i)-1)+= res.at(0);
-    if(directed) {
-      A.at(j_vec.at(i)-1 + n_actor, j_vec.at(i)-1 + n_actor)+= res.at(0);
-      A.at(i_vec.at(i)-1, j_vec.at(i)-1 + n_actor)+= res.at(0);
-      A.at(j_vec.at(i)-1 + n_actor, i_vec.at(i)-1)+= res.at(0);
-    } else {
-      A.at(j_vec.at(i)-1, j_vec.at(i)-1)+= res.at(0);
-      A.at(i_vec.at(i)-1, j_vec.at(i)-1)+= res.at(0);
-      A.at(j_vec.at(i)-1, i_vec.at(i)-1)+= res.at(0);
-    }
+                      int n_actor, 
+                      const arma::vec &net_weights = arma::vec(), 
+                      int n_threads = 1){
+  // For the calculation of A we only have to regard network information (relating to the first entries)
+  const arma::uword shift = directed ? n_actor : 0;
+  arma::vec prob = xyz_sigmoid(xyz_degree_base_eta(std::get<0>(pseudo_lh), overlap_vec, coef_nondegrees, offset_nonoverlap) +
+    coef_degrees.elem(i_vec - 1) + coef_degrees.elem(j_vec - 1 + shift));
+  arma::vec var = prob % (1.0 - prob);
+  if (net_weights.n_elem > 0) var %= net_weights;
+  
+  arma::vec A_diag(coef_degrees.n_elem, arma::fill::zeros);
+  xyz_degree_scatter(i_vec, j_vec, shift, var, A_diag, n_threads);
+  // The off-diagonal entries are the variances of the dyads, A is never dense
+  return(DegreeHessian(i_vec, j_vec, shift, A_diag, var));
+}
+
+// Exposes DegreeHessian::solve together with the dense A for testing
+List degree_hessian_solve(const arma::uvec& i_vec,
+                          const arma::uvec& j_vec,
+                          bool directed,
+                          int n_actor,
+                          const arma::vec& var,
+                          const arma::mat& rhs,
+                          int max_iteration = 1000,
+                          int n_threads = 1){
+  const arma::uword shift = directed ? n_actor : 0;
+  arma::vec A_diag(directed ? 2*n_actor : n_actor, arma::fill::zeros);
+  xyz_degree_scatter(i_vec, j_vec, shift, var, A_diag, n_threads);
+  DegreeHessian A(i_vec, j_vec, shift, A_diag, var);
+  arma::mat A_dense(A_diag.n_elem, A_diag.n_elem);
+  for(arma::uword a = 0; a < A_diag.n_elem; a++){
+    arma::vec e(A_diag.n_elem, arma::fill::zeros);
+    e[a] = 1;
+    A_dense.col(a) = A.times(e);
   }
-  
-  
-  return(A);
+  bool converged = true;
+  arma::mat solution = A.solve(rhs, n_threads, 1e-10, max_iteration, &converged);
+  return(List::create(_["solution"] = solution,
+                      _["converged"] = converged,
+                      _["A"] = A_dense));
 }
 
 std::tuple< arma::vec, arma::mat> get_B_pl(arma::uvec i_vec, 
@@ -1429,55 +2597,20 @@ std::tuple< arma::vec, arma::mat> get_B_pl(arma::uvec i_vec,
                                            arma::vec &coef_nondegrees, 
                                            double &offset_nonoverlap, 
                                            bool directed, 
-                                           int n_actor) {
-  arma::mat B_mat(coef_nondegrees.size(),coef_degrees.size());
-  arma::vec A_diag(coef_degrees.size()), res;
-  B_mat.fill(0);
-  arma::vec exp_tmp, cov_degrees(coef_degrees.size());
-  cov_degrees.fill(0);
-  unsigned int number_elements_network = i_vec.size();
+                                           int n_actor, 
+                                           const arma::vec &net_weights = arma::vec(), 
+                                           int n_threads = 1) {
   // For the calculation of B we only have to regard network information (relating to the first entries)
-  
-  for(unsigned int i = 0; i < number_elements_network; i++){
-    if(overlap_vec.at(i)){
-      if(directed) {
-        exp_tmp = arma::exp(std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1+ n_actor));  
-        cov_degrees.at(j_vec.at(i)-1+ n_actor) = 1;
-      } else {
-        exp_tmp = arma::exp(std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1));  
-        cov_degrees.at(j_vec.at(i)-1) = 1;
-      }
-    } else {
-      if(directed) {
-        exp_tmp = arma::exp(offset_nonoverlap + std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1 + n_actor));
-        cov_degrees.at(j_vec.at(i)-1+ n_actor) = 1;
-      } else {
-        exp_tmp = arma::exp(offset_nonoverlap + std::get<0>(pseudo_lh).row(i)*coef_nondegrees +
-          coef_degrees(i_vec.at(i)-1) + coef_degrees(j_vec.at(i)-1));
-        cov_degrees.at(j_vec.at(i)-1) = 1;
-      }
-    }
-    cov_degrees.at(i_vec.at(i)-1) = 1;
-    B_mat += exp_tmp.at(0)/(1+exp_tmp.at(0))*1/(1+exp_tmp.at(0))*
-      std::get<0>(pseudo_lh).row(i).t()*cov_degrees.t();
-    
-    res = exp_tmp.at(0)/(1+exp_tmp.at(0)) - pow(exp_tmp.at(0)/(1+exp_tmp.at(0)),2);
-    A_diag.at(i_vec.at(i)-1) += res.at(0);
-    cov_degrees.at(i_vec.at(i)-1) = 0;
-    if(directed) { 
-      cov_degrees.at(j_vec.at(i)-1 + n_actor) = 0;
-      A_diag.at(j_vec.at(i)-1 + n_actor) += res.at(0);
-      
-    } else {
-      cov_degrees.at(j_vec.at(i)-1) = 0;
-      A_diag.at(j_vec.at(i)-1) += res.at(0);
-      
-    }
-    
-  }
+  const arma::uword shift = directed ? n_actor : 0;
+  arma::vec prob = xyz_sigmoid(xyz_degree_base_eta(std::get<0>(pseudo_lh), overlap_vec, coef_nondegrees, offset_nonoverlap) +
+    coef_degrees.elem(i_vec - 1) + coef_degrees.elem(j_vec - 1 + shift));
+  arma::vec var = prob % (1.0 - prob);
+  if (net_weights.n_elem > 0) var %= net_weights;
+  
+  arma::mat B_mat(coef_nondegrees.n_elem, coef_degrees.n_elem, arma::fill::zeros);
+  arma::vec A_diag(coef_degrees.n_elem, arma::fill::zeros);
+  xyz_degree_scatter(i_vec, j_vec, shift, var, A_diag, n_threads);
+  xyz_degree_scatter_rows(std::get<0>(pseudo_lh), i_vec, j_vec, shift, var, B_mat, n_threads);
   return(std::tuple<arma::vec, arma::mat> {A_diag,B_mat});
 }
 
@@ -1678,6 +2811,30 @@ std::tuple<arma::vec, arma::vec, arma::mat, arma::mat> cond_estimation_nondegree
   return(std::tuple<arma::vec, arma::vec, arma::mat, arma::mat> {coef,score, fisher, coefs.rows(0,k-1)});
 }
 
+// Residuals and variances (the working weights of the Fisher scoring) of
+// attribute rows with responses y and linear predictor eta, so that
+// X' res and X' diag(var) X are their score and Fisher information
+void xyz_attribute_moments(const std::string &type, double scale,
+                           const arma::vec &eta, const arma::vec &y,
+                           arma::vec &res, arma::vec &var) {
+  if (type == "binomial") {
+    arma::vec exp_eta = arma::exp(eta);
+    arma::vec prob = exp_eta / (1.0 + exp_eta);
+    res = y - prob;
+    var = prob % (1.0 - prob);
+  } else if (type == "poisson") {
+    arma::vec mu = arma::exp(eta);
+    res = y - mu;
+    var = mu;
+  } else if (type == "normal") {
+    res = (y - eta) / scale;
+    var = arma::vec(eta.n_elem, arma::fill::value(1.0 / scale));
+  } else {
+    res = arma::vec(eta.n_elem, arma::fill::zeros);
+    var = arma::vec(eta.n_elem, arma::fill::zeros);
+  }
+}
+
 std::tuple<arma::vec, arma::vec, arma::mat, arma::mat> 
   cond_estimation_nondegrees_pl(
     arma::vec coef,
@@ -1695,7 +2852,9 @@ std::tuple<arma::vec, arma::vec, arma::mat, arma::mat>
     std::string attr_y_type,
     double x_scale,
     double y_scale,
-    bool fix_x) {
+    bool fix_x,
+    const arma::vec &net_weights = arma::vec(),
+    int n_threads = 1) {
     
     int n_coef = coef.size();
     unsigned int n_actor = coef_degrees.n_elem / 2;
@@ -1705,23 +2864,12 @@ std::tuple<arma::vec, arma::vec, arma::mat, arma::mat>
     const arma::mat& X_all = std::get<0>(pseudo_lh);
     const arma::vec& Y_all = std::get<1>(pseudo_lh);
     
-    // --- 1. Define subviews for each component ---
-    // Network component is always present
-    const arma::mat X_net = X_all.rows(0, n_net - 1);
+    // --- 1. Row ranges of each component ---
+    // The network rows come first, followed by the rows of x (unless fix_x) and y.
+    // The design is only read through these ranges and never copied.
+    const arma::uword n_rows = X_all.n_rows;
+    const arma::uword x_from = n_net, y_from = n_net + (fix_x ? 0 : n_actor);
     const arma::vec Y_net = Y_all.subvec(0, n_net - 1);
-    arma::mat X_x, X_y;
-    arma::vec Y_x, Y_y;
-    
-    if (fix_x == false) {
-      X_x = X_all.rows(n_net, n_net + n_actor - 1);
-      Y_x = Y_all.subvec(n_net, n_net + n_actor - 1);
-      
-      X_y = X_all.rows(n_net + n_actor, X_all.n_rows - 1);
-      Y_y = Y_all.subvec(n_net + n_actor, Y_all.n_elem - 1);
-    } else {
-      X_y = X_all.rows(n_net, X_all.n_rows - 1);
-      Y_y = Y_all.subvec(n_net, Y_all.n_elem - 1);
-    }
     
     // Pre-calculate network offsets
     const arma::vec net_offsets = (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
@@ -1749,66 +2897,41 @@ std::tuple<arma::vec, arma::vec, arma::mat, arma::mat>
       score.zeros();
       fisher.zeros();
       
+      arma::vec eta = design_times(X_all, 0, n_rows, coef, n_threads);
+      arma::vec res(n_rows), var(n_rows), res_attr, var_attr;
+      
       // --- Component 1: Network (Logistic Model) ---
-      arma::vec eta_net = X_net * coef + net_offsets + 
+      arma::vec eta_net = eta.head(n_net) + net_offsets + 
         coef_degrees.elem(i_pop_indices) + 
         coef_degrees.elem(j_pop_indices);
       
       arma::vec exp_eta_net = arma::exp(eta_net);
       arma::vec prob_net = exp_eta_net / (1.0 + exp_eta_net);
       arma::vec var_net = prob_net % (1.0 - prob_net);
-      
-      score += X_net.t() * (Y_net - prob_net);
-      fisher += X_net.t() * arma::diagmat(var_net) * X_net;
+      arma::vec res_net = Y_net - prob_net;
+      // Rows of a compressed design (see xyz_compressed_pl_rows) count with their multiplicity
+      if (net_weights.n_elem > 0) {
+        res_net %= net_weights;
+        var_net %= net_weights;
+      }
+      res.head(n_net) = res_net;
+      var.head(n_net) = var_net;
       
       // --- Component 2: Attribute 'x' ---
       if (fix_x == false) {
-        if (attr_x_type == "binomial") {
-          arma::vec eta_x = X_x * coef;
-          arma::vec exp_eta_x = arma::exp(eta_x);
-          arma::vec prob_x = exp_eta_x / (1.0 + exp_eta_x);
-          arma::vec var_x = prob_x % (1.0 - prob_x);
-          
-          score += X_x.t() * (Y_x - prob_x);
-          fisher += X_x.t() * arma::diagmat(var_x) * X_x;
-          
-        } else if (attr_x_type == "poisson") {
-          arma::vec eta_x = X_x * coef;
-          arma::vec mu_x = arma::exp(eta_x);
-          
-          score += X_x.t() * (Y_x - mu_x);
-          fisher += X_x.t() * arma::diagmat(mu_x) * X_x;
-          
-        } else if (attr_x_type == "normal") {
-          arma::vec mu_x = X_x * coef; 
-          score += X_x.t() * (Y_x - mu_x) / x_scale;
-          fisher += (X_x.t() * X_x) / x_scale;
-        }
+        xyz_attribute_moments(attr_x_type, x_scale, eta.subvec(x_from, y_from - 1),
+                              Y_all.subvec(x_from, y_from - 1), res_attr, var_attr);
+        res.subvec(x_from, y_from - 1) = res_attr;
+        var.subvec(x_from, y_from - 1) = var_attr;
       }
       
       // --- Component 3: Attribute 'y' ---
-      if (attr_y_type == "binomial") {
-        arma::vec eta_y = X_y * coef;
-        arma::vec exp_eta_y = arma::exp(eta_y);
-        arma::vec prob_y = exp_eta_y / (1.0 + exp_eta_y);
-        arma::vec var_y = prob_y % (1.0 - prob_y);
-        
-        score += X_y.t() * (Y_y - prob_y);
-        fisher += X_y.t() * arma::diagmat(var_y) * X_y;
-        
-      } else if (attr_y_type == "poisson") {
-        arma::vec eta_y = X_y * coef;
-        arma::vec mu_y = arma::exp(eta_y);
-        
-        score += X_y.t() * (Y_y - mu_y);
-        fisher += X_y.t() * arma::diagmat(mu_y) * X_y;
-        
-      } else if (attr_y_type == "normal") {
-        arma::vec mu_y = X_y * coef;
-        
-        score += X_y.t() * (Y_y - mu_y) / y_scale;
-        fisher += (X_y.t() * X_y) / y_scale;
-      }
+      xyz_attribute_moments(attr_y_type, y_scale, eta.subvec(y_from, n_rows - 1),
+                            Y_all.subvec(y_from, n_rows - 1), res_attr, var_attr);
+      res.subvec(y_from, n_rows - 1) = res_attr;
+      var.subvec(y_from, n_rows - 1) = var_attr;
+      
+      weighted_crossprod(X_all, 0, n_rows, var, res, score, fisher, n_threads);
       // Rcout << "Iteration " << k << score << std::endl;
       // Rcout << "Iteration " << k << fisher << std::endl;
       // --- 4. Update and Check Convergence ---
@@ -1843,7 +2966,10 @@ double calculate_llh(
     int n_actor,
     bool fix_x, 
     bool fix_z, 
-    bool nonoverlap_random) {
+    bool nonoverlap_random,
+    const arma::vec &net_weights = arma::vec(),
+    const arma::fmat &X_net_single = arma::fmat(),
+    int n_threads = 1) {
   // Rcout << "Start" << std::endl;
   
   if(coef_degrees.size() ==1){
@@ -1858,26 +2984,27 @@ double calculate_llh(
     }
   }
   unsigned int n_net = i_vec.n_elem*!fix_z;
+  // If the network rows of the design are given in X_net_single, X_all only
+  // holds the rows of the attributes (Y_all still holds all responses)
+  const bool single = X_net_single.n_rows > 0;
+  unsigned int n_net_x = n_net*!single;
   // Rcout << coef_degrees.n_elem << std::endl;
   const arma::mat& X_all = std::get<0>(pseudo_lh);
   const arma::vec& Y_all = std::get<1>(pseudo_lh);
   
   
-  arma::mat X_x, X_y, X_net;
+  // Rows of x and y in X_all (the design is read through these ranges, not copied)
+  const arma::uword x_from = n_net_x, y_from = n_net_x + (fix_x ? 0 : n_actor);
   arma::vec Y_x, Y_y, Y_net;
   
   if (fix_z == false) {
-    X_net = X_all.rows(0, n_net - 1);
     Y_net = Y_all.subvec(0, n_net - 1);  
   }
   // Rcout << "c" << std::endl;
   if (fix_x == false) {
-    X_x = X_all.rows(n_net, n_net + n_actor - 1);
     Y_x = Y_all.subvec(n_net, n_net + n_actor - 1);
-    X_y = X_all.rows(n_net + n_actor, X_all.n_rows - 1);
     Y_y = Y_all.subvec(n_net + n_actor, Y_all.n_elem - 1);
   } else {
-    X_y = X_all.rows(n_net, X_all.n_rows - 1);
     Y_y = Y_all.subvec(n_net, Y_all.n_elem - 1);
   }
   // Rcout << "b" << std::endl;
@@ -1894,7 +3021,8 @@ double calculate_llh(
   double llh = 0.0;
   // --- Component 1: Network (Logistic Model) ---
   if (fix_z == false) {
-    arma::vec eta_net = X_net * coef + net_offsets +
+    arma::vec eta_net = (single ? design_times(X_net_single, 0, n_net, coef, n_threads) :
+                         design_times(X_all, 0, n_net, coef, n_threads)) + net_offsets +
       coef_degrees.elem(i_pop_indices) +
       coef_degrees.elem(j_pop_indices);
     arma::vec exp_eta_net = arma::exp(eta_net);
@@ -1902,25 +3030,28 @@ double calculate_llh(
     if (!nonoverlap_random) {
       llh_contributions = overlap_vec % llh_contributions;
     }
+    if (net_weights.n_elem > 0) {
+      llh_contributions %= net_weights;
+    }
     llh += arma::sum(llh_contributions);
   }
   // --- Component 2: Attribute 'x' ---
   if (fix_x == false) {
     if (attr_x_type == "binomial") {
       // logL = sum( Y*eta - log(1 + exp(eta)) )
-      arma::vec eta_x = X_x * coef;
+      arma::vec eta_x = design_times(X_all, x_from, y_from, coef);
       arma::vec exp_eta_x = arma::exp(eta_x);
       llh += arma::sum(Y_x % eta_x - arma::log1p(exp_eta_x));
       
     } else if (attr_x_type == "poisson") {
       // logL = sum( Y*eta - exp(eta) - lgamma(Y+1) )
-      arma::vec eta_x = X_x * coef;
+      arma::vec eta_x = design_times(X_all, x_from, y_from, coef);
       arma::vec mu_x = arma::exp(eta_x);
       llh += arma::sum(Y_x % eta_x - mu_x - arma::lgamma(Y_x + 1.0));
       
     } else if (attr_x_type == "normal") {
       // logL = sum( -0.5*log(2*pi*scale) - (Y - mu)^2 / (2*scale) )
-      arma::vec mu_x = X_x * coef;
+      arma::vec mu_x = design_times(X_all, x_from, y_from, coef);
       double const_x = -0.5 * std::log(2.0 * M_PI * x_scale);
       llh += arma::sum(const_x - arma::pow(Y_x - mu_x, 2) / (2.0 * x_scale));
     }
@@ -1930,19 +3061,19 @@ double calculate_llh(
   // --- Component 3: Attribute 'y' ---
   if (attr_y_type == "binomial") {
     // logL = sum( Y*eta - log(1 + exp(eta)) )
-    arma::vec eta_y = X_y * coef;
+    arma::vec eta_y = design_times(X_all, y_from, X_all.n_rows, coef);
     arma::vec exp_eta_y = arma::exp(eta_y);
     llh += arma::sum(Y_y % eta_y - arma::log1p(exp_eta_y));
     
   } else if (attr_y_type == "poisson") {
     // logL = sum( Y*eta - exp(eta) - lgamma(Y+1) )
-    arma::vec eta_y = X_y * coef;
+    arma::vec eta_y = design_times(X_all, y_from, X_all.n_rows, coef);
     arma::vec mu_y = arma::exp(eta_y);
     llh += arma::sum(Y_y % eta_y - mu_y - arma::lgamma(Y_y + 1.0));
     
   } else if (attr_y_type == "normal") {
     // logL = sum( -0.5*log(2*pi*scale) - (Y - mu)^2 / (2*scale) )
-    arma::vec mu_y = X_y * coef;
+    arma::vec mu_y = design_times(X_all, y_from, X_all.n_rows, coef);
     double const_y = -0.5 * std::log(2.0 * M_PI * y_scale);
     llh += arma::sum(const_y - arma::pow(Y_y - mu_y, 2) / (2.0 * y_scale));
   }
@@ -1965,7 +3096,9 @@ arma::mat get_C_new(
     const std::string& attr_x_type,
     const std::string& attr_y_type,
     double attr_x_scale,
-    double attr_y_scale)
+    double attr_y_scale,
+    const arma::vec &net_weights = arma::vec(),
+    int n_threads = 1)
 {
   unsigned int n_actor;
   if (directed) {
@@ -1978,25 +3111,13 @@ arma::mat get_C_new(
   
   // full design matrix and response (pseudo_lh)
   const arma::mat& X_all = std::get<0>(pseudo_lh);
-  const arma::vec& Y_all = std::get<1>(pseudo_lh);
-  const arma::mat X_net = X_all.rows(0, n_net - 1);
-  
-  arma::mat X_x; arma::vec Y_x;
-  arma::mat X_y; arma::vec Y_y;
-  
-  if (!fix_x) {
-    X_x = X_all.rows(n_net, n_net + n_actor - 1);
-    Y_x = Y_all.subvec(n_net, n_net + n_actor - 1);
-    
-    X_y = X_all.rows(n_net + n_actor, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net + n_actor, Y_all.n_elem - 1);
-  } else { 
-    X_y = X_all.rows(n_net, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net, Y_all.n_elem - 1);
-  }
+  // rows of x and y, the design is read through these ranges and never copied
+  const arma::uword x_from = n_net, y_from = n_net + (fix_x ? 0 : n_actor);
+  const arma::uword n_rows = X_all.n_rows;
+  const arma::vec eta = design_times(X_all, 0, n_rows, coef, n_threads);
   // 1) network block, which is logistic
   arma::vec net_offsets = (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
-  arma::vec eta_net = X_net * coef + net_offsets + coef_degrees.elem(i_vec-1) + coef_degrees.elem(j_vec-1+ n_actor*directed);
+  arma::vec eta_net = eta.head(n_net) + net_offsets + coef_degrees.elem(i_vec-1) + coef_degrees.elem(j_vec-1+ n_actor*directed);
   arma::vec exp_eta_net = arma::exp(eta_net);
   arma::vec prob_net(eta_net.n_elem);
   
@@ -2012,6 +3133,9 @@ arma::mat get_C_new(
     prob_net.elem(nonpos_idx) = exp_eta_neg / (1.0 + exp_eta_neg);
   }
   arma::vec var_net = prob_net % (1.0 - prob_net);
+  if (net_weights.n_elem > 0) {
+    var_net %= net_weights;
+  }
   
   // Prepare w vector of length X_all.n_rows
   arma::vec w(X_all.n_rows, arma::fill::zeros);
@@ -2029,47 +3153,45 @@ arma::mat get_C_new(
   if (!fix_x) {
     arma::vec var_x;
     if (attr_x_type == "binomial") {
-      arma::vec eta_x = X_x * coef;
+      arma::vec eta_x = eta.subvec(x_from, y_from - 1);
       arma::vec ex = arma::exp(eta_x);
       arma::vec p = ex / (1.0 + ex);
       var_x = p % (1.0 - p);
     } else if (attr_x_type == "poisson") { 
-      arma::vec eta_x = X_x * coef;
+      arma::vec eta_x = eta.subvec(x_from, y_from - 1);
       arma::vec mu = arma::exp(eta_x);
       var_x = mu;               // variance = mu
     } else if (attr_x_type == "normal") { 
       // For normal, variance is constant = attr_x_scale
-      var_x = arma::vec(X_x.n_rows, arma::fill::value(1.0/attr_x_scale));
+      var_x = arma::vec(y_from - x_from, arma::fill::value(1.0/attr_x_scale));
     } else { 
       Rcpp::stop("Unknown attr_x_type: must be 'binomial', 'poisson' or 'normal'.");
     } 
     // place into w
-    w.rows(n_net, n_net + X_x.n_rows - 1) = var_x;
+    w.rows(x_from, y_from - 1) = var_x;
     // Rcout << "Mean variance x block: " << arma::mean(var_x) << std::endl;
   } 
   
   // 3) attribute y
   arma::vec var_y;
   if (attr_y_type == "binomial") {
-    arma::vec eta_y = X_y * coef;
+    arma::vec eta_y = eta.subvec(y_from, n_rows - 1);
     arma::vec ey = arma::exp(eta_y);
     arma::vec p = ey / (1.0 + ey);
     var_y = p % (1.0 - p);
   } else if (attr_y_type == "poisson") { 
-    arma::vec eta_y = X_y * coef;
+    arma::vec eta_y = eta.subvec(y_from, n_rows - 1);
     arma::vec mu = arma::exp(eta_y);
     var_y = mu;
   } else if (attr_y_type == "normal") { 
-    var_y = arma::vec(X_y.n_rows, arma::fill::value(1.0/attr_y_scale));
+    var_y = arma::vec(n_rows - y_from, arma::fill::value(1.0/attr_y_scale));
   } else { 
     Rcpp::stop("Unknown attr_y_type: must be 'binomial', 'poisson' or 'normal'.");
   } 
-  arma::uword start_y;
-  if (!fix_x) start_y = n_net + X_x.n_rows;
-  else start_y = n_net;
-  w.rows(start_y, start_y + X_y.n_rows - 1) = var_y;
-  arma::mat X_weighted = X_all.each_col() % w;
-  arma::mat fisher = X_all.t() * X_weighted;
+  w.rows(y_from, n_rows - 1) = var_y;
+  arma::mat fisher(X_all.n_cols, X_all.n_cols, arma::fill::zeros);
+  arma::vec no_score;
+  weighted_crossprod(X_all, 0, n_rows, w, arma::vec(), no_score, fisher, n_threads);
   return fisher; 
 }
 
@@ -2103,14 +3225,14 @@ arma::mat get_C(arma::vec coef, arma::uvec &i_vec,
   
   const arma::mat& X = std::get<0>(pseudo_lh);
   const arma::vec& w = prob % (1 - prob);
-  arma::mat X_weighted = X.each_col() % w;
-  // arma::mat cov_degrees_weighted = cov_degrees.each_col() % w;
-  arma::mat fisher_alt = X.t() * X_weighted;
+  arma::mat fisher_alt(X.n_cols, X.n_cols, arma::fill::zeros);
+  arma::vec no_score;
+  weighted_crossprod(X, 0, X.n_rows, w, arma::vec(), no_score, fisher_alt);
   return fisher_alt;
   
 }
 
-std::tuple<arma::vec,arma::vec, arma::mat, arma::mat>  cond_estimation_degrees_pl(arma::vec coef, 
+std::tuple<arma::vec,arma::vec, arma::mat>  cond_estimation_degrees_pl(arma::vec coef, 
                                                                                   arma::uvec &i_vec, 
                                                                                   arma::uvec  &j_vec,
                                                                                   arma::uvec  &overlap_vec,
@@ -2120,10 +3242,11 @@ std::tuple<arma::vec,arma::vec, arma::mat, arma::mat>  cond_estimation_degrees_p
                                                                                   double tol, 
                                                                                   arma::vec coef_nondegrees, 
                                                                                   double offset_nonoverlap, 
-                                                                                  arma::mat A_inv, 
                                                                                   int it, 
                                                                                   bool &non_stop, 
-                                                                                  bool nonoverlap_random) {
+                                                                                  bool nonoverlap_random, 
+                                                                                  const arma::vec &net_weights = arma::vec(), 
+                                                                                  int n_threads = 1) {
   int n_actor;
   if(directed){
     n_actor = coef.n_elem/2;
@@ -2142,49 +3265,28 @@ std::tuple<arma::vec,arma::vec, arma::mat, arma::mat>  cond_estimation_degrees_p
     score.fill(0);
     coefs.reshape(max_iteration+1,n_actor);
   }
-  arma::vec weights, exp_tmp; 
+  const arma::uword shift = directed ? n_actor : 0;
+  // The other terms are held fixed, so their part of the predictor is computed once
+  const arma::vec base_eta = xyz_degree_base_eta(std::get<0>(pseudo_lh), overlap_vec, coef_nondegrees, offset_nonoverlap);
+  const arma::vec Y_net = std::get<1>(pseudo_lh).head(i_vec.n_elem);
+  const arma::vec overlap_net = arma::conv_to<arma::vec>::from(overlap_vec);
+  arma::vec prob, resid;
   coefs.row(0)= coef.t();
   bool non_converged = true;
   int k = 1;
   while(non_converged) {
-    for(int i: seq(0,i_vec.size() -1)){
-      if(directed){
-        if(overlap_vec.at(i)){
-          exp_tmp = arma::exp((coef.at(i_vec.at(i)-1) +
-            coef.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-        } else {
-          if(nonoverlap_random){
-            exp_tmp = arma::exp(offset_nonoverlap+(coef.at(i_vec.at(i)-1) +
-              coef.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);    
-          } else {
-            exp_tmp = 0.0;
-          }
-          
-        }
-        weights = exp_tmp/(1+exp_tmp);
-        if(j_vec.at(i) != n_actor){
-          score.at(j_vec.at(i)-1+ n_actor) += std::get<1>(pseudo_lh).at(i) - weights.at(0);
-        }
-      } else {
-        if(overlap_vec.at(i)){
-          exp_tmp = arma::exp( (coef.at(i_vec.at(i)-1) + 
-            coef.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-        } else {
-          if(nonoverlap_random){
-            exp_tmp = arma::exp(offset_nonoverlap+(coef.at(i_vec.at(i)-1) + 
-              coef.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);  
-          } else {
-            exp_tmp = 0.0;
-          }
-          
-        }
-        weights = exp_tmp/(1+exp_tmp);
-        score.at(j_vec.at(i)-1) += std::get<1>(pseudo_lh).at(i) - weights.at(0);
-        
-      }
-      score.at(i_vec.at(i)-1) +=  std::get<1>(pseudo_lh).at(i) - weights.at(0);
+    prob = xyz_sigmoid(base_eta + coef.elem(i_vec - 1) + coef.elem(j_vec - 1 + shift));
+    if(!nonoverlap_random){
+      prob %= overlap_net;
+    }
+    resid = Y_net - prob;
+    if (net_weights.n_elem > 0) resid %= net_weights;
+    xyz_degree_scatter(i_vec, j_vec, shift, resid, score, n_threads);
+    if(directed){
+      // The in-degree parameter of the last actor is fixed
+      score.at(2*n_actor - 1) = 0;
     }
-    coef += (A_inv*score);
+    coef += xyz_degree_bound_solve(score, n_actor, directed);
     coefs.row(k) = coef.t();
     // If the maximal value of iterations is met end the estimation also if the convergence criteria is met 
     // (otherwise start another iteration and reset score and info)
@@ -2200,7 +3302,6 @@ std::tuple<arma::vec,arma::vec, arma::mat, arma::mat>  cond_estimation_degrees_p
     k++;
   } 
   
-  arma::vec coef_MM = coef + A_inv*score;
   // arma::vec exp_tmp_MM,  exp_rest; 
   // // TODO update the calculation of the llh 
   // double ll_MM,  ll_attributes; 
@@ -2232,11 +3333,11 @@ std::tuple<arma::vec,arma::vec, arma::mat, arma::mat>  cond_estimation_degrees_p
   //   
   // }
   // double llh_alt; 
-  return(std::tuple<arma::vec, arma::vec, arma::mat, arma::mat> {coef,score, A_inv, coefs.rows(0,k-1)});
+  return(std::tuple<arma::vec, arma::vec, arma::mat> {coef,score, coefs.rows(0,k-1)});
 }
 
 
-std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_pl_accelerated(arma::vec coef, 
+std::tuple<arma::vec,arma::vec, arma::mat>  cond_estimation_degrees_pl_accelerated(arma::vec coef, 
                                                                                                arma::uvec &i_vec, 
                                                                                                arma::uvec  &j_vec,
                                                                                                arma::uvec  &overlap_vec,
@@ -2246,14 +3347,15 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
                                                                                                double tol, 
                                                                                                arma::vec coef_nondegrees, 
                                                                                                double offset_nonoverlap, 
-                                                                                               arma::mat A_inv, 
                                                                                                bool &non_stop, 
                                                                                                arma::vec & old_score_pop, 
                                                                                                arma::vec & old_coef_pop, 
-                                                                                               arma::mat & old_M, 
+                                                                                               LowRankUpdate & old_M, 
                                                                                                int it, 
                                                                                                bool first_it, 
-                                                                                               bool nonoverlap_random) {
+                                                                                               bool nonoverlap_random, 
+                                                                                               const arma::vec &net_weights = arma::vec(), 
+                                                                                               int n_threads = 1) {
   int n_actor;
   if(directed){
     n_actor = coef.n_elem/2;
@@ -2261,8 +3363,8 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
     n_actor = coef.n_elem;
   }
   
-  // Define the additional stuff needed for the quasi Newton acceleration
-  arma::mat M_new;
+  // Define the additional stuff needed for the quasi Newton acceleration,
+  // M is a sum of rank-one updates (see LowRankUpdate)
   
   arma::vec  score, score_old;
   arma::mat  coefs;
@@ -2279,7 +3381,18 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
     score_old.fill(0);
     coefs.reshape(max_iteration+1,n_actor);
   }
-  arma::vec weights,weights_old,  exp_tmp, exp_tmp_old; 
+  const arma::uword shift = directed ? n_actor : 0;
+  // The other terms are held fixed, so their part of the predictor is computed once
+  const arma::uword n_net = i_vec.n_elem;
+  const arma::vec lin_net = std::get<0>(pseudo_lh).head_rows(n_net) * coef_nondegrees;
+  const arma::vec base_eta = lin_net + (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
+  const arma::vec Y_net = std::get<1>(pseudo_lh).head(n_net);
+  const arma::vec overlap_net = arma::conv_to<arma::vec>::from(overlap_vec);
+  arma::vec prob, prob_old, resid, resid_old;
+  // Sum over the network rows, weighted if the dyads are a sample
+  auto net_sum = [&net_weights](const arma::vec &v) {
+    return (net_weights.n_elem > 0) ? arma::dot(net_weights, v) : arma::accu(v);
+  };
   coefs.row(0)= coef.t();
   if(first_it){
     old_coef_pop = coef;
@@ -2288,63 +3401,30 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
   bool non_converged = true;
   int k = 1;
   while(non_converged) {
-    for(int i: seq(0,i_vec.size() -1)){
-      if(directed){
-        if(overlap_vec.at(i)){
-          exp_tmp = arma::exp((coef.at(i_vec.at(i)-1) +
-            coef.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-          exp_tmp_old = arma::exp((old_coef_pop.at(i_vec.at(i)-1) +
-            old_coef_pop.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-          
-        } else {
-          if(nonoverlap_random){
-            exp_tmp = arma::exp(offset_nonoverlap+(coef.at(i_vec.at(i)-1) +
-              coef.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);  
-            exp_tmp_old =  arma::exp(offset_nonoverlap+(old_coef_pop.at(i_vec.at(i)-1) +
-              old_coef_pop.at(j_vec.at(i)-1 + n_actor)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);  
-          }else {
-            exp_tmp = 0.0; 
-            exp_tmp_old= 0.0; 
-          }
-        }
-        weights = exp_tmp/(1+exp_tmp);
-        weights_old = exp_tmp_old/(1+exp_tmp_old);
-        if(j_vec.at(i) != n_actor){
-          score.at(j_vec.at(i)-1+ n_actor) += std::get<1>(pseudo_lh).at(i) - weights.at(0);
-          score_old.at(j_vec.at(i)-1+ n_actor) += std::get<1>(pseudo_lh).at(i) - weights_old.at(0);  
-        }
-      } else {
-        if(overlap_vec.at(i)){
-          exp_tmp = arma::exp( (coef.at(i_vec.at(i)-1) + 
-            coef.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-          exp_tmp_old = arma::exp( (old_coef_pop.at(i_vec.at(i)-1) + 
-            old_coef_pop.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-        } else { 
-          if(nonoverlap_random){
-            exp_tmp = arma::exp(offset_nonoverlap+(coef.at(i_vec.at(i)-1) + 
-              coef.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-            exp_tmp_old =  arma::exp(offset_nonoverlap+(old_coef_pop.at(i_vec.at(i)-1) + 
-              old_coef_pop.at(j_vec.at(i)-1)) + std::get<0>(pseudo_lh).row(i)*coef_nondegrees);
-          } else {
-            exp_tmp = 0.0; 
-            exp_tmp_old= 0.0; 
-          }
-        } 
-        
-        weights = exp_tmp/(1+exp_tmp);
-        weights_old = exp_tmp_old/(1+exp_tmp_old);
-        score.at(j_vec.at(i)-1) += std::get<1>(pseudo_lh).at(i) - weights.at(0);
-        score_old.at(j_vec.at(i)-1) += std::get<1>(pseudo_lh).at(i) - weights_old.at(0);
-      } 
-      score.at(i_vec.at(i)-1) +=  std::get<1>(pseudo_lh).at(i) - weights.at(0);
-      score_old.at(i_vec.at(i)-1) +=  std::get<1>(pseudo_lh).at(i) - weights_old.at(0);
-    } 
+    prob = xyz_sigmoid(base_eta + coef.elem(i_vec - 1) + coef.elem(j_vec - 1 + shift));
+    prob_old = xyz_sigmoid(base_eta + old_coef_pop.elem(i_vec - 1) + old_coef_pop.elem(j_vec - 1 + shift));
+    if(!nonoverlap_random){
+      prob %= overlap_net;
+      prob_old %= overlap_net;
+    }
+    resid = Y_net - prob;
+    resid_old = Y_net - prob_old;
+    if (net_weights.n_elem > 0) {
+      resid %= net_weights;
+      resid_old %= net_weights;
+    }
+    xyz_degree_scatter(i_vec, j_vec, shift, resid, score, n_threads);
+    xyz_degree_scatter(i_vec, j_vec, shift, resid_old, score_old, n_threads);
+    if(directed){
+      // The in-degree parameter of the last actor is fixed
+      score.at(2*n_actor - 1) = 0;
+      score_old.at(2*n_actor - 1) = 0;
+    }
     
     // Rcout <<score.at(2*n_actor-1) << std::endl;
     // Rcout <<coef.at(2*n_actor-1) << std::endl;
     
     if(first_it){
-      M_new = old_M;
       old_score_pop = score;
       old_coef_pop = coef;
     } else {
@@ -2357,51 +3437,20 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
       arma::vec coef_change_pop = coef - old_coef_pop;
       old_coef_pop = coef;
       
-      arma::vec r_new = coef_change_pop  + A_inv*score_change_pop;
-      arma::vec q_new = r_new - old_M*score_change_pop;
-      arma::vec c_new_alt = q_new.t()*score_change_pop;
-      M_new = old_M + q_new*q_new.t()/c_new_alt.at(0);
-      old_M = M_new;
+      arma::vec r_new = coef_change_pop  + xyz_degree_bound_solve(score_change_pop, n_actor, directed);
+      arma::vec q_new = r_new - old_M.times(score_change_pop);
+      old_M.add(q_new, arma::dot(q_new, score_change_pop));
     }
     
-    arma::vec coef_MM = coef + A_inv*score;
-    arma::vec coef_accel = coef + (A_inv-M_new)*score;
-    arma::vec exp_tmp_MM, exp_tmp_accel; 
-    double ll_MM, ll_accel; 
-    if(directed){
-      exp_tmp_MM = arma::exp(offset_nonoverlap+(coef_MM.elem(i_vec  -1) +
-        coef_MM.elem(j_vec  -1 + n_actor)) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees);
-      exp_tmp_accel = arma::exp(offset_nonoverlap+(coef_accel.elem(i_vec  -1) +
-        coef_accel.elem(j_vec  -1 + n_actor)) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees);
-      // exp_rest = arma::exp(std::get<0>(pseudo_lh).tail_rows(2*n_actor)*coef_nondegrees);
-      arma::vec log_one_min_pi_MM =  - log(1+exp_tmp_MM);
-      arma::vec log_one_min_pi_accel =  - log(1+exp_tmp_accel);
-      // arma::vec log_one_min_pi_rest =  - log(1+exp_rest);
-      
-      ll_MM = sum(log_one_min_pi_MM + std::get<1>(pseudo_lh).head_rows(i_vec.size())%(offset_nonoverlap+coef_MM.elem(i_vec-1) +
-        coef_MM.elem(j_vec  -1 + n_actor) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees));
-      ll_accel = sum(log_one_min_pi_accel + std::get<1>(pseudo_lh).head_rows(i_vec.size())%(offset_nonoverlap+ coef_accel.elem(i_vec-1) +
-        coef_accel.elem(j_vec  -1 + n_actor) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees));
-      // ll_attributes =  sum(log_one_min_pi_rest + std::get<1>(pseudo_lh).tail_rows(2*n_actor)%
-      //   (std::get<0>(pseudo_lh).tail_rows(2*n_actor)*coef_nondegrees));
-    } else {
-      exp_tmp_MM = arma::exp(offset_nonoverlap+(coef_MM.elem(i_vec  -1) +
-        coef_MM.elem(j_vec  -1)) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees);
-      exp_tmp_accel = arma::exp(offset_nonoverlap+(coef_accel.elem(i_vec  -1) +
-        coef_accel.elem(j_vec  -1)) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees);
-      // exp_rest = arma::exp(std::get<0>(pseudo_lh).tail_rows(2*n_actor)*coef_nondegrees);
-      arma::vec log_one_min_pi_MM =  - log(1+exp_tmp_MM);
-      arma::vec log_one_min_pi_accel =  - log(1+exp_tmp_accel);
-      // arma::vec log_one_min_pi_rest =  - log(1+exp_rest);
-      
-      ll_MM = sum(log_one_min_pi_MM + std::get<1>(pseudo_lh).head_rows(i_vec.size())%(offset_nonoverlap+coef_MM.elem(i_vec-1) +
-        coef_MM.elem(j_vec  -1) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees));
-      ll_accel = sum(log_one_min_pi_accel + std::get<1>(pseudo_lh).head_rows(i_vec.size())%(offset_nonoverlap+ coef_accel.elem(i_vec-1) +
-        coef_accel.elem(j_vec  -1) + std::get<0>(pseudo_lh).head_rows(i_vec.size())*coef_nondegrees));
-      // ll_attributes =  sum(log_one_min_pi_rest + std::get<1>(pseudo_lh).tail_rows(2*n_actor)%
-      //   (std::get<0>(pseudo_lh).tail_rows(2*n_actor)*coef_nondegrees));
-      
-    }
+    arma::vec step_MM = xyz_degree_bound_solve(score, n_actor, directed);
+    arma::vec coef_MM = coef + step_MM;
+    arma::vec coef_accel = coef + step_MM - old_M.times(score);
+    // log-likelihoods of the network rows at both candidates
+    auto ll_net = [&](const arma::vec &coef_cand) {
+      arma::vec eta = offset_nonoverlap + coef_cand.elem(i_vec - 1) + coef_cand.elem(j_vec - 1 + shift) + lin_net;
+      return net_sum(Y_net % eta - arma::log1p(arma::exp(eta)));
+    };
+    double ll_MM = ll_net(coef_MM), ll_accel = ll_net(coef_accel);
     
     if(ll_accel>ll_MM){
       coef = coef_accel;
@@ -2428,7 +3477,7 @@ std::tuple<arma::vec,arma::vec, arma::mat , arma::mat>  cond_estimation_degrees_
     k++;
   }  
   
-  return(std::tuple<arma::vec, arma::vec, arma::mat, arma::mat> {coef,score, M_new, coefs.rows(0,k-1)});
+  return(std::tuple<arma::vec, arma::vec, arma::mat> {coef,score, coefs.rows(0,k-1)});
 }
 
 // arma::uvec find_target_indices(const std::vector<std::string>& source) {
@@ -2465,23 +3514,25 @@ List pl_estimation(arma::vec coef,
                    std::string attr_y_type, 
                    double attr_x_scale, 
                    double attr_y_scale, 
-                   bool nonoverlap_random) {
+                   bool nonoverlap_random, 
+                   int n_threads = 1, 
+                   bool compress_design = false, 
+                   double sample_fraction = 1.0, 
+                   int chunk_size = 0, 
+                   bool single_precision = false,
+                   Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue) {
   List res; 
   std::tuple<arma::mat,arma::vec> pseudo_lh;
   int n_actor = y_attribute.size();
+  // Filled by xyz_get_info_pl
   arma::uvec  i_vec, j_vec, overlap_vec; 
-  if(directed){
-    i_vec = arma::uvec(n_actor*(n_actor-1)); 
-    j_vec = arma::uvec(n_actor*(n_actor-1)); 
-    overlap_vec = arma::uvec(n_actor*(n_actor-1)); 
-  } else { 
-    i_vec= arma::uvec(n_actor*(n_actor-1)/2); 
-    j_vec= arma::uvec(n_actor*(n_actor-1)/2); 
-    overlap_vec = arma::uvec(n_actor*(n_actor-1)/2); 
-  } 
+  // Weights of the network rows, empty if every dyad enters once, and the sums
+  // of the squared sampling weights behind every row, empty without sampling
+  arma::vec net_weights, net_weights_sq;
   // Calculates the data in a suitable format -> a vector or 32 x p 
   // (being the dimension of the sufficient statistics) matrices corresponding to the data of each dyad
-  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, attr_x_type, attr_y_type,attr_x_scale, attr_y_scale);
+  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, attr_x_type, attr_y_type,attr_x_scale, attr_y_scale,
+                   StorageMode::automatic, xyz_group_labels(neighborhood_groups));
   
   int k = 1;
   bool non_converged = true;
@@ -2492,11 +3543,57 @@ List pl_estimation(arma::vec coef,
   }
   
   arma::vec exp_tmp, score_tmp; 
+  // With chunk_size > 0 only the attribute rows are kept in memory, the rows of
+  // the dyads are recomputed in chunks in every iteration (see xyz_for_each_pl_chunk)
+  const bool stream = chunk_size > 0 && !fix_z && sample_fraction >= 1.0;
+  const bool attr_only = fix_z || stream;
+  // The compressed network rows are hashed while they are evaluated (see
+  // xyz_compressed_pl_rows), so only the attribute rows are built here
+  bool compressed = compress_design && !attr_only;
+  const xyz_TermTable functions = xyz_change_statistics_generate_new(terms);
   pseudo_lh = xyz_get_info_pl(object,terms,data_list,type_list, display_progress,
-                              i_vec,j_vec, overlap_vec, n_actor, fix_x, fix_z);
+                              i_vec,j_vec, overlap_vec, n_actor, fix_x, attr_only || compressed, n_threads, 
+                              sample_fraction, &net_weights);
+  if (compressed) {
+    arma::mat X_net_c;
+    arma::vec Y_net_c;
+    arma::uword n_rows = 0;
+    compressed = xyz_compressed_pl_rows(object, functions, data_list, type_list, sample_fraction,
+                                        0, n_threads, X_net_c, Y_net_c,
+                                        i_vec, j_vec, overlap_vec, net_weights, net_weights_sq, n_rows);
+    if (compressed) {
+      std::get<0>(pseudo_lh) = arma::join_cols(X_net_c, std::get<0>(pseudo_lh));
+      std::get<1>(pseudo_lh) = arma::join_cols(Y_net_c, std::get<1>(pseudo_lh));
+      if (display_progress) {
+        Rcout << "Compressed the network part of the design matrix from " << n_rows
+              << " to " << i_vec.n_elem << " rows" << std::endl;
+      }
+    } else {
+      // Too few rows are shared, the full design is built instead
+      pseudo_lh = xyz_get_info_pl(object,terms,data_list,type_list, display_progress,
+                                  i_vec,j_vec, overlap_vec, n_actor, fix_x, false, n_threads, 
+                                  sample_fraction, &net_weights);
+    }
+  }
+  if (!compressed && net_weights.n_elem > 0) {
+    net_weights_sq = arma::square(net_weights);
+  }
   
   // arma::uvec where_wrong = find(arma::var(std::get<0>(pseudo_lh), 0) == 0);
-  arma::rowvec variances = arma::var(std::get<0>(pseudo_lh), 0, 0);
+  arma::rowvec variances;
+  if (stream) {
+    // Range of every column, 0 iff the statistic is constant
+    arma::rowvec col_min = arma::min(std::get<0>(pseudo_lh), 0);
+    arma::rowvec col_max = arma::max(std::get<0>(pseudo_lh), 0);
+    xyz_for_each_pl_chunk(object, functions, data_list, type_list, chunk_size, n_threads,
+                          [&](const arma::mat &X_c, const arma::vec &, const arma::vec &) {
+                            col_min = arma::min(col_min, arma::min(X_c, 0));
+                            col_max = arma::max(col_max, arma::max(X_c, 0));
+                          });
+    variances = col_max - col_min;
+  } else {
+    variances = arma::var(std::get<0>(pseudo_lh), 0, 0);
+  }
   
   
   
@@ -2555,23 +3652,29 @@ List pl_estimation(arma::vec coef,
   const arma::mat& X_all = std::get<0>(pseudo_lh);
   const arma::vec& Y_all = std::get<1>(pseudo_lh);
   
-  // --- 1. Define subviews for each component ---
-  arma::mat X_x, X_y, X_net;
+  // --- 1. Row ranges of each component ---
   arma::vec Y_x, Y_y, Y_net;
-  if(fix_z == false){
-    X_net = X_all.rows(0, n_net - 1);
+  // Network rows of the design in single precision, used instead of the
+  // first n_net rows of X_all
+  const bool use_float = single_precision && !attr_only;
+  arma::fmat X_net_f;
+  if(attr_only == false){
+    if (use_float) {
+      X_net_f = arma::conv_to<arma::fmat>::from(X_all.rows(0, n_net - 1));
+      // Only the attribute rows stay in double precision (see calculate_llh)
+      std::get<0>(pseudo_lh).shed_rows(0, n_net - 1);
+    }
     Y_net = Y_all.subvec(0, n_net - 1);  
   }
+  // Rows of x and y in X_all (read through these ranges, the design is never copied)
+  const arma::uword x_from = (attr_only || use_float) ? 0 : n_net;
+  const arma::uword y_from = x_from + (fix_x ? 0 : n_actor);
   
   if (fix_x == false) {
-    X_x = X_all.rows(n_net*!fix_z, n_net*!fix_z + n_actor - 1);
-    Y_x = Y_all.subvec(n_net*!fix_z, n_net*!fix_z + n_actor - 1);
-    
-    X_y = X_all.rows(n_net*!fix_z + n_actor, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net*!fix_z + n_actor, Y_all.n_elem - 1);
+    Y_x = Y_all.subvec(n_net*!attr_only, n_net*!attr_only + n_actor - 1);
+    Y_y = Y_all.subvec(n_net*!attr_only + n_actor, Y_all.n_elem - 1);
   } else {
-    X_y = X_all.rows(n_net*!fix_z, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net*!fix_z, Y_all.n_elem - 1);
+    Y_y = Y_all.subvec(n_net*!attr_only, Y_all.n_elem - 1);
   }
   
   // Pre-calculate network offsets
@@ -2584,6 +3687,33 @@ List pl_estimation(arma::vec coef,
   arma::vec stand_in(1);
   stand_in.fill(0.0);
   
+  // Adds the score and Fisher information (if derivatives) of the streamed
+  // network rows at coef to score and fisher and returns their log-likelihood
+  auto network_pass = [&](const arma::vec &coef, bool derivatives) {
+    double llh = 0.0;
+    xyz_for_each_pl_chunk(object, functions, data_list, type_list, chunk_size, n_threads,
+                          [&](const arma::mat &X_full, const arma::vec &Y_c, const arma::vec &overlap_c) {
+      const arma::mat X_c = X_full.cols(where_right);
+      arma::vec eta = design_times(X_c, 0, X_c.n_rows, coef, n_threads) +
+        (1.0 - overlap_c) * offset_nonoverlap;
+      arma::vec exp_eta = arma::exp(eta);
+      arma::vec llh_c = Y_c % eta - arma::log1p(exp_eta);
+      if (!nonoverlap_random) {
+        llh_c = overlap_c % llh_c;
+      }
+      llh += arma::accu(llh_c);
+      if (derivatives) {
+        arma::vec prob = exp_eta / (1.0 + exp_eta);
+        if (!nonoverlap_random) {
+          prob = overlap_c % prob;
+        }
+        weighted_crossprod(X_c, 0, X_c.n_rows, arma::vec(prob % (1.0 - prob)),
+                           arma::vec(Y_c - prob), score, fisher, n_threads);
+      }
+    });
+    return llh;
+  };
+  
   if(display_progress) {
     Rcout << "Starting with the estimation" << std::endl;
   }
@@ -2599,8 +3729,13 @@ List pl_estimation(arma::vec coef,
     fisher.zeros();
     Rcpp::checkUserInterrupt();
     // --- Component 1: Network (Logistic Model) ---
-    if(!fix_z){
-      arma::vec eta_net = X_net * coef + net_offsets;
+    if(stream){
+      // Also completes the llh of the previous iteration, which was taken at coef
+      double llh_net = network_pass(coef, true);
+      if (k > 2) llhs.at(k-3) += llh_net;
+    } else if(!fix_z){
+      arma::vec eta_net = (use_float ? design_times(X_net_f, 0, n_net, coef, n_threads) :
+                           design_times(X_all, 0, n_net, coef, n_threads)) + net_offsets;
       arma::vec exp_eta_net = arma::exp(eta_net);
       arma::vec prob_net = exp_eta_net / (1.0 + exp_eta_net);
       if(!nonoverlap_random){
@@ -2608,60 +3743,35 @@ List pl_estimation(arma::vec coef,
       }
       
       arma::vec var_net = prob_net % (1.0 - prob_net);
+      arma::vec res_net = Y_net - prob_net;
+      if (net_weights.n_elem > 0) {
+        res_net %= net_weights;
+        var_net %= net_weights;
+      }
       
-      score += X_net.t() * (Y_net - prob_net);
-      fisher += X_net.t() * arma::diagmat(var_net) * X_net;
+      if (use_float) {
+        weighted_crossprod(X_net_f, 0, n_net, var_net, res_net, score, fisher, n_threads);
+      } else {
+        weighted_crossprod(X_all, 0, n_net, var_net, res_net, score, fisher, n_threads);
+      }
     }
     // Rcout <<  fisher << std::endl;
     // Rcout <<  arma::sum(X_net, 0) << std::endl;
     // 
-    // --- Component 2: Attribute 'x' ---
-    if (fix_x == false) {
-      if (attr_x_type == "binomial") {
-        arma::vec eta_x = X_x * coef;
-        arma::vec exp_eta_x = arma::exp(eta_x);
-        arma::vec prob_x = exp_eta_x / (1.0 + exp_eta_x);
-        arma::vec var_x = prob_x % (1.0 - prob_x);
-        
-        score += X_x.t() * (Y_x - prob_x);
-        fisher += X_x.t() * arma::diagmat(var_x) * X_x;
-        
-      } else if (attr_x_type == "poisson") {
-        arma::vec eta_x = X_x * coef;
-        arma::vec mu_x = arma::exp(eta_x);
-        
-        score += X_x.t() * (Y_x - mu_x);
-        fisher += X_x.t() * arma::diagmat(mu_x) * X_x;
-        
-      } else if (attr_x_type == "normal") {
-        arma::vec mu_x = X_x * coef; 
-        score += X_x.t() * (Y_x - mu_x) / attr_x_scale;
-        fisher += (X_x.t() * X_x) / attr_x_scale;
+    // --- Components 2 and 3: Attributes 'x' and 'y' in one pass ---
+    {
+      const arma::uword n_rows = X_all.n_rows;
+      const arma::vec eta = design_times(X_all, x_from, n_rows, coef, n_threads);
+      arma::vec res(n_rows - x_from), var(n_rows - x_from), res_attr, var_attr;
+      if (fix_x == false) {
+        xyz_attribute_moments(attr_x_type, attr_x_scale, eta.head(n_actor), Y_x, res_attr, var_attr);
+        res.head(n_actor) = res_attr;
+        var.head(n_actor) = var_attr;
       }
-    }
-    
-    // --- Component 3: Attribute 'y' ---
-    if (attr_y_type == "binomial") {
-      arma::vec eta_y = X_y * coef;
-      arma::vec exp_eta_y = arma::exp(eta_y);
-      arma::vec prob_y = exp_eta_y / (1.0 + exp_eta_y);
-      arma::vec var_y = prob_y % (1.0 - prob_y);
-      
-      score += X_y.t() * (Y_y - prob_y);
-      fisher += X_y.t() * arma::diagmat(var_y) * X_y;
-      
-    } else if (attr_y_type == "poisson") {
-      arma::vec eta_y = X_y * coef;
-      arma::vec mu_y = arma::exp(eta_y);
-      
-      score += X_y.t() * (Y_y - mu_y);
-      fisher += X_y.t() * arma::diagmat(mu_y) * X_y;
-      
-    } else if (attr_y_type == "normal") {
-      arma::vec mu_y = X_y * coef;
-      
-      score += X_y.t() * (Y_y - mu_y) / attr_y_scale;
-      fisher += (X_y.t() * X_y) / attr_y_scale;
+      xyz_attribute_moments(attr_y_type, attr_y_scale, eta.tail(n_rows - y_from), Y_y, res_attr, var_attr);
+      res.tail(n_rows - y_from) = res_attr;
+      var.tail(n_rows - y_from) = var_attr;
+      weighted_crossprod(X_all, x_from, n_rows, var, res, score, fisher, n_threads);
     }
     // --- 4. Update and Check Convergence ---
     // Rcout <<  fisher << std::endl;
@@ -2690,7 +3800,7 @@ List pl_estimation(arma::vec coef,
             attr_y_scale,
             n_actor,
             fix_x, 
-            fix_z,nonoverlap_random );
+            attr_only,nonoverlap_random, net_weights, X_net_f, n_threads);
     // Rcout << "Here A" <<  std::endl;
     if (k == max_iteration) {
       non_converged = false;
@@ -2700,19 +3810,47 @@ List pl_estimation(arma::vec coef,
     
     k++;
   }
+  if (stream) {
+    llhs.at(k-3) += network_pass(coef, false);
+  }
   if(display_progress) {
     Rcpp::Rcout.flush();  
     Rcout << "Done with the estimation" << std::endl;
   }
   // coef.rows(ind_degrees) = coef_degrees;
   // coef.rows(ind_nondegrees) = coef_nondegrees;
+  // For dyad independent models the MPLE is the MLE and inv(fisher) needs no
+  // simulation-based correction. With sampled dyads the weights enter fisher
+  // once but the variance of the weighted score squared, so the variance is the
+  // sandwich inv(J) K inv(J) with K summing w^2 * p * (1 - p) * x x' over the
+  // network rows (here J plus the part of the weights beyond w).
+  arma::mat fisher_inv = arma::inv(fisher);
+  arma::mat var_coef = fisher_inv;
+  if (net_weights_sq.n_elem > 0) {
+    arma::vec eta_net = (use_float ? design_times(X_net_f, 0, n_net, coef, n_threads) :
+                         design_times(X_all, 0, n_net, coef, n_threads)) + net_offsets;
+    arma::vec prob_net = 1.0 / (1.0 + arma::exp(-eta_net));
+    if(!nonoverlap_random){
+      prob_net = overlap_vec%prob_net;
+    }
+    const arma::vec extra_var = prob_net % (1.0 - prob_net) % (net_weights_sq - net_weights);
+    arma::vec unused(n_coef, arma::fill::zeros);
+    arma::mat K = fisher;
+    if (use_float) {
+      weighted_crossprod(X_net_f, 0, n_net, extra_var, arma::vec(), unused, K, n_threads);
+    } else {
+      weighted_crossprod(X_all, 0, n_net, extra_var, arma::vec(), unused, K, n_threads);
+    }
+    var_coef = fisher_inv * K * fisher_inv;
+  }
   return(List::create(_["coefficients"] =coef,
                       _["coefficients_path"] =coefs.rows(2,k-1),
                       _["score"] =score,
                       _["where_wrong"] = where_wrong,
                       _["fisher"] = fisher,
-                      _["var"] = arma::inv(fisher), 
-                      _["llh"] = llhs.head(k-2)
+                      _["var"] = var_coef, 
+                      _["llh"] = llhs.head(k-2),
+                      _["dyad_independent"] = functions.dyad_independent
   ));
 }
 // [[Rcpp::export]]
@@ -2815,46 +3953,43 @@ List outerloop_estimation_pl(arma::vec coef,
                              double attr_x_scale, 
                              double attr_y_scale, 
                              bool nonoverlap_random = true,
-                             int start = 0) {
+                             int start = 0, 
+                             int n_threads = 1, 
+                             double sample_fraction = 1.0, 
+                             bool exact = true,
+                             Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue) {
   List res; 
   std::tuple<arma::mat,arma::vec> pseudo_lh;
   int n_actor = y_attribute.size();
   
-  arma::mat id_mat = arma::mat((double) n_actor,n_actor,arma::fill::eye);
-  arma::mat ones_mat = arma::mat(n_actor,n_actor,arma::fill::ones);
-  arma::mat A_inv = 4/((double)n_actor -2)*(id_mat - 1/(2*(double)n_actor-2)*ones_mat);
-  if(directed){
-    A_inv = get_A_inv(n_actor);
-  }
-  
-  std::tuple<arma::vec, arma::vec,  arma::mat, arma::mat> res_degrees, res_nondegrees, res_nondegrees_alt;
+  // The MM updates of the degrees use xyz_degree_bound_solve instead of a dense A_inv
+  std::tuple<arma::vec, arma::vec,  arma::mat> res_degrees;
+  std::tuple<arma::vec, arma::vec,  arma::mat, arma::mat> res_nondegrees, res_nondegrees_alt;
+  // Filled by xyz_get_info_pl, net_weights stays empty unless the dyads are sampled
   arma::uvec i_vec, j_vec,overlap_vec;
+  arma::vec net_weights;
   arma::mat coefs_degrees; 
   //  coefs_nondegrees(terms.size()), coefs_degrees(n_actor)
   if(directed){
-    // network_vec = arma::vec(n_actor*(n_actor-1)); 
-    i_vec = arma::uvec(n_actor*(n_actor-1)); 
-    j_vec = arma::uvec(n_actor*(n_actor-1)); 
-    overlap_vec = arma::uvec(n_actor*(n_actor-1)); 
     coef_degrees.reshape(n_actor*2,1);
     coefs_degrees.reshape(0, n_actor*2);  
   } else {
-    // network_vec= arma::vec(n_actor*(n_actor-1)/2); 
-    i_vec= arma::uvec(n_actor*(n_actor-1)/2); 
-    j_vec= arma::uvec(n_actor*(n_actor-1)/2);
-    overlap_vec= arma::uvec(n_actor*(n_actor-1)/2);
     coef_degrees.reshape(n_actor,1);
     coefs_degrees.reshape(max_iteration_inner_degrees, n_actor);
   }
-  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, type_x, type_y,attr_x_scale, attr_y_scale,
+                   StorageMode::automatic, xyz_group_labels(neighborhood_groups));
   // Rcout << "Start"<< std::endl;
   // Rcout << object.n_actor<< std::endl;
   
   if(display_progress) {
     Rcout << "Starting with the preprocessing" << std::endl;
   }
+  // For dyad independent models the MPLE is the MLE (see estimate_xyz)
+  bool dyad_independent = false;
   pseudo_lh = xyz_get_info_pl(object,terms,data_list,type_list, display_progress,
-                              i_vec,j_vec,overlap_vec, n_actor, fix_x, false);
+                              i_vec,j_vec,overlap_vec, n_actor, fix_x, false, n_threads, 
+                              sample_fraction, &net_weights, &dyad_independent);
   arma::uvec where_wrong = find(arma::sum(std::get<0>(pseudo_lh), 0) == 0);
   if(where_wrong.size() >0){
     Rcout << "Some statistics do not change over all paris/actors (they are excluded from the model since their MLE is negative infinity)" << std::endl;
@@ -2863,7 +3998,7 @@ List outerloop_estimation_pl(arma::vec coef,
     coef = coef.rows(where_right);
   }
   arma::mat coefs(max_iteration_outer+1, coef.size() + coef_degrees.size()),
-  fisher_degrees(terms.size(),terms.size()), fisher_nondegrees(terms.size(),terms.size()), 
+  fisher_nondegrees(terms.size(),terms.size()), 
   coefs_nondegrees(max_iteration_inner_nondegrees, terms.size());
   
   coefs.row(0)= arma::join_rows(coef.t(), coef_degrees.t());
@@ -2876,12 +4011,10 @@ List outerloop_estimation_pl(arma::vec coef,
   
   coef_nondegrees = coef;
   arma::vec old_coef_pop, old_score_pop, llh(max_iteration_outer +1);
-  arma::mat old_M;
+  LowRankUpdate old_M;
   llh.at(0) = 0; 
   
   if(accelerated){
-    old_M.reshape(coef_degrees.size(), coef_degrees.size());
-    old_M.fill(arma::fill::zeros); 
     old_coef_pop.reshape(coef_degrees.size(),1);
     old_coef_pop.fill(arma::fill::zeros);
   }
@@ -2907,11 +4040,11 @@ List outerloop_estimation_pl(arma::vec coef,
                                                            tol, 
                                                            coef_nondegrees, 
                                                            offset_nonoverlap, 
-                                                           A_inv, 
                                                            non_stop, 
                                                            old_score_pop,
                                                            old_coef_pop, 
-                                                           old_M,  k, first_it, nonoverlap_random);
+                                                           old_M,  k, first_it, nonoverlap_random, 
+                                                           net_weights, n_threads);
       first_it = false;  
     } else {
       res_degrees = cond_estimation_degrees_pl(coef_degrees,
@@ -2924,8 +4057,8 @@ List outerloop_estimation_pl(arma::vec coef,
                                                tol, 
                                                coef_nondegrees, 
                                                offset_nonoverlap, 
-                                               A_inv, k, non_stop, 
-                                               nonoverlap_random);
+                                               k, non_stop, 
+                                               nonoverlap_random, net_weights, n_threads);
       
     }
     coef_degrees = std::get<0>(res_degrees);
@@ -2955,7 +4088,8 @@ List outerloop_estimation_pl(arma::vec coef,
                                                    offset_nonoverlap, 
                                                    non_stop, 
                                                    type_x, type_y, 
-                                                   attr_x_scale, attr_y_scale, fix_x);
+                                                   attr_x_scale, attr_y_scale, fix_x, 
+                                                   net_weights, n_threads);
     // Rcout << std::get<0>(res_nondegrees)<< std::endl;
     // Rcout << "Done 2. Stage"<< std::endl;
     coef_nondegrees = std::get<0>(res_nondegrees);
@@ -2972,7 +4106,7 @@ List outerloop_estimation_pl(arma::vec coef,
            attr_x_scale,
            attr_y_scale,
            n_actor,
-           fix_x, false, nonoverlap_random);
+           fix_x, false, nonoverlap_random, net_weights, arma::fmat(), n_threads);
     // Rcout << coef_nondegrees<< std::endl;
     coefs.row(k) = join_cols(coef_nondegrees, coef_degrees).t();
     if(k == max_iteration_outer){
@@ -2990,7 +4124,16 @@ List outerloop_estimation_pl(arma::vec coef,
   }
   
   std::tie(coef_nondegrees,score_nondegrees,fisher_nondegrees,coefs_nondegrees) = res_nondegrees;
-  std::tie(coef_degrees,score_degrees,fisher_degrees,coefs_degrees) = res_degrees;
+  std::tie(coef_degrees,score_degrees,coefs_degrees) = res_degrees;
+  // Degree block of the pseudo Fisher information, only its diagonal is returned
+  DegreeHessian exact_A = get_A_exact(i_vec, 
+                                      j_vec,overlap_vec,
+                                      pseudo_lh, 
+                                      coef_degrees, 
+                                      coef_nondegrees, offset_nonoverlap, 
+                                      object.z_network.directed,object.n_actor, 
+                                      net_weights, n_threads);
+  arma::vec fisher_degrees_diag = exact_A.diag;
   
   if(var){
     std::tuple<arma::vec,  arma::mat> res_mat = get_B_pl(i_vec, 
@@ -2998,46 +4141,37 @@ List outerloop_estimation_pl(arma::vec coef,
                                                          pseudo_lh, 
                                                          coef_degrees, 
                                                          coef_nondegrees, offset_nonoverlap, 
-                                                         object.z_network.directed,object.n_actor );
-    arma::mat exact_A = get_A_exact(i_vec, 
-                                    j_vec,overlap_vec,
-                                    pseudo_lh, 
-                                    coef_degrees, 
-                                    coef_nondegrees, offset_nonoverlap, 
-                                    object.z_network.directed,object.n_actor );
+                                                         object.z_network.directed,object.n_actor, 
+                                                         net_weights, n_threads);
     arma::mat B_mat;
     arma::vec A_diag;
     std::tie(A_diag,B_mat) = res_mat;
+    // B_mat * A^- for the Schur complement fisher_nondegrees - B_mat * A^- * B_mat'
+    // (see estimate_xyz), solved without forming A. Dyad independent models take
+    // their variance from it directly, so it is solved for them irrespective of exact.
+    arma::mat B_A_inv;
+    if(exact || dyad_independent){
+      bool solved = true;
+      B_A_inv = exact_A.solve(B_mat.t(), n_threads, 1e-10, 1000, &solved).t();
+      if(!solved){
+        Rcpp::warning("The conjugate gradients for the degree block of the variance did not converge; the standard errors may be inaccurate.");
+      }
+    }
     // coefs(ind_degrees) = coef_degrees;
     // coef.rows(ind_nondegrees) = coef_nondegrees;
-    if(accelerated){
-      return(List::create(_["coefficients_nondegrees"] =coef_nondegrees,
-                          _["coefficients_degrees"] =coef_degrees,
-                          _["coefficients_path"] =coefs.rows(0,k-1),
-                          _["score_degrees"] =score_degrees,
-                          _["score_nondegrees"] =score_nondegrees,
-                          _["fisher_degrees"] = fisher_degrees, 
-                          _["fisher_nondegrees"] = fisher_nondegrees, 
-                          _["A_diag"] = A_diag, 
-                          _["M"] = old_M, 
-                          _["A_approx"] = A_inv, 
-                          _["exact_A"] =exact_A,
-                          _["B_mat"] = B_mat, 
-                          _["llh"] = llh.rows(1,k-1), 
-                          _["where_wrong"] = where_wrong));
-    } else {
-      return(List::create(_["coefficients_nondegrees"] =coef_nondegrees,
-                          _["coefficients_degrees"] =coef_degrees,
-                          _["coefficients_path"] =coefs.rows(0,k-1),
-                          _["score_degrees"] =score_degrees,
-                          _["score_nondegrees"] =score_nondegrees,
-                          _["fisher_degrees"] = fisher_degrees, 
-                          _["fisher_nondegrees"] = fisher_nondegrees, 
-                          _["A_diag"] = A_diag, 
-                          _["B_mat"] = B_mat, 
-                          _["llh"] = llh.rows(1,k-1), 
-                          _["where_wrong"] = where_wrong));
-    }
+    return(List::create(_["coefficients_nondegrees"] =coef_nondegrees,
+                        _["coefficients_degrees"] =coef_degrees,
+                        _["coefficients_path"] =coefs.rows(0,k-1),
+                        _["score_degrees"] =score_degrees,
+                        _["score_nondegrees"] =score_nondegrees,
+                        _["fisher_degrees_diag"] = fisher_degrees_diag, 
+                        _["fisher_nondegrees"] = fisher_nondegrees, 
+                        _["A_diag"] = A_diag, 
+                        _["B_A_inv"] = B_A_inv,
+                        _["B_mat"] = B_mat, 
+                        _["llh"] = llh.rows(1,k-1), 
+                        _["where_wrong"] = where_wrong,
+                        _["dyad_independent"] = dyad_independent));
   } else {
     // coefs(ind_degrees) = coef_degrees;
     // coef.rows(ind_nondegrees) = coef_nondegrees;
@@ -3046,11 +4180,11 @@ List outerloop_estimation_pl(arma::vec coef,
                         _["coefficients_path"] =coefs.rows(0,k-1),
                         _["score_degrees"] =score_degrees,
                         _["score_nondegrees"] =score_nondegrees,
-                        _["fisher_degrees"] = fisher_degrees, 
+                        _["fisher_degrees_diag"] = fisher_degrees_diag, 
                         _["fisher_nondegrees"] = fisher_nondegrees, 
-                        _["A_inv"] = A_inv,
                         _["llh"] = llh.rows(1,k-1), 
-                        _["where_wrong"] = where_wrong
+                        _["where_wrong"] = where_wrong,
+                        _["dyad_independent"] = dyad_independent
     ));
   }
   
@@ -3069,7 +4203,7 @@ List outerloop_estimation_pl(arma::vec coef,
 //   int n_actor = object.n_actor;
 //   bool is_full_neighborhood = object.check_if_full_neighborhood();
 //   
-//   std::vector<xyz_ValidateFunction> functions;
+//   xyz_TermTable functions;
 //   functions = xyz_change_statistics_generate(terms);
 //   std::string z = "z", x = "x", y = "y";
 //   arma::vec change_stat_x_i(functions.size()),
@@ -3200,81 +4334,42 @@ arma::vec calculate_score_pl(XYZ_class & object,
   const arma::mat& X_all = std::get<0>(pseudo_lh);
   const arma::vec& Y_all = std::get<1>(pseudo_lh);
   
-  // --- 1. Define subviews for each component ---
-  // Network component is always present
-  
-  
-  arma::mat X_x, X_y, X_net;
-  arma::vec Y_x, Y_y, Y_net;
-  if(!fix_z){
-    X_net = X_all.rows(0, n_net - 1);
-    Y_net = Y_all.subvec(0, n_net - 1);
-  }
-  
-  
-  if (fix_x == false) {
-    X_x = X_all.rows(n_net, n_net + n_actor - 1);
-    Y_x = Y_all.subvec(n_net, n_net + n_actor - 1);
-    
-    X_y = X_all.rows(n_net + n_actor, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net + n_actor, Y_all.n_elem - 1);
-  } else {
-    X_y = X_all.rows(n_net, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net, Y_all.n_elem - 1);
-  }
-  arma::vec score(n_coef);
+  // --- 1. Row ranges of each component ---
+  // The design is only read through these ranges and never copied
+  const arma::uword n_rows = X_all.n_rows;
+  const arma::uword x_from = n_net, y_from = n_net + (fix_x ? 0 : n_actor);
+  arma::vec score(n_coef, arma::fill::zeros);
+  const arma::vec eta = design_times(X_all, 0, n_rows, coef);
+  arma::vec res(n_rows), res_attr, var_attr;
   
   if(!fix_z){
     // Pre-calculate network offsets
     const arma::vec net_offsets = (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
-    // --- 2. Initialize estimation variables ---
-    score.zeros();
     
     // --- Component 1: Network (Logistic Model) ---
-    arma::vec eta_net = X_net * coef + net_offsets;
+    arma::vec eta_net = eta.head(n_net) + net_offsets;
     
     arma::vec exp_eta_net = arma::exp(eta_net);
     arma::vec prob_net = exp_eta_net / (1.0 + exp_eta_net);
     if(!nonoverlap_random){
       prob_net = overlap_vec % prob_net;
     }
-    arma::vec var_net = prob_net % (1.0 - prob_net);
-    
-    score += X_net.t() * (Y_net - prob_net);
+    res.head(n_net) = Y_all.head(n_net) - prob_net;
   }
   // --- Component 2: Attribute 'x' ---
   if (fix_x == false) {
-    if (attr_x_type == "binomial") {
-      arma::vec eta_x = X_x * coef;
-      arma::vec exp_eta_x = arma::exp(eta_x);
-      arma::vec prob_x = exp_eta_x / (1.0 + exp_eta_x);
-      arma::vec var_x = prob_x % (1.0 - prob_x);
-      score += X_x.t() * (Y_x - prob_x);
-    } else if (attr_x_type == "poisson") {
-      arma::vec eta_x = X_x * coef;
-      arma::vec mu_x = arma::exp(eta_x);
-      score += X_x.t() * (Y_x - mu_x);
-    } else if (attr_x_type == "normal") {
-      arma::vec mu_x = X_x * coef; 
-      score += X_x.t() * (Y_x - mu_x) / attr_x_scale;
-    }
+    xyz_attribute_moments(attr_x_type, attr_x_scale, eta.subvec(x_from, y_from - 1),
+                          Y_all.subvec(x_from, y_from - 1), res_attr, var_attr);
+    res.subvec(x_from, y_from - 1) = res_attr;
   }
   
   // --- Component 3: Attribute 'y' ---
-  if (attr_y_type == "binomial") {
-    arma::vec eta_y = X_y * coef;
-    arma::vec exp_eta_y = arma::exp(eta_y);
-    arma::vec prob_y = exp_eta_y / (1.0 + exp_eta_y);
-    arma::vec var_y = prob_y % (1.0 - prob_y);
-    score += X_y.t() * (Y_y - prob_y);
-  } else if (attr_y_type == "poisson") {
-    arma::vec eta_y = X_y * coef;
-    arma::vec mu_y = arma::exp(eta_y);
-    score += X_y.t() * (Y_y - mu_y);
-  } else if (attr_y_type == "normal") {
-    arma::vec mu_y = X_y * coef;
-    score += X_y.t() * (Y_y - mu_y) / attr_y_scale;
-  }
+  xyz_attribute_moments(attr_y_type, attr_y_scale, eta.subvec(y_from, n_rows - 1),
+                        Y_all.subvec(y_from, n_rows - 1), res_attr, var_attr);
+  res.subvec(y_from, n_rows - 1) = res_attr;
+  
+  arma::mat no_fisher;
+  weighted_crossprod(X_all, 0, n_rows, arma::vec(), res, score, no_fisher);
   return(score);
 }
 
@@ -3317,23 +4412,11 @@ arma::vec calculate_score_pl_degrees(XYZ_class & object,
   const arma::mat& X_all = std::get<0>(pseudo_lh);
   const arma::vec& Y_all = std::get<1>(pseudo_lh);
   
-  // --- 1. Define subviews for each component ---
-  // Network component is always present
-  const arma::mat X_net = X_all.rows(0, n_net - 1);
+  // --- 1. Row ranges of each component ---
+  // The design is only read through these ranges and never copied
+  const arma::uword n_rows = X_all.n_rows;
+  const arma::uword x_from = n_net, y_from = n_net + (fix_x ? 0 : object.n_actor);
   const arma::vec Y_net = Y_all.subvec(0, n_net - 1);
-  arma::mat X_x, X_y;
-  arma::vec Y_x, Y_y;
-  
-  if (fix_x == false) {
-    X_x = X_all.rows(n_net, n_net + object.n_actor - 1);
-    Y_x = Y_all.subvec(n_net, n_net + object.n_actor - 1);
-    
-    X_y = X_all.rows(n_net + object.n_actor, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net + object.n_actor, Y_all.n_elem - 1);
-  } else {
-    X_y = X_all.rows(n_net, X_all.n_rows - 1);
-    Y_y = Y_all.subvec(n_net, Y_all.n_elem - 1);
-  }
   
   // Pre-calculate network offsets
   const arma::vec net_offsets = (1.0 - arma::conv_to<arma::vec>::from(overlap_vec)) * offset_nonoverlap;
@@ -3350,8 +4433,11 @@ arma::vec calculate_score_pl_degrees(XYZ_class & object,
   // --- 2. Initialize estimation variables ---
   arma::vec score_nondegrees(n_coef, arma::fill::zeros);
   
+  const arma::vec eta = design_times(X_all, 0, n_rows, coef_nondegrees);
+  arma::vec res(n_rows), res_attr, var_attr;
+  
   // --- Component 1: Network (Logistic Model) ---
-  arma::vec eta_net = X_net * coef_nondegrees + net_offsets + 
+  arma::vec eta_net = eta.head(n_net) + net_offsets + 
     coef_degrees.elem(i_pop_indices) + 
     coef_degrees.elem(j_pop_indices);
   
@@ -3361,44 +4447,22 @@ arma::vec calculate_score_pl_degrees(XYZ_class & object,
     prob_net = overlap_vec % prob_net;
   }
   arma::vec var_net = prob_net % (1.0 - prob_net);
+  res.head(n_net) = Y_net - prob_net;
   
-  score_nondegrees += X_net.t() * (Y_net - prob_net);
   // --- Component 2: Attribute 'x' ---
   if (fix_x == false) {
-    if (attr_x_type == "binomial") {
-      arma::vec eta_x = X_x * coef_nondegrees;
-      arma::vec exp_eta_x = arma::exp(eta_x);
-      arma::vec prob_x = exp_eta_x / (1.0 + exp_eta_x);
-      arma::vec var_x = prob_x % (1.0 - prob_x);
-      
-      score_nondegrees += X_x.t() * (Y_x - prob_x);
-    } else if (attr_x_type == "poisson") {
-      arma::vec eta_x = X_x * coef_nondegrees;
-      arma::vec mu_x = arma::exp(eta_x);
-      score_nondegrees += X_x.t() * (Y_x - mu_x);
-    } else if (attr_x_type == "normal") {
-      arma::vec mu_x = X_x * coef_nondegrees; 
-      score_nondegrees += X_x.t() * (Y_x - mu_x) / attr_x_scale;
-    }
+    xyz_attribute_moments(attr_x_type, attr_x_scale, eta.subvec(x_from, y_from - 1),
+                          Y_all.subvec(x_from, y_from - 1), res_attr, var_attr);
+    res.subvec(x_from, y_from - 1) = res_attr;
   }
   
   // --- Component 3: Attribute 'y' ---
-  if (attr_y_type == "binomial") {
-    arma::vec eta_y = X_y * coef_nondegrees;
-    arma::vec exp_eta_y = arma::exp(eta_y);
-    arma::vec prob_y = exp_eta_y / (1.0 + exp_eta_y);
-    arma::vec var_y = prob_y % (1.0 - prob_y);
-    
-    score_nondegrees += X_y.t() * (Y_y - prob_y);
-  } else if (attr_y_type == "poisson") {
-    arma::vec eta_y = X_y * coef_nondegrees;
-    arma::vec mu_y = arma::exp(eta_y);
-    
-    score_nondegrees += X_y.t() * (Y_y - mu_y);
-  } else if (attr_y_type == "normal") {
-    arma::vec mu_y = X_y * coef_nondegrees;
-    score_nondegrees += X_y.t() * (Y_y - mu_y) / attr_y_scale;
-  }
+  xyz_attribute_moments(attr_y_type, attr_y_scale, eta.subvec(y_from, n_rows - 1),
+                        Y_all.subvec(y_from, n_rows - 1), res_attr, var_attr);
+  res.subvec(y_from, n_rows - 1) = res_attr;
+  
+  arma::mat no_fisher;
+  weighted_crossprod(X_all, 0, n_rows, arma::vec(), res, score_nondegrees, no_fisher);
   
   arma::vec score_degrees(coef_degrees.size(), arma::fill::zeros);
   for(unsigned int i = 0; i < i_vec.size(); i++){
@@ -3428,7 +4492,7 @@ arma::vec calculate_score_pl_degrees(XYZ_class & object,
                             attr_y_type, 
                             attr_x_scale, 
                             attr_y_scale);
-    arma::mat A = get_A_exact(i_vec, j_vec,overlap_vec,pseudo_lh, 
+    DegreeHessian A = get_A_exact(i_vec, j_vec,overlap_vec,pseudo_lh, 
                               coef_degrees, 
                               coef_nondegrees, 
                               offset_nonoverlap,
@@ -3445,13 +4509,15 @@ arma::vec calculate_score_pl_degrees(XYZ_class & object,
     arma::mat X;
     // clock.tick("solve");
     if(exact){
-      X = arma::pinv(A) * B;
-      // Rcout << "Using exact inversion for A" << std::endl;
-      arma::mat residual = A * X - B;
-      
+      // A^- B by conjugate gradients on the structured A (see DegreeHessian)
+      bool solved = true;
+      X = A.solve(B, 1, 1e-10, 1000, &solved);
+      if(!solved){
+        Rcpp::warning("The conjugate gradients for the degree block of the variance did not converge; the standard errors may be inaccurate.");
+      }
     } else {
       // Step 1: Inverse of diagonal A (robust version with epsilon)
-      arma::vec ainv = 1.0 / (A.diag() + 1e-12);  // Elementwise inverse with regularizer
+      arma::vec ainv = 1.0 / (A.diag + 1e-12);  // Elementwise inverse with regularizer
       // Step 2: Compute X = A^{-1} B using column-wise scaling
       X = B.each_col() % ainv;
     }
@@ -3508,15 +4574,20 @@ List xyz_approximate_variability(arma::vec& coef,
                                  double attr_x_scale, 
                                  double attr_y_scale, 
                                  bool nonoverlap_random,
-                                 bool tnt = true){
+                                 bool tnt = true,
+                                 Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue,
+                                 bool native_rng = false,
+                                 int stream = 0){
   // Generate the class with the provided information
-  XYZ_class object(n_actor,directed, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  XYZ_class object(n_actor,directed, neighborhood, overlap, type_x, type_y,attr_x_scale, attr_y_scale,
+                   StorageMode::automatic, xyz_group_labels(neighborhood_groups));
   if(!init_empty){
     // Rcout << "Here" << std::endl;
     object.set_info_arma(x_attribute,y_attribute, z_network);
   } else{
     if(fix_x){
       object.x_attribute.set_attr_from_armavec(x_attribute);  
+      object.rebuild_neighbour_sums();
     }
     if(fix_z){
       // Rcout << "Setting initial empty network" << std::endl;
@@ -3525,9 +4596,11 @@ List xyz_approximate_variability(arma::vec& coef,
   }
   bool is_full_neighborhood = object.check_if_full_neighborhood();
   // Generate change statistic function from the terms
-  std::vector<xyz_ValidateFunction> functions;
+  xyz_TermTable functions;
   
   functions = xyz_change_statistics_generate_new(terms);
+  xyz_enable_partner_cache(object, functions);
+  xyz_prepare_geometric_weights(object, functions, data_list);
   arma::vec global_stats = xyz_count_global_internal( object,
                                                       terms,
                                                       n_actor,
@@ -3572,10 +4645,7 @@ List xyz_approximate_variability(arma::vec& coef,
       z_tmp.at(i) = 1;
   }
   // arma::vec gradient_tmp;
-  if (seed != NA_INTEGER) {
-    Rcpp::Function set_seed_r("set.seed");
-    set_seed_r(seed);
-  }
+  object.rng.seed(native_rng, seed, stream);
   for(int i = 1; i <=(n_simulation+n_burn_in);i ++) {
     Rcpp::checkUserInterrupt();
     // Rcout << "Updated Global Statistics: " << global_stats.t() << std::endl;
@@ -3592,14 +4662,14 @@ List xyz_approximate_variability(arma::vec& coef,
                                 type_list,
                                 is_full_neighborhood,
                                 functions,
-                                global_stats, "x");  
+                                global_stats, iglm::Mode::x);  
     }
     // Sample Y| X,Z
     xyz_simulate_attribute_mh(coef,object,
                               n_proposals_y,
                               data_list, type_list,
                               is_full_neighborhood, functions,
-                              global_stats, "y");
+                              global_stats, iglm::Mode::y);
     // Sample Z|X,Y
     if(!fix_z){
       if(degrees){
@@ -3746,21 +4816,25 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
                                          double attr_y_scale,
                                          bool return_x = false,
                                          bool return_y = false,
-                                         bool return_z = false) {
+                                         bool return_z = false,
+                                         int n_threads = 1,
+                                         Rcpp::Nullable<Rcpp::NumericMatrix> neighborhood_groups = R_NilValue) {
   // Set up objects
   Rcpp::List res, res_x, res_y, res_z;
   int n_actor = y_attribute.size();
   // Rcout << "Read Data" << std::endl;
-  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, type_x, type_y,attr_x_scale, attr_y_scale);
+  XYZ_class object(n_actor,directed, x_attribute, y_attribute,z_network,neighborhood,overlap, type_x, type_y,attr_x_scale, attr_y_scale,
+                   StorageMode::automatic, xyz_group_labels(neighborhood_groups));
   // Check whether its a fully observed neighbhorhood (this means that everyone knows everyone)
   // This is provided to the sufficient statistics as this might make some calculations unnecessary
   bool is_full_neighborhood = object.check_if_full_neighborhood();
   // Generate vector of functions that calculate the sufficient statistics
-  std::vector<xyz_ValidateFunction> functions;
+  xyz_TermTable functions;
   functions = xyz_change_statistics_generate_new(terms);
+  xyz_prepare_geometric_weights(object, functions, data_list);
   // strings z, x, and y later needed to tell the sufficient statistics
   // what type of change statistic is wanted
-  std::string z = "z", x = "x", y = "y";
+  const iglm::Mode z = iglm::Mode::z, x = iglm::Mode::x, y = iglm::Mode::y;
   arma::vec i_vec, j_vec,overlap_vec;
   if(directed){
     i_vec = arma::vec(n_actor*(n_actor-1)); 
@@ -3772,10 +4846,11 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
     overlap_vec = arma::vec(n_actor*(n_actor-1)/2); 
   } 
   
-  // Just a temporary vector of the change statistics for one dyad of the network
-  arma::vec change_stat_network(functions.size()),
-  // The same thing but for the attributes i and j
-  change_stat_attribute_i(functions.size());
+  // Dyads (and actors) whose change statistics are evaluated in one batch
+  std::vector<int> units_i, units_j, actors(n_actor);
+  for(int i = 1; i <= n_actor; i++){
+    actors[i - 1] = i;
+  }
   double x_i, y_i, z_ij;
   arma::mat res_covs, res_target;
   if(directed){
@@ -3799,15 +4874,8 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
         
         // Get present values of x_ij, y_i, y_j
         z_ij = object.z_network.get_val(i,j);
-        xyz_calculate_change_stats(change_stat_network, i,
-                                   j,
-                                   object,
-                                   data_list,
-                                   type_list,
-                                   z,
-                                   is_full_neighborhood,
-                                   functions);
-        res_covs.row(now)= (change_stat_network).as_row();
+        units_i.push_back(i);
+        units_j.push_back(j);
         res_target.row(now) = z_ij;
         i_vec.at(now) = i;
         j_vec.at(now) = j;
@@ -3816,6 +4884,8 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
         now += 1;
       }
     }
+    xyz_calculate_change_stats_batch(res_covs, 0, units_i, units_j, object, data_list, type_list,
+                                     z, is_full_neighborhood, functions, n_threads);
     res_z.push_back(arma::join_rows(res_target.rows(0, now-1),arma::join_rows(i_vec.rows(0, now-1),
                                                     j_vec.rows(0, now-1),
                                                     overlap_vec.rows(0, now-1)), 
@@ -3828,18 +4898,11 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
   if(return_x){
     for(int i: seq(1,n_actor)){
       x_i = object.x_attribute.get_val_no_scale(i);
-      xyz_calculate_change_stats(change_stat_attribute_i, i,
-                                 i,
-                                 object,
-                                 data_list,
-                                 type_list,
-                                 x,
-                                 is_full_neighborhood,
-                                 functions);
-      res_covs.row(now)= (change_stat_attribute_i).as_row();
       res_target.row(now) = x_i;
       now += 1;
     }
+    xyz_calculate_change_stats_batch(res_covs, 0, actors, actors, object, data_list, type_list,
+                                     x, is_full_neighborhood, functions, n_threads);
     res_x.push_back(arma::join_rows(res_target.rows(0, now-1),res_actor,
                                     res_covs.rows(0, now-1)), "data");
     res.push_back(res_x, "res_x");
@@ -3852,19 +4915,11 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
     for(int i: seq(1,n_actor)){
       
       y_i = object.y_attribute.get_val_no_scale(i);
-      
-      xyz_calculate_change_stats(change_stat_attribute_i, i,
-                                 i,
-                                 object,
-                                 data_list,
-                                 type_list,
-                                 y,
-                                 is_full_neighborhood,
-                                 functions);
-      res_covs.row(now)= (change_stat_attribute_i).as_row();
       res_target.row(now) = y_i;
       now += 1;
     }
+    xyz_calculate_change_stats_batch(res_covs, 0, actors, actors, object, data_list, type_list,
+                                     y, is_full_neighborhood, functions, n_threads);
     res_y.push_back(arma::join_rows(res_target.rows(0, now-1),res_actor,res_covs.rows(0, now-1)), "data");
     res.push_back(res_y, "res_y");
     res_covs.fill(0);
@@ -3875,3 +4930,110 @@ Rcpp::List xyz_prepare_pseudo_estimation(const arma::mat& z_network,
   return(res);
 }
 
+// Defined in iglm_classes.cpp
+Rcpp::List network_partner_counts(const arma::mat& z_network, bool directed, std::string type);
+Rcpp::List geometric_weights_table(double decay, int n_actor, const arma::vec& counts);
+
+// Restores the default storage mode when a test run under another mode ends
+struct XyzStorageModeScope {
+  StorageMode previous;
+  explicit XyzStorageModeScope(StorageMode mode) : previous(default_storage_mode()) {
+    default_storage_mode() = mode;
+  }
+  ~XyzStorageModeScope() { default_storage_mode() = previous; }
+};
+
+// Removes the term registered by xyz_register_batch_test_term when a test run ends
+struct XyzBatchTestTermScope {
+  ~XyzBatchTestTermScope() { iglm::Registry::instance().remove("batch_abi_test"); }
+};
+
+template <class T>
+T xyz_test_arg(Rcpp::List& args, const char* name, T fallback) {
+  return args.containsElementNamed(name) ? Rcpp::as<T>(args[name]) : fallback;
+}
+
+// Single entry point of the internals that only the tests call, so that they
+// are not exported one by one. name selects the internal, args holds its named
+// arguments. "with_storage_mode" and "with_batch_test_term" call args$fun with
+// a different storage mode of new states or with the term "batch_abi_test"
+// registered, and undo this afterwards, also if args$fun fails.
+// [[Rcpp::export]]
+SEXP iglm_internal_test(std::string name, Rcpp::List args) {
+  if (name == "network_partner_counts") {
+    return network_partner_counts(Rcpp::as<arma::mat>(args["z_network"]), Rcpp::as<bool>(args["directed"]),
+                                  Rcpp::as<std::string>(args["type"]));
+  }
+  if (name == "geometric_weights_table") {
+    return geometric_weights_table(Rcpp::as<double>(args["decay"]), Rcpp::as<int>(args["n_actor"]),
+                                   Rcpp::as<arma::vec>(args["counts"]));
+  }
+  if (name == "storage_mode") {
+    static const char* names[] = {"automatic", "dense", "sparse"};
+    return Rcpp::wrap(std::string(names[(int)default_storage_mode()]));
+  }
+  if (name == "with_storage_mode") {
+    const std::string mode = Rcpp::as<std::string>(args["mode"]);
+    StorageMode storage;
+    if (mode == "automatic") storage = StorageMode::automatic;
+    else if (mode == "dense") storage = StorageMode::dense;
+    else if (mode == "sparse") storage = StorageMode::sparse;
+    else Rcpp::stop("The storage mode must be 'automatic', 'dense' or 'sparse'.");
+    XyzStorageModeScope scope(storage);
+    Rcpp::Function fun = Rcpp::as<Rcpp::Function>(args["fun"]);
+    return fun();
+  }
+  if (name == "with_batch_test_term") {
+    XyzBatchTestTermScope scope;
+    // Registering the same name again keeps the first registration
+    bool registered = xyz_register_batch_test_term() && xyz_register_batch_test_term();
+    Rcpp::Function fun = Rcpp::as<Rcpp::Function>(args["fun"]);
+    return List::create(_["registered"] = registered, _["result"] = fun());
+  }
+  if (name == "change_stats_modes" || name == "pl_chunks") {
+    std::vector<arma::mat> data_list = Rcpp::as<std::vector<arma::mat>>(args["data_list"]);
+    std::vector<double> type_list = Rcpp::as<std::vector<double>>(args["type_list"]);
+    const arma::mat z_network = Rcpp::as<arma::mat>(args["z_network"]);
+    const arma::vec x_attribute = Rcpp::as<arma::vec>(args["x_attribute"]);
+    const arma::vec y_attribute = Rcpp::as<arma::vec>(args["y_attribute"]);
+    const arma::mat neighborhood = Rcpp::as<arma::mat>(args["neighborhood"]);
+    const arma::mat overlap = Rcpp::as<arma::mat>(args["overlap"]);
+    const bool directed = Rcpp::as<bool>(args["directed"]);
+    const std::vector<std::string> terms = Rcpp::as<std::vector<std::string>>(args["terms"]);
+    const int n_actor = Rcpp::as<int>(args["n_actor"]);
+    const std::string type_x = Rcpp::as<std::string>(args["type_x"]);
+    const std::string type_y = Rcpp::as<std::string>(args["type_y"]);
+    const double attr_x_scale = Rcpp::as<double>(args["attr_x_scale"]);
+    const double attr_y_scale = Rcpp::as<double>(args["attr_y_scale"]);
+    if (name == "pl_chunks") {
+      return xyz_pl_chunks(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms,
+                           n_actor, data_list, type_list, type_x, type_y, attr_x_scale, attr_y_scale,
+                           Rcpp::as<int>(args["chunk_size"]), xyz_test_arg<int>(args, "n_threads", 1));
+    }
+    return xyz_change_stats_modes(z_network, x_attribute, y_attribute, neighborhood, overlap, directed, terms,
+                                  n_actor, data_list, type_list, type_x, type_y, attr_x_scale, attr_y_scale,
+                                  Rcpp::as<std::string>(args["mode"]),
+                                  Rcpp::as<std::vector<int>>(args["units_i"]),
+                                  Rcpp::as<std::vector<int>>(args["units_j"]));
+  }
+  if (name == "sample_pl_dyads") {
+    return xyz_sample_pl_dyads_cpp(Rcpp::as<arma::mat>(args["z_network"]), Rcpp::as<arma::mat>(args["neighborhood"]),
+                                   Rcpp::as<arma::mat>(args["overlap"]), Rcpp::as<bool>(args["directed"]),
+                                   Rcpp::as<int>(args["n_actor"]), Rcpp::as<double>(args["fraction"]));
+  }
+  if (name == "weighted_crossprod") {
+    return xyz_weighted_crossprod(Rcpp::as<arma::mat>(args["X"]), Rcpp::as<int>(args["from"]),
+                                  Rcpp::as<int>(args["to"]), Rcpp::as<arma::vec>(args["w"]),
+                                  Rcpp::as<arma::vec>(args["r"]), Rcpp::as<arma::vec>(args["coef"]),
+                                  xyz_test_arg<int>(args, "n_threads", 1),
+                                  xyz_test_arg<bool>(args, "single_precision", false));
+  }
+  if (name == "degree_hessian_solve") {
+    return degree_hessian_solve(Rcpp::as<arma::uvec>(args["i_vec"]), Rcpp::as<arma::uvec>(args["j_vec"]),
+                                Rcpp::as<bool>(args["directed"]), Rcpp::as<int>(args["n_actor"]),
+                                Rcpp::as<arma::vec>(args["var"]), Rcpp::as<arma::mat>(args["rhs"]),
+                                xyz_test_arg<int>(args, "max_iteration", 1000),
+                                xyz_test_arg<int>(args, "n_threads", 1));
+  }
+  Rcpp::stop("Unknown internal test '" + name + "'");
+}